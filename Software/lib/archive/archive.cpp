@@ -0,0 +1,379 @@
+/**
+ * @file archive.cpp
+ * @brief Implementation of the compressed archive
+ *
+ * Row layout, first row of a block: 32 bits per channel, the timestamp is
+ * the block start. Following rows:
+ * - delta of delta of the timestamp:
+ *   '0' for 0, '10' + 7 bits, '110' + 9 bits, '1110' + 12 bits (two's
+ *   complement) or '1111' + 32 bits
+ * - per channel, XOR with the previous value:
+ *   '0' if equal, '10' + the bits inside the previous window if they fit,
+ *   else '11' + 5 bits leading zeros + 5 bits length - 1 + the bits
+ */
+
+#include <archive.h>
+#include <math.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * @brief Append the lowest bits of a value
+ */
+void BitWriter::write(uint32_t value, uint8_t bits) {
+  if (pos + bits > capacity) {
+    full = true;
+    return;
+  }
+  for (int i = bits - 1; i >= 0; i--) {
+    uint8_t mask = 0x80 >> (pos % 8);
+    if (value & (1UL << i)) {
+      data[pos / 8] |= mask;
+    } else {
+      data[pos / 8] &= ~mask;
+    }
+    pos++;
+  }
+}
+
+/**
+ * @brief Read bits
+ */
+uint32_t BitReader::read(uint8_t bits) {
+  uint32_t value = 0;
+  for (int i = 0; i < bits; i++) {
+    value = (value << 1) | ((data[pos / 8] >> (7 - pos % 8)) & 1);
+    pos++;
+  }
+  return value;
+}
+
+/**
+ * @brief Bits of a float
+ */
+static uint32_t floatBits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/**
+ * @brief Float of bits
+ */
+static float bitsFloat(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Number of leading zero bits, x != 0
+ */
+static uint8_t leadingZeros(uint32_t x) {
+  uint8_t n = 0;
+  while (!(x & 0x80000000UL)) {
+    x <<= 1;
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief Number of trailing zero bits, x != 0
+ */
+static uint8_t trailingZeros(uint32_t x) {
+  uint8_t n = 0;
+  while (!(x & 1)) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief Sign-extend the lowest bits of a value
+ */
+static int32_t signExtend(uint32_t value, uint8_t bits) {
+  uint32_t sign = 1UL << (bits - 1);
+  return (int32_t)((value ^ sign) - sign);
+}
+
+/**
+ * @brief Set the state to the first row of a block
+ */
+static void stateFirstRow(ArchiveState& state, uint32_t time, const float* values) {
+  state.time = time;
+  state.delta = 0;
+  for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+    state.value[c] = floatBits(values[c]);
+    state.leading[c] = 0xFF;
+    state.trailing[c] = 0;
+  }
+}
+
+/**
+ * @brief Encode a row after the first one of a block
+ * @param out Bit stream of the block
+ * @param state Encoder state, updated
+ */
+static void encodeRow(BitWriter& out, ArchiveState& state, uint32_t time, const float* values) {
+  int32_t delta = (int32_t)(time - state.time);
+  int32_t dod = delta - state.delta;
+  if (dod == 0) {
+    out.write(0, 1);
+  } else if (dod >= -64 && dod <= 63) {
+    out.write(0x2, 2);
+    out.write(dod, 7);
+  } else if (dod >= -256 && dod <= 255) {
+    out.write(0x6, 3);
+    out.write(dod, 9);
+  } else if (dod >= -2048 && dod <= 2047) {
+    out.write(0xE, 4);
+    out.write(dod, 12);
+  } else {
+    out.write(0xF, 4);
+    out.write(dod, 32);
+  }
+  state.time = time;
+  state.delta = delta;
+
+  for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+    uint32_t bits = floatBits(values[c]);
+    uint32_t x = bits ^ state.value[c];
+    state.value[c] = bits;
+    if (x == 0) {
+      out.write(0, 1);
+      continue;
+    }
+
+    uint8_t leading = leadingZeros(x);
+    uint8_t trailing = trailingZeros(x);
+    if (state.leading[c] != 0xFF && leading >= state.leading[c] && trailing >= state.trailing[c]) {
+      ///< Meaningful bits fit into the previous window
+      out.write(0x2, 2);
+      out.write(x >> state.trailing[c], 32 - state.leading[c] - state.trailing[c]);
+    } else {
+      if (leading > 31) leading = 31;
+      uint8_t length = 32 - leading - trailing;
+      out.write(0x3, 2);
+      out.write(leading, 5);
+      out.write(length - 1, 5);
+      out.write(x >> trailing, length);
+      state.leading[c] = leading;
+      state.trailing[c] = trailing;
+    }
+  }
+}
+
+/**
+ * @brief Decode a row after the first one of a block
+ * @param in Bit stream of the block
+ * @param state Decoder state, updated
+ * @param row Receives the row
+ */
+static void decodeRow(BitReader& in, ArchiveState& state, ArchiveRow& row) {
+  int32_t dod;
+  if (in.read(1) == 0) {
+    dod = 0;
+  } else if (in.read(1) == 0) {
+    dod = signExtend(in.read(7), 7);
+  } else if (in.read(1) == 0) {
+    dod = signExtend(in.read(9), 9);
+  } else if (in.read(1) == 0) {
+    dod = signExtend(in.read(12), 12);
+  } else {
+    dod = (int32_t)in.read(32);
+  }
+  state.delta += dod;
+  state.time += state.delta;
+  row.time = state.time;
+
+  for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+    if (in.read(1) == 1) {
+      if (in.read(1) == 1) {
+        state.leading[c] = in.read(5);
+        state.trailing[c] = 32 - state.leading[c] - (in.read(5) + 1);
+      }
+      uint8_t length = 32 - state.leading[c] - state.trailing[c];
+      state.value[c] ^= in.read(length) << state.trailing[c];
+    }
+    row.values[c] = bitsFloat(state.value[c]);
+  }
+}
+
+/**
+ * @brief Widen the per-channel ranges of a block by a row
+ */
+static void blockRange(ArchiveBlock& block, const float* values) {
+  for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+    float value = values[c];
+    if (value != value) continue;  ///< NAN, no reading
+    bool first = block.minimum[c] != block.minimum[c];
+    if (first || value < block.minimum[c]) block.minimum[c] = value;
+    if (first || value > block.maximum[c]) block.maximum[c] = value;
+  }
+}
+
+/**
+ * @brief Use a block pool and clear the archive
+ */
+void ArchiveStore::begin(ArchiveBlock* blockPool, uint32_t blockCount) {
+  pool = blockPool;
+  count = blockCount;
+  head = 0;
+  used = 0;
+  rows = 0;
+  dropped = 0;
+}
+
+/**
+ * @brief Start a new block, dropping the oldest one if the ring is full
+ */
+ArchiveBlock& ArchiveStore::openBlock(uint32_t time) {
+  if (used == count) {
+    rows -= pool[head].rows;
+    head = (head + 1) % count;
+    used--;
+    dropped++;
+  }
+  ArchiveBlock& block = pool[(head + used) % count];
+  used++;
+  block.start = time;
+  block.end = time;
+  block.rows = 0;
+  block.bits = 0;
+  for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+    block.minimum[c] = NAN;
+    block.maximum[c] = NAN;
+  }
+  return block;
+}
+
+/**
+ * @brief Append a row
+ */
+bool ArchiveStore::append(uint32_t time, const float* values) {
+  if (count == 0) return false;
+
+  if (used > 0) {
+    ///< Try the newest block, roll back if the row does not fit
+    ArchiveBlock& block = pool[(head + used - 1) % count];
+    ArchiveState saved = state;
+    BitWriter out(block.data, ARCHIVE_BLOCK_BYTES * 8, block.bits);
+    encodeRow(out, state, time, values);
+    if (!out.overflow()) {
+      block.bits = out.position();
+      block.end = time;
+      block.rows++;
+      blockRange(block, values);
+      rows++;
+      return true;
+    }
+    state = saved;
+  }
+
+  ///< First row of a new block, stored uncompressed
+  ArchiveBlock& block = openBlock(time);
+  BitWriter out(block.data, ARCHIVE_BLOCK_BYTES * 8);
+  for (int c = 0; c < ARCHIVE_CHANNELS; c++) out.write(floatBits(values[c]), 32);
+  stateFirstRow(state, time, values);
+  block.bits = out.position();
+  block.rows = 1;
+  blockRange(block, values);
+  rows++;
+  return true;
+}
+
+/**
+ * @brief Compressed bytes used by all blocks, headers included
+ */
+uint32_t ArchiveStore::bytesUsed() const {
+  uint32_t bytes = 0;
+  for (uint32_t i = 0; i < used; i++) {
+    bytes += sizeof(ArchiveBlock) - ARCHIVE_BLOCK_BYTES + (block(i).bits + 7) / 8;
+  }
+  return bytes;
+}
+
+/**
+ * @brief Decode the next row
+ */
+bool ArchiveReader::next(ArchiveRow& row) {
+  while (blockIndex < store.blockCount() && rowIndex >= store.block(blockIndex).rows) {
+    blockIndex++;
+    rowIndex = 0;
+    bitPos = 0;
+  }
+  if (blockIndex >= store.blockCount()) return false;
+
+  const ArchiveBlock& block = store.block(blockIndex);
+  BitReader in(block.data, bitPos);
+  if (rowIndex == 0) {
+    row.time = block.start;
+    for (int c = 0; c < ARCHIVE_CHANNELS; c++) row.values[c] = bitsFloat(in.read(32));
+    stateFirstRow(state, row.time, row.values);
+  } else {
+    decodeRow(in, state, row);
+  }
+  bitPos = in.position();
+  rowIndex++;
+  return true;
+}
+
+/**
+ * @brief Minimum and maximum of one channel over a whole store
+ */
+bool archiveMinMax(const ArchiveStore& store, int channel, float& minValue, float& maxValue) {
+  bool found = false;
+  for (uint32_t i = 0; i < store.blockCount(); i++) {
+    const ArchiveBlock& block = store.block(i);
+    if (block.minimum[channel] != block.minimum[channel]) continue;  ///< No valid sample in the block
+    if (!found || block.minimum[channel] < minValue) minValue = block.minimum[channel];
+    if (!found || block.maximum[channel] > maxValue) maxValue = block.maximum[channel];
+    found = true;
+  }
+  return found;
+}
+
+#ifdef ARDUINO
+static ArchiveStore store;  ///< Archive of the station
+
+/**
+ * @brief Allocate the archive of the station in PSRAM
+ */
+bool archiveBegin() {
+  if (!psramFound()) return false;
+  ArchiveBlock* pool = (ArchiveBlock*)ps_malloc(ARCHIVE_BLOCKS * sizeof(ArchiveBlock));
+  if (pool == nullptr) return false;
+  store.begin(pool, ARCHIVE_BLOCKS);
+  return true;
+}
+
+/**
+ * @brief Append the current values of all boxes
+ */
+void archiveAppend(uint32_t time, const float* values) {
+  store.append(time, values);
+}
+
+/**
+ * @brief The archive of the station
+ */
+const ArchiveStore& archiveStore() {
+  return store;
+}
+
+/**
+ * @brief Print fill level and compression of the archive
+ */
+void archiveReport(Print& out) {
+  uint32_t raw = store.rowCount() * (uint32_t)(sizeof(uint32_t) + ARCHIVE_CHANNELS * sizeof(float));
+  uint32_t used = store.bytesUsed();
+  out.printf("Archive: %lu rows in %lu/%lu blocks, %lu bytes (%.1fx), %lu blocks dropped\n",
+             (unsigned long)store.rowCount(), (unsigned long)store.blockCount(), (unsigned long)store.capacity(), (unsigned long)used,
+             used > 0 ? (float)raw / used : 0.0F, (unsigned long)store.droppedBlocks());
+}
+#endif
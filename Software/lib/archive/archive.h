@@ -0,0 +1,232 @@
+/**
+ * @file archive.h
+ * @brief Compressed long-term archive of all history samples
+ *
+ * Contains:
+ * - BitWriter and BitReader, bit streams over a byte buffer
+ * - ArchiveBlock, a fixed-size block of compressed rows
+ * - ArchiveStore, a ring of blocks that drops the oldest block when full
+ * - ArchiveReader, a streaming decoder from older to newer rows
+ * - Functions to run the archive of the station in PSRAM
+ *
+ * One row holds a timestamp and one float per channel. Rows are compressed
+ * as in Facebook's Gorilla: the timestamp as the delta of its delta to the
+ * previous row, each value as the XOR with the previous value of the same
+ * channel, of which only the meaningful bits are stored. A channel that did
+ * not change costs one bit, a row of eight unchanged channels on the regular
+ * tick ten bits. Every block starts with an uncompressed row, so blocks can
+ * be decoded and dropped independently.
+ *
+ * The codec has no Arduino dependencies and also builds on the host.
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <config.h>
+#include <stdint.h>
+
+/// Channels per row, one per box
+#define ARCHIVE_CHANNELS NUM_BOXES
+
+class Print;
+
+/**
+ * @brief Append-only bit stream, most significant bit first
+ *
+ * Writes past the capacity are dropped and set the overflow flag, so a row
+ * can be tried and rolled back with the position saved before.
+ */
+class BitWriter {
+ public:
+  BitWriter(uint8_t* data, uint32_t capacityBits, uint32_t pos = 0) : data(data), capacity(capacityBits), pos(pos) {}
+
+  /**
+   * @brief Append the lowest bits of a value
+   * @param value Bits to write
+   * @param bits Number of bits (0 to 32)
+   */
+  void write(uint32_t value, uint8_t bits);
+
+  uint32_t position() const { return pos; }  ///< Number of bits written
+  bool overflow() const { return full; }     ///< true if a write did not fit
+
+ private:
+  uint8_t* data;      ///< Output buffer
+  uint32_t capacity;  ///< Size of the buffer in bits
+  uint32_t pos;       ///< Next bit to write
+  bool full = false;  ///< Set by a write that did not fit
+};
+
+/**
+ * @brief Bit stream reader matching BitWriter
+ */
+class BitReader {
+ public:
+  BitReader(const uint8_t* data, uint32_t pos = 0) : data(data), pos(pos) {}
+
+  /**
+   * @brief Read bits
+   * @param bits Number of bits (0 to 32)
+   * @return The bits in the lowest positions
+   */
+  uint32_t read(uint8_t bits);
+
+  uint32_t position() const { return pos; }  ///< Number of bits read
+
+ private:
+  const uint8_t* data;  ///< Input buffer
+  uint32_t pos;         ///< Next bit to read
+};
+
+/**
+ * @brief Fixed-size block of compressed rows
+ *
+ * Minimum and maximum of each channel are kept up to date with every row,
+ * so the range of the whole store needs no decoding.
+ */
+struct ArchiveBlock {
+  uint32_t start;                     ///< Timestamp of the first row in seconds
+  uint32_t end;                       ///< Timestamp of the last row in seconds
+  uint16_t rows;                      ///< Number of rows in the block
+  uint16_t bits;                      ///< Number of bits used in data
+  float minimum[ARCHIVE_CHANNELS];    ///< Smallest valid value of each channel, NAN if none
+  float maximum[ARCHIVE_CHANNELS];    ///< Largest valid value of each channel, NAN if none
+  uint8_t data[ARCHIVE_BLOCK_BYTES];  ///< Compressed rows
+};
+
+/**
+ * @brief One decoded row
+ */
+struct ArchiveRow {
+  uint32_t time;                   ///< Timestamp in seconds
+  float values[ARCHIVE_CHANNELS];  ///< Value of each channel
+};
+
+/**
+ * @brief Delta and XOR state shared by encoder and decoder
+ */
+struct ArchiveState {
+  uint32_t time;                       ///< Timestamp of the previous row
+  int32_t delta;                       ///< Delta of the previous row
+  uint32_t value[ARCHIVE_CHANNELS];    ///< Bits of the previous value of each channel
+  uint8_t leading[ARCHIVE_CHANNELS];   ///< Leading zeros of the current XOR window, 0xFF if none
+  uint8_t trailing[ARCHIVE_CHANNELS];  ///< Trailing zeros of the current XOR window
+};
+
+/**
+ * @brief Ring of compressed blocks
+ *
+ * The caller provides the block memory. When the ring is full, the oldest
+ * block is dropped to make room for a new one.
+ */
+class ArchiveStore {
+ public:
+  /**
+   * @brief Use a block pool and clear the archive
+   * @param pool Memory for count blocks
+   * @param count Number of blocks
+   */
+  void begin(ArchiveBlock* pool, uint32_t count);
+
+  /**
+   * @brief Append a row
+   * @param time Timestamp in seconds, not before the previous row
+   * @param values Value of each channel
+   * @return false if the store has no blocks
+   */
+  bool append(uint32_t time, const float* values);
+
+  uint32_t blockCount() const { return used; }        ///< Blocks holding rows
+  uint32_t capacity() const { return count; }         ///< Blocks in the pool
+  uint32_t rowCount() const { return rows; }          ///< Rows in all blocks
+  uint32_t droppedBlocks() const { return dropped; }  ///< Blocks dropped since begin()
+
+  /**
+   * @brief Compressed bytes used by all blocks, headers included
+   */
+  uint32_t bytesUsed() const;
+
+  /**
+   * @brief Block by age
+   * @param index 0 = oldest block, < blockCount()
+   */
+  const ArchiveBlock& block(uint32_t index) const { return pool[(head + index) % count]; }
+
+ private:
+  /**
+   * @brief Start a new block, dropping the oldest one if the ring is full
+   */
+  ArchiveBlock& openBlock(uint32_t time);
+
+  ArchiveBlock* pool = nullptr;  ///< Block memory
+  uint32_t count = 0;            ///< Blocks in the pool
+  uint32_t head = 0;             ///< Oldest block
+  uint32_t used = 0;             ///< Blocks holding rows
+  uint32_t rows = 0;             ///< Rows in all blocks
+  uint32_t dropped = 0;          ///< Blocks dropped to make room
+  ArchiveState state;            ///< Encoder state of the newest block
+};
+
+/**
+ * @brief Streaming decoder over all rows of a store
+ *
+ * Needs no memory besides its own state. Appending to the store while a
+ * reader is active is not allowed.
+ */
+class ArchiveReader {
+ public:
+  explicit ArchiveReader(const ArchiveStore& store) : store(store) {}
+
+  /**
+   * @brief Decode the next row
+   * @param row Receives the row
+   * @return false after the newest row
+   */
+  bool next(ArchiveRow& row);
+
+ private:
+  const ArchiveStore& store;  ///< Store being read
+  uint32_t blockIndex = 0;    ///< Block of the next row, 0 = oldest
+  uint16_t rowIndex = 0;      ///< Row of the next row within the block
+  uint32_t bitPos = 0;        ///< Bit position of the next row within the block
+  ArchiveState state;         ///< Decoder state
+};
+
+/**
+ * @brief Minimum and maximum of one channel over a whole store
+ *
+ * Combines the ranges kept in the blocks, no row is decoded.
+ * @param store Archive
+ * @param channel Channel index
+ * @param minValue Receives the minimum
+ * @param maxValue Receives the maximum
+ * @return false if the store holds no valid sample of the channel
+ */
+bool archiveMinMax(const ArchiveStore& store, int channel, float& minValue, float& maxValue);
+
+/**
+ * @brief Allocate the archive of the station in PSRAM
+ * @return false without PSRAM, the archive stays empty then
+ */
+bool archiveBegin();
+
+/**
+ * @brief Append the current values of all boxes
+ * @param time Timestamp in seconds since boot
+ * @param values Value of each box
+ */
+void archiveAppend(uint32_t time, const float* values);
+
+/**
+ * @brief The archive of the station
+ */
+const ArchiveStore& archiveStore();
+
+/**
+ * @brief Print fill level and compression of the archive
+ * @param out Output, usually Serial
+ */
+void archiveReport(Print& out);
+
+#endif  // ARCHIVE_H
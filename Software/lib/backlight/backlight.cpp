@@ -0,0 +1,106 @@
+/**
+ * @file backlight.cpp
+ * @brief Implementation of the adaptive display backlight
+ *
+ * This file contains the implementation of:
+ * - The ambient light filter and the brightness control law
+ * - LEDC setup and hardware fading on LED_PWM
+ */
+
+#include <Arduino.h>
+#include <backlight.h>
+#include <config.h>
+#include <driver/ledc.h>
+
+#define BACKLIGHT_SPEED_MODE LEDC_LOW_SPEED_MODE  ///< ESP32-S3 only has low speed channels
+#define BACKLIGHT_TIMER LEDC_TIMER_0              ///< LEDC timer driving the backlight
+#define BACKLIGHT_CHANNEL LEDC_CHANNEL_0          ///< LEDC channel driving the backlight
+
+static float ambientFiltered = -1.0;   ///< Filtered ambient light in lux (< 0 until the first sample)
+static uint32_t lastAmbientTick = 0;   ///< Ambient reading the filter took last
+static uint32_t lastActivity = 0;      ///< Time of the last touch or proximity activity
+static uint32_t fadeEnd = 0;           ///< Time the running hardware fade finishes
+static uint8_t currentDuty = MAX_PWM;  ///< Duty the last fade was started towards
+
+/**
+ * @brief Low-pass filter one ambient light sample
+ */
+float filterAmbient(float filtered, float sample) {
+  return filtered + BACKLIGHT_FILTER_ALPHA * (sample - filtered);
+}
+
+/**
+ * @brief Calculate the backlight duty for the current conditions
+ */
+uint8_t backlightTarget(float ambient, bool handNear, uint32_t idleTime) {
+  if (handNear) return MAX_PWM;
+
+  float level = ambient / MAX_AMBIENT_LIGHT;
+  if (level < 0.0) level = 0.0;
+  if (level > 1.0) level = 1.0;
+
+  ///< Square root curve: more resolution in dim rooms where the eye is sensitive
+  uint8_t duty = MIN_PWM + (uint8_t)((MAX_PWM - MIN_PWM) * sqrtf(level) + 0.5F);
+
+  if (idleTime >= BACKLIGHT_IDLE_TIMEOUT && duty > BACKLIGHT_IDLE_PWM) duty = BACKLIGHT_IDLE_PWM;
+  return duty;
+}
+
+/**
+ * @brief Configure the LEDC channel on LED_PWM and switch the backlight on
+ */
+void backlightBegin() {
+  ledc_timer_config_t timer = {};
+  timer.speed_mode = BACKLIGHT_SPEED_MODE;
+  timer.duty_resolution = LEDC_TIMER_8_BIT;
+  timer.timer_num = BACKLIGHT_TIMER;
+  timer.freq_hz = BACKLIGHT_PWM_FREQ;
+  timer.clk_cfg = LEDC_AUTO_CLK;
+  ledc_timer_config(&timer);
+
+  ledc_channel_config_t channel = {};
+  channel.gpio_num = LED_PWM;
+  channel.speed_mode = BACKLIGHT_SPEED_MODE;
+  channel.channel = BACKLIGHT_CHANNEL;
+  channel.intr_type = LEDC_INTR_DISABLE;
+  channel.timer_sel = BACKLIGHT_TIMER;
+  channel.duty = currentDuty;
+  channel.hpoint = 0;
+  ledc_channel_config(&channel);
+
+  ledc_fade_func_install(0);
+  lastActivity = millis();
+}
+
+/**
+ * @brief Record user activity that keeps the backlight awake
+ */
+void backlightActivity(uint32_t now) {
+  lastActivity = now;
+}
+
+/**
+ * @brief Feed new sensor readings and fade to the resulting duty
+ *
+ * A new fade is only started once the previous one has finished, the LEDC
+ * peripheral steps the duty on its own in between.
+ */
+void updateBacklight(float ambient, uint32_t ambientTick, float proximity, uint32_t now) {
+  bool handNear = proximity > HAND_NEAR_TRESHOLD;
+  if (handNear) lastActivity = now;
+
+  if (ambientFiltered < 0.0) {
+    ambientFiltered = ambient;
+  } else if (ambientTick != lastAmbientTick) {
+    ambientFiltered = filterAmbient(ambientFiltered, ambient);
+  }
+  lastAmbientTick = ambientTick;
+  uint8_t duty = backlightTarget(ambientFiltered, handNear, now - lastActivity);
+
+  if (duty == currentDuty || (int32_t)(now - fadeEnd) < 0) return;
+
+  ledc_set_fade_with_time(BACKLIGHT_SPEED_MODE, BACKLIGHT_CHANNEL, duty, BACKLIGHT_FADE_TIME);
+  ledc_fade_start(BACKLIGHT_SPEED_MODE, BACKLIGHT_CHANNEL, LEDC_FADE_NO_WAIT);
+  currentDuty = duty;
+  fadeEnd = now + BACKLIGHT_FADE_TIME;
+}
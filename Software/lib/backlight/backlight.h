@@ -0,0 +1,62 @@
+/**
+ * @file backlight.h
+ * @brief Adaptive display backlight driven by ambient light and proximity
+ *
+ * Contains:
+ * - The pure control law mapping ambient light, proximity and idle time to
+ *   a PWM duty
+ * - Glue to the ESP32 LEDC peripheral, which fades between duties in
+ *   hardware
+ */
+
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Low-pass filter one ambient light sample
+ * @param filtered Previous filter output in lux
+ * @param sample New ambient light sample in lux
+ * @return New filter output in lux
+ */
+float filterAmbient(float filtered, float sample);
+
+/**
+ * @brief Calculate the backlight duty for the current conditions
+ * @param ambient Filtered ambient light in lux
+ * @param handNear true if a hand is near the display
+ * @param idleTime Time since the last touch or proximity activity in milliseconds
+ * @return PWM duty between MIN_PWM and MAX_PWM, BACKLIGHT_IDLE_PWM while idle
+ *
+ * Brightness follows the square root of the ambient light between MIN_PWM
+ * and MAX_PWM, a hand near the display boosts to MAX_PWM and after
+ * BACKLIGHT_IDLE_TIMEOUT without activity the display dims to
+ * BACKLIGHT_IDLE_PWM, which may lie below MIN_PWM.
+ */
+uint8_t backlightTarget(float ambient, bool handNear, uint32_t idleTime);
+
+/**
+ * @brief Configure the LEDC channel on LED_PWM and switch the backlight on
+ */
+void backlightBegin();
+
+/**
+ * @brief Record user activity that keeps the backlight awake
+ * @param now Current time in milliseconds
+ */
+void backlightActivity(uint32_t now);
+
+/**
+ * @brief Feed new sensor readings and fade to the resulting duty
+ * @param ambient Ambient light in lux
+ * @param ambientTick Counter of ambient readings, the filter takes one step when it changes
+ * @param proximity Proximity counts
+ * @param now Current time in milliseconds
+ *
+ * Called once per snapshot, which mostly brings new proximity readings;
+ * BACKLIGHT_FILTER_ALPHA applies per ambient reading, not per call.
+ */
+void updateBacklight(float ambient, uint32_t ambientTick, float proximity, uint32_t now);
+
+#endif  // BACKLIGHT_H
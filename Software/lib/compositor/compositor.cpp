@@ -0,0 +1,118 @@
+/**
+ * @file compositor.cpp
+ * @brief Implementation of the main page compositor
+ *
+ * The areas drawn in one frame are collected in a DirtyList, so the
+ * counters report the merged rectangles that actually go over the bus.
+ */
+
+#include <compositor.h>
+
+static Widget widgets[COMPOSITOR_MAX_WIDGETS];  ///< Registered widgets
+static int widgetCount = 0;                     ///< Number of registered widgets
+static int nextWidget = 0;                      ///< Widget considered first in the next frame
+static uint32_t lastFrame = 0;                  ///< Start of the last frame in milliseconds
+static CompositorStats stats = {};              ///< Frame and bus counters
+
+/**
+ * @brief Register a widget
+ */
+int addWidget(const DisplayRect& area, WidgetRender render, int id) {
+  if (widgetCount >= COMPOSITOR_MAX_WIDGETS) return -1;
+  widgets[widgetCount] = {area, render, id, true};
+  return widgetCount++;
+}
+
+/**
+ * @brief Mark a widget as damaged
+ */
+void damageWidget(int widget) {
+  if (widget >= 0 && widget < widgetCount) widgets[widget].damaged = true;
+}
+
+/**
+ * @brief Mark all widgets as damaged
+ */
+void damageAll() {
+  for (int i = 0; i < widgetCount; i++) widgets[i].damaged = true;
+}
+
+/**
+ * @brief Draw the damaged widgets if the frame rate cap allows it
+ *
+ * Widgets are visited round robin starting after the last widget drawn,
+ * so widgets deferred by the byte cap are not starved. A single widget
+ * larger than the cap is still drawn, alone in its frame.
+ */
+bool composeFrame(uint32_t now) {
+  bool damaged = false;
+  for (int i = 0; i < widgetCount && !damaged; i++) damaged = widgets[i].damaged;
+  if (!damaged) return false;
+
+  if (now - lastFrame < 1000 / COMPOSITOR_MAX_FPS) {
+    stats.throttled++;
+    return false;
+  }
+  lastFrame = now;
+
+  uint32_t start = micros();
+  uint32_t budget = 0;
+  int last = nextWidget;
+  DirtyList drawn = {};
+
+  displayStartWrite();
+  for (int k = 0; k < widgetCount; k++) {
+    int i = (nextWidget + k) % widgetCount;
+    Widget& widget = widgets[i];
+    if (!widget.damaged) continue;
+
+    uint32_t bytes = (uint32_t)widget.area.w * widget.area.h * DISPLAY_BYTES_PER_PIXEL;
+    if (budget > 0 && budget + bytes > COMPOSITOR_MAX_FRAME_BYTES) {
+      stats.deferred++;
+      continue;
+    }
+
+    widget.damaged = false;
+    widget.render(widget.id);
+    dirtyAdd(drawn, widget.area);
+    budget += bytes;
+    last = i;
+    stats.widgetsDrawn++;
+  }
+  displayEndWrite();
+  nextWidget = (last + 1) % widgetCount;
+
+  ///< Counters
+  stats.frames++;
+  stats.lastFrameBytes = dirtyArea(drawn) * DISPLAY_BYTES_PER_PIXEL;
+  stats.lastFrameRects = drawn.count;
+  stats.bytes += stats.lastFrameBytes;
+  if (stats.lastFrameBytes > stats.maxFrameBytes) stats.maxFrameBytes = stats.lastFrameBytes;
+  stats.lastFrameUs = micros() - start;
+  if (stats.lastFrameUs > stats.maxFrameUs) stats.maxFrameUs = stats.lastFrameUs;
+  return true;
+}
+
+/**
+ * @brief Get the compositor counters
+ */
+const CompositorStats& compositorStats() {
+  return stats;
+}
+
+/**
+ * @brief Print the compositor and display counters
+ */
+void compositorReport(Print& out) {
+  const DisplayStats& display = displayStats();
+  out.printf("Compositor: %lu frames, %lu throttled, %lu widgets, %lu deferred, last %lu B in %lu rects %lu us, max %lu B %lu us\n",
+             (unsigned long)stats.frames, (unsigned long)stats.throttled, (unsigned long)stats.widgetsDrawn,
+             (unsigned long)stats.deferred, (unsigned long)stats.lastFrameBytes, (unsigned long)stats.lastFrameRects,
+             (unsigned long)stats.lastFrameUs, (unsigned long)stats.maxFrameBytes, (unsigned long)stats.maxFrameUs);
+  if (displayBuffered()) {
+    out.printf("Display: %lu flushes, %lu deferred, %lu rects, %lu pixels, last transfer %lu us (%lu us converting), flush %lu us\n",
+               (unsigned long)display.frames, (unsigned long)display.deferred, (unsigned long)display.rects,
+               (unsigned long)display.pixels, (unsigned long)display.transferUs, (unsigned long)display.convertUs,
+               (unsigned long)display.flushUs);
+  }
+}
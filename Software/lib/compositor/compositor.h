@@ -0,0 +1,93 @@
+/**
+ * @file compositor.h
+ * @brief Retained-mode compositor for the widgets of the main page
+ *
+ * Contains:
+ * - Widget, a screen area with a render function and a damage flag
+ * - CompositorStats, frame and bus counters
+ * - Functions to register widgets, mark damage and compose a frame
+ *
+ * Widgets only mark themselves as damaged when their content changes, a
+ * page that clears the screen marks all of them. composeFrame() then redraws the damaged widgets at most
+ * COMPOSITOR_MAX_FPS times per second inside one bus transaction. Widgets
+ * that do not fit into COMPOSITOR_MAX_FRAME_BYTES stay damaged and are
+ * drawn first in the next frame.
+ */
+
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <Arduino.h>
+#include <config.h>
+#include <display.h>
+
+/// Render function of a widget, draws the widget area completely
+typedef void (*WidgetRender)(int id);
+
+/**
+ * @brief One retained widget
+ */
+struct Widget {
+  DisplayRect area;     ///< Screen area the render function draws
+  WidgetRender render;  ///< Render function
+  int id;               ///< Argument of the render function, e.g. the box index
+  bool damaged;         ///< Needs to be drawn in the next frame
+};
+
+/**
+ * @brief Frame and bus counters of the compositor
+ */
+struct CompositorStats {
+  uint32_t frames;          ///< Frames in which at least one widget was drawn
+  uint32_t throttled;       ///< composeFrame() calls skipped by the frame rate cap
+  uint32_t widgetsDrawn;    ///< Widgets drawn since boot
+  uint32_t deferred;        ///< Widgets postponed by the byte cap
+  uint32_t bytes;           ///< Bus bytes since boot
+  uint32_t lastFrameBytes;  ///< Bus bytes of the last frame
+  uint32_t maxFrameBytes;   ///< Largest frame in bus bytes
+  uint32_t lastFrameRects;  ///< Rectangles of the last frame after merging
+  uint32_t lastFrameUs;     ///< Duration of the last frame in microseconds
+  uint32_t maxFrameUs;      ///< Longest frame in microseconds
+};
+
+/**
+ * @brief Register a widget
+ * @param area Screen area of the widget
+ * @param render Render function
+ * @param id Argument of the render function
+ * @return Widget handle or -1 if COMPOSITOR_MAX_WIDGETS is reached
+ *
+ * New widgets start damaged.
+ */
+int addWidget(const DisplayRect& area, WidgetRender render, int id);
+
+/**
+ * @brief Mark a widget as damaged
+ * @param widget Widget handle
+ */
+void damageWidget(int widget);
+
+/**
+ * @brief Mark all widgets as damaged, e.g. after the page was cleared
+ */
+void damageAll();
+
+/**
+ * @brief Draw the damaged widgets if the frame rate cap allows it
+ * @param now Current time in milliseconds
+ * @return true if a frame was drawn
+ */
+bool composeFrame(uint32_t now);
+
+/**
+ * @brief Get the compositor counters
+ */
+const CompositorStats& compositorStats();
+
+/**
+ * @brief Print the compositor and display counters
+ * @param out Output, e.g. Serial
+ */
+void compositorReport(Print& out);
+
+#endif  // COMPOSITOR_H
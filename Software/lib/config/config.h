@@ -8,6 +8,9 @@
  * - Sensor modules (BME680, LTR390, VCNL4040)
  * - Layout and positioning of boxes
  * - Display backlight and brightness control
+ * - Display backend, compositor and sensor task settings
+ * - Synthetic weather of the demo mode
+ * - Recording of the raw sensor readings
  *
  * The settings here control both hardware connections and UI layout parameters.
  */
@@ -69,6 +72,11 @@
 #define TITLE_COLOR TFT_BLACK    ///< Box title text color
 #define VALUE_COLOR TFT_BLACK    ///< Box value text color
 
+/// Touch input timing
+#define TOUCH_DEBOUNCE_TIME 20    ///< Time the pen-IRQ level must be stable in milliseconds
+#define TOUCH_SAMPLE_INTERVAL 10  ///< Position sampling interval while the pen is down in milliseconds
+#define TOUCH_MOVE_THRESHOLD 4    ///< Minimum movement in pixels to report a move event
+
 /// Touchscreen calibration values
 #define XMIN 610   ///< Minimum X value from touchscreen
 #define XMAX 3190  ///< Maximum X value
@@ -87,12 +95,82 @@
 #define MIN_PWM 50              ///< Minimum PWM value for backlight
 #define MAX_PWM 200             ///< Maximum PWM value for backlight
 
+/// Backlight controller settings
+#define BACKLIGHT_PWM_FREQ 5000       ///< LEDC PWM frequency in Hz
+#define BACKLIGHT_FADE_TIME 300       ///< Duration of a hardware fade in milliseconds
+#define BACKLIGHT_FILTER_ALPHA 0.2    ///< Ambient light low-pass factor per sample (0..1)
+#define BACKLIGHT_IDLE_TIMEOUT 60000  ///< Time without activity before dimming in milliseconds
+#define BACKLIGHT_IDLE_PWM 20         ///< PWM value while idle
+
+/// Sampling periods, every sensor is scheduled on its own
+#define BME_UPDATE_INTERVAL 2000       ///< BME688 temperature, humidity, pressure and gas in milliseconds
+#define PROXIMITY_UPDATE_INTERVAL 100  ///< VCNL4040 proximity (backlight boost) in milliseconds
+#define AMBIENT_UPDATE_INTERVAL 500    ///< VCNL4040 ambient and white light in milliseconds
+#define UV_UPDATE_INTERVAL 1000        ///< LTR390 UV in milliseconds
+#define SCHED_REPORT_INTERVAL 60000    ///< Interval of the scheduler statistics on Serial in milliseconds
+
+/// Sensor task settings (the Arduino loop task runs the UI on the other core)
+#define SENSOR_TASK_CORE 0      ///< Core the sensor acquisition task is pinned to
+#define SENSOR_TASK_PRIORITY 1  ///< FreeRTOS priority of the sensor task
+#define SENSOR_TASK_STACK 6144  ///< Stack size of the sensor task in bytes (printf in the report)
+#define SENSOR_TASK_PERIOD 5    ///< Delay between acquisition passes in milliseconds
+
+/// Display backend (PSRAM framebuffer pushed by the LCD_CAM i80 DMA engine)
+#define DISPLAY_FRAMEBUFFER 1     ///< Compose into a PSRAM double buffer if available (0 = always draw directly)
+#define DISPLAY_PCLK_HZ 20000000  ///< i80 write strobe frequency in Hz
+#define DISPLAY_BOUNCE_LINES 8    ///< Screen lines per DMA bounce buffer
+#define DISPLAY_TASK_CORE 0       ///< Core the display transfer task is pinned to
+#define DISPLAY_TASK_PRIORITY 2   ///< FreeRTOS priority of the display transfer task
+#define DISPLAY_TASK_STACK 3072   ///< Stack size of the display transfer task in bytes
+#define DISPLAY_MAX_DIRTY 8       ///< Separate dirty rectangles per flush before they are merged
+
+/// Sprite pool
+#define SPRITE_RETRY_INTERVAL 60000  ///< Time between allocation retries of a sprite that failed in milliseconds
+
+/// Main page compositor limits
+#define COMPOSITOR_MAX_FPS 30              ///< Maximum frame rate of the main page
+#define COMPOSITOR_MAX_FRAME_BYTES 65536   ///< Bus bytes per frame, further widgets wait for the next frame
+#define COMPOSITOR_MAX_WIDGETS 16          ///< Maximum number of widgets
+#define COMPOSITOR_REPORT_INTERVAL 60000   ///< Interval of the compositor statistics on Serial in milliseconds
+
 /// Graph display settings
-#define FAST_UPDATE_INTERVAL 500        ///< Fast update interval in milliseconds
 #define HISTORY_UPDATE_INTERVAL 120000  ///< History update interval (2 minutes) in milliseconds
 #define HISTORY_LENGTH 720              ///< 24 hours of data at 2-minute intervals (24h * 60min / 2min)
 #define GRAPH_HEIGHT 210                ///< Height of graph area in pixels
 #define GRAPH_WIDTH 720                 ///< Width of graph area in pixels
 #define GRAPH_COLOR TFT_RED             ///< Color for graph lines
+#define GRAPH_BAND_COLOR TFT_PINK       ///< Color of the minimum/maximum band of aggregated tiers
+
+/// Compressed archive of every history sample in PSRAM
+#define ARCHIVE_BLOCK_BYTES 1024  ///< Compressed bytes per block
+#define ARCHIVE_BLOCKS 1024       ///< Blocks in the archive (about 1 MB), the oldest is dropped when full
+
+/// History log on the LittleFS partition, restored at boot
+#define HISTORY_LOG_SEGMENT_RECORDS 180  ///< Records per segment file (6 hours)
+#define HISTORY_LOG_SEGMENTS 29          ///< Segments kept, 7 days plus the one being written
+#define HISTORY_LOG_FLUSH_RECORDS 15     ///< Records buffered in RAM per write (30 minutes lost at most)
+
+/// History tiers, aggregated from the 2-minute samples
+#define HISTORY_15MIN_LENGTH 192  ///< 15-minute aggregates (48 hours)
+#define HISTORY_HOUR_LENGTH 168   ///< Hourly aggregates (7 days)
+#define HISTORY_DAY_LENGTH 366    ///< Daily aggregates (1 year)
+
+/// Synthetic weather shown when no sensor answers (demo mode)
+#define DEMO_SEED 1            ///< Seed of the weather and the sensor noise
+#define DEMO_NOISE 1.0F        ///< Scale of the sensor noise (0 = smooth curves)
+#define DEMO_LATITUDE 48.0F    ///< Latitude for the course of the sun in degrees
+#define DEMO_START_DAY 172     ///< Day of the year at boot (1 = 1 January, 172 = 21 June)
+#define DEMO_START_HOUR 6.0F   ///< Local solar time at boot in hours
+#define DEMO_TIME_SCALE 1      ///< Simulated seconds per second of millis()
+#define DEMO_PEAK_LUX 2000.0F  ///< Ambient light under a clear midday sky in lux
+
+/// Trace of the raw sensor readings for replays on the host (tools/trace_replay.cpp)
+#ifndef SENSOR_TRACE
+#define SENSOR_TRACE 0  ///< 0 = off, 1 = blocks on USB CDC between the text output, 2 = file on LittleFS
+#endif
+#define TRACE_BLOCK_BYTES 256        ///< Largest block, written as a whole
+#define TRACE_FILE "/trace.bin"      ///< Trace of the running boot on LittleFS
+#define TRACE_FILE_OLD "/trace.old"  ///< Trace of the previous boot
+#define TRACE_FILE_LIMIT 262144      ///< Bytes after which the file recording stops
 
 #endif  // CONFIG_H
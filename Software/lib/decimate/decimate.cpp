@@ -0,0 +1,67 @@
+/**
+ * @file decimate.cpp
+ * @brief Implementation of the M4 decimation
+ *
+ * Sample position p covers the columns from p * columns / span to
+ * ((p + 1) * columns - 1) / span. If the series is longer than the plot,
+ * that is a single column shared with its neighbours, else the sample is
+ * repeated over every column it covers.
+ */
+
+#include <decimate.h>
+
+/**
+ * @brief Start a new series
+ */
+void M4Decimator::begin(uint32_t newSpan, uint16_t newColumns, M4Sink newSink, void* newContext) {
+  span = newSpan > 0 ? newSpan : 1;
+  columns = newColumns;
+  sink = newSink;
+  context = newContext;
+  filling = false;
+  count = 0;
+}
+
+/**
+ * @brief Hand the open column to the sink
+ */
+void M4Decimator::emit() {
+  if (!filling) return;
+  sink(open, context);
+  count++;
+  filling = false;
+}
+
+/**
+ * @brief Add an aggregated sample
+ */
+void M4Decimator::add(uint32_t pos, float value, float low, float high) {
+  if (pos >= span) return;
+  uint16_t first = (uint64_t)pos * columns / span;
+  uint16_t last = ((uint64_t)(pos + 1) * columns - 1) / span;
+
+  if (filling && open.x != first) emit();
+
+  if (filling) {
+    open.last = value;
+    if (low < open.minimum) open.minimum = low;
+    if (high > open.maximum) open.maximum = high;
+  } else {
+    open = {first, value, value, low, high};
+    filling = true;
+  }
+
+  ///< Stretched sample, it alone fills the following columns
+  for (uint16_t x = first + 1; x <= last; x++) {
+    emit();
+    open = {x, value, value, low, high};
+    filling = true;
+  }
+}
+
+/**
+ * @brief Emit the last column
+ */
+void M4Decimator::finish() {
+  emit();
+}
@@ -0,0 +1,94 @@
+/**
+ * @file decimate.h
+ * @brief Streaming min/max/first/last (M4) decimation of a series to pixel columns
+ *
+ * Contains:
+ * - M4Column, the summary of all samples falling into one pixel column
+ * - M4Decimator, which reduces a series of any length to these columns
+ *
+ * A line chart drawn from the first, last, minimum and maximum sample of
+ * every column is pixel-identical to drawing every segment, as long as the
+ * segments between samples are vertical or inside one column. So however
+ * long the series is, drawing needs at most one vertical line and one
+ * connecting segment per column. Series shorter than the plot are
+ * stretched, every column then gets the sample it lies in.
+ *
+ * Columns are handed to a sink as soon as they are complete, so the
+ * decimator itself keeps only the column being filled.
+ */
+
+#ifndef DECIMATE_H
+#define DECIMATE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Summary of the samples in one pixel column
+ */
+struct M4Column {
+  uint16_t x;     ///< Column index
+  float first;    ///< First sample of the column
+  float last;     ///< Last sample of the column
+  float minimum;  ///< Smallest sample (or lower band edge)
+  float maximum;  ///< Largest sample (or upper band edge)
+};
+
+/// Receives every column that holds at least one sample, left to right
+typedef void (*M4Sink)(const M4Column& column, void* context);
+
+/**
+ * @brief Reduces a series to one M4Column per pixel column
+ */
+class M4Decimator {
+ public:
+  /**
+   * @brief Start a new series
+   * @param span Positions of the series, samples have positions 0 to span - 1
+   * @param columns Number of pixel columns
+   * @param sink Receives the columns
+   * @param context Passed to the sink
+   */
+  void begin(uint32_t span, uint16_t columns, M4Sink sink, void* context);
+
+  /**
+   * @brief Add a sample
+   * @param pos Position, not smaller than the one of the previous sample
+   * @param value Sample
+   */
+  void add(uint32_t pos, float value) { add(pos, value, value, value); }
+
+  /**
+   * @brief Add an aggregated sample
+   * @param pos Position, not smaller than the one of the previous sample
+   * @param value Value the line is drawn through
+   * @param low Lower edge of the sample's band
+   * @param high Upper edge of the sample's band
+   */
+  void add(uint32_t pos, float value, float low, float high);
+
+  /**
+   * @brief Emit the last column
+   */
+  void finish();
+
+  /**
+   * @brief Number of columns emitted since begin()
+   */
+  uint32_t emitted() const { return count; }
+
+ private:
+  /**
+   * @brief Hand the open column to the sink
+   */
+  void emit();
+
+  uint32_t span = 1;        ///< Positions of the series
+  uint16_t columns = 0;     ///< Pixel columns
+  M4Sink sink = nullptr;    ///< Receiver of complete columns
+  void* context = nullptr;  ///< Passed to the sink
+  M4Column open = {};       ///< Column being filled
+  bool filling = false;     ///< true if open holds a sample
+  uint32_t count = 0;       ///< Columns emitted
+};
+
+#endif  // DECIMATE_H
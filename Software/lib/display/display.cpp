@@ -0,0 +1,611 @@
+/**
+ * @file display.cpp
+ * @brief Implementation of the framebuffer display backend
+ *
+ * Both framebuffers are TFT_eSprites, so the existing drawing code works
+ * unchanged on canvas(). The UI only ever draws into the back buffer. When
+ * displayFlush() hands a region over, the buffers are swapped and the
+ * region is copied into the new back buffer, so both buffers hold the same
+ * picture again while the transfer task reads the front buffer.
+ *
+ * Only displayTransfer() touches the panel, it is independent of the
+ * hardware. Everything but I80Panel also builds on the host, where
+ * displayBegin(DisplayPanel&) runs the backend against an in-memory panel.
+ */
+
+#include <display.h>
+
+#include <atomic>
+
+#if DISPLAY_FRAMEBUFFER && defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_io.h>
+#include <soc/soc_caps.h>
+#endif
+
+#if DISPLAY_FRAMEBUFFER && defined(ESP_PLATFORM) && SOC_LCD_I80_SUPPORTED
+#define DISPLAY_HAS_I80 1
+#else
+#define DISPLAY_HAS_I80 0
+#endif
+
+extern TFT_eSPI tft;  ///< TFT object
+
+static TFT_eSprite* frames[2] = {nullptr, nullptr};  ///< Front and back buffer
+static int backFrame = 0;                            ///< Index of the buffer the UI draws into
+static DirtyList dirty = {};                         ///< Changed regions of the back buffer
+static DirtyList sending = {};                       ///< Regions of the running transfer
+static const uint16_t* sendingFrame = nullptr;       ///< Pixels of the running transfer
+static std::atomic<bool> transferBusy(false);        ///< Set while the transfer task sends a region
+static DisplayPanel* panel = nullptr;                ///< Panel of the framebuffer backend, nullptr in direct mode
+static TaskHandle_t displayTaskHandle = nullptr;     ///< Transfer task
+static DisplayStats stats = {};                      ///< Transfer counters
+static TFT_eSprite* screens[NUM_SCREEN_SLOTS] = {};  ///< Cached screens, allocated on first save
+
+/**
+ * @brief Clip a rectangle to the screen
+ */
+static DisplayRect clipRect(int32_t x, int32_t y, int32_t w, int32_t h) {
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if (x + w > SCREEN_WIDTH) w = SCREEN_WIDTH - x;
+  if (y + h > SCREEN_HEIGHT) h = SCREEN_HEIGHT - y;
+  if (w <= 0 || h <= 0) return {0, 0, 0, 0};
+  return {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+}
+
+/**
+ * @brief Number of pixels in a rectangle
+ */
+static uint32_t rectArea(const DisplayRect& rect) {
+  return (uint32_t)rect.w * rect.h;
+}
+
+/**
+ * @brief Bounding box of two rectangles
+ */
+static DisplayRect unionRect(const DisplayRect& a, const DisplayRect& b) {
+  int16_t x0 = a.x < b.x ? a.x : b.x;
+  int16_t y0 = a.y < b.y ? a.y : b.y;
+  int16_t x1 = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+  int16_t y1 = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+  return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+/**
+ * @brief Add a rectangle to a dirty list
+ *
+ * Merging may make the grown rectangle cover further entries, so the
+ * search is repeated until nothing is merged anymore.
+ */
+void dirtyAdd(DirtyList& list, const DisplayRect& rect) {
+  if (rect.w <= 0 || rect.h <= 0) return;
+
+  DisplayRect merged = rect;
+  for (;;) {
+    int best = -1;
+    int32_t bestCost = INT32_MAX;
+    for (int i = 0; i < list.count; i++) {
+      int32_t cost = (int32_t)rectArea(unionRect(merged, list.rects[i])) - rectArea(merged) - rectArea(list.rects[i]);
+      if (cost < bestCost) {
+        best = i;
+        bestCost = cost;
+      }
+    }
+    if (best < 0 || (bestCost > 0 && list.count < DISPLAY_MAX_DIRTY)) break;
+
+    merged = unionRect(merged, list.rects[best]);
+    list.rects[best] = list.rects[--list.count];
+  }
+  list.rects[list.count++] = merged;
+}
+
+/**
+ * @brief Total number of pixels in a dirty list
+ */
+uint32_t dirtyArea(const DirtyList& list) {
+  uint32_t area = 0;
+  for (int i = 0; i < list.count; i++) area += rectArea(list.rects[i]);
+  return area;
+}
+
+/**
+ * @brief Copy a region between two screen-sized sprites
+ */
+static void copyRect(TFT_eSprite& from, TFT_eSprite& to, const DisplayRect& rect) {
+  const uint16_t* src = (const uint16_t*)from.getPointer();
+  uint16_t* dst = (uint16_t*)to.getPointer();
+  for (int16_t row = rect.y; row < rect.y + rect.h; row++) {
+    memcpy(dst + row * SCREEN_WIDTH + rect.x, src + row * SCREEN_WIDTH + rect.x, rect.w * sizeof(uint16_t));
+  }
+}
+
+/**
+ * @brief Convert a region of a RGB565 frame and write it to a panel
+ *
+ * The pixels of all rows are packed back to back, the panel fills its
+ * address window row by row. The colors are expanded exactly like
+ * TFT_eSPI's tft_Write_16 does for the SSD1963. The inner loop converts as
+ * many pixels as fit into the current bounce buffer without further checks.
+ */
+uint32_t displayTransfer(DisplayPanel& panel, const uint16_t* frame, int16_t stride, const DisplayRect& rect) {
+  if (rect.w <= 0 || rect.h <= 0) return 0;
+
+  size_t size = panel.bufferSize();
+  uint8_t* buf = nullptr;
+  size_t len = 0;
+  bool first = true;
+  uint32_t waited = 0;
+
+  panel.setWindow(rect);
+  for (int16_t row = rect.y; row < rect.y + rect.h; row++) {
+    const uint16_t* src = frame + row * stride + rect.x;
+    for (int16_t col = 0; col < rect.w;) {
+      if (!buf) {
+        uint32_t start = micros();
+        buf = panel.acquire();
+        waited += micros() - start;
+      }
+      int16_t n = rect.w - col;
+      if ((size_t)n > (size - len) / DISPLAY_BYTES_PER_PIXEL) n = (size - len) / DISPLAY_BYTES_PER_PIXEL;
+      uint8_t* out = buf + len;
+      for (int16_t i = 0; i < n; i++) {
+        uint16_t color = (src[col + i] >> 8) | (src[col + i] << 8);  ///< Sprite buffers hold byte-swapped colors
+        *out++ = (color & 0xF800) >> 8;
+        *out++ = (color & 0x07E0) >> 3;
+        *out++ = (color & 0x001F) << 3;
+      }
+      col += n;
+      len += n * DISPLAY_BYTES_PER_PIXEL;
+      if (len == size) {
+        panel.write(buf, len, first);
+        first = false;
+        buf = nullptr;
+        len = 0;
+      }
+    }
+  }
+  if (buf) panel.write(buf, len, first);
+  panel.finish();
+  return waited;
+}
+
+#if DISPLAY_HAS_I80
+
+/**
+ * @brief SSD1963 on the LCD_CAM i80 bus with two DMA bounce buffers
+ */
+class I80Panel : public DisplayPanel {
+ public:
+  bool begin();
+  size_t bufferSize() const override { return SCREEN_WIDTH * DISPLAY_BOUNCE_LINES * DISPLAY_BYTES_PER_PIXEL; }
+  uint8_t* acquire() override;
+  void setWindow(const DisplayRect& rect) override;
+  void write(uint8_t* data, size_t len, bool first) override;
+  void finish() override;
+
+ private:
+  static bool transferDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t* edata, void* ctx);
+
+  esp_lcd_i80_bus_handle_t bus = nullptr;    ///< i80 bus of the LCD_CAM peripheral
+  esp_lcd_panel_io_handle_t io = nullptr;    ///< Panel IO on the bus
+  SemaphoreHandle_t freeBuffers = nullptr;   ///< Counts bounce buffers not queued for DMA
+  uint8_t* buffers[2] = {nullptr, nullptr};  ///< Bounce buffers in internal DMA-capable RAM
+  int nextBuffer = 0;                        ///< Buffer returned by the next acquire()
+};
+
+/**
+ * @brief Take over the bus pins from TFT_eSPI and allocate the bounce buffers
+ */
+bool I80Panel::begin() {
+  for (int i = 0; i < 2; i++) {
+    buffers[i] = (uint8_t*)heap_caps_malloc(bufferSize(), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!buffers[i]) return false;
+  }
+  freeBuffers = xSemaphoreCreateCounting(2, 2);
+  if (!freeBuffers) return false;
+
+  esp_lcd_i80_bus_config_t busConfig = {};
+  busConfig.dc_gpio_num = TFT_RS;
+  busConfig.wr_gpio_num = TFT_WR;
+#if ESP_IDF_VERSION_MAJOR >= 5
+  busConfig.clk_src = LCD_CLK_SRC_DEFAULT;
+#else
+  busConfig.clk_src = LCD_CLK_SRC_PLL160M;
+#endif
+  const int dataPins[8] = {TFT_D0, TFT_D1, TFT_D2, TFT_D3, TFT_D4, TFT_D5, TFT_D6, TFT_D7};
+  for (int i = 0; i < 8; i++) busConfig.data_gpio_nums[i] = dataPins[i];
+  busConfig.bus_width = 8;
+  busConfig.max_transfer_bytes = bufferSize();
+  if (esp_lcd_new_i80_bus(&busConfig, &bus) != ESP_OK) return false;
+
+  esp_lcd_panel_io_i80_config_t ioConfig = {};
+  ioConfig.cs_gpio_num = TFT_CS;
+  ioConfig.pclk_hz = DISPLAY_PCLK_HZ;
+  ioConfig.trans_queue_depth = 2;
+  ioConfig.on_color_trans_done = transferDone;
+  ioConfig.user_ctx = this;
+  ioConfig.lcd_cmd_bits = 8;
+  ioConfig.lcd_param_bits = 8;
+  ioConfig.dc_levels.dc_data_level = 1;
+  if (esp_lcd_new_panel_io_i80(bus, &ioConfig, &io) != ESP_OK) {
+    esp_lcd_del_i80_bus(bus);
+    bus = nullptr;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief DMA completion callback, runs in interrupt context
+ */
+bool IRAM_ATTR I80Panel::transferDone(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t* edata, void* ctx) {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(((I80Panel*)ctx)->freeBuffers, &woken);
+  return woken == pdTRUE;
+}
+
+/**
+ * @brief Wait for a free bounce buffer
+ *
+ * Buffers complete in the order they were queued, so they are handed out
+ * alternately.
+ */
+uint8_t* I80Panel::acquire() {
+  xSemaphoreTake(freeBuffers, portMAX_DELAY);
+  uint8_t* buf = buffers[nextBuffer];
+  nextBuffer ^= 1;
+  return buf;
+}
+
+/**
+ * @brief Set the SSD1963 column and page address
+ *
+ * tx_param() waits for queued color transfers, so the window never
+ * changes under a running transfer.
+ */
+void I80Panel::setWindow(const DisplayRect& rect) {
+  int16_t x1 = rect.x + rect.w - 1, y1 = rect.y + rect.h - 1;
+  uint8_t columns[4] = {(uint8_t)(rect.x >> 8), (uint8_t)rect.x, (uint8_t)(x1 >> 8), (uint8_t)x1};
+  uint8_t pages[4] = {(uint8_t)(rect.y >> 8), (uint8_t)rect.y, (uint8_t)(y1 >> 8), (uint8_t)y1};
+  esp_lcd_panel_io_tx_param(io, 0x2A, columns, 4);
+  esp_lcd_panel_io_tx_param(io, 0x2B, pages, 4);
+}
+
+/**
+ * @brief Queue a bounce buffer with write_memory_start or write_memory_continue
+ */
+void I80Panel::write(uint8_t* data, size_t len, bool first) {
+  esp_lcd_panel_io_tx_color(io, first ? 0x2C : 0x3C, data, len);
+}
+
+/**
+ * @brief Wait until both bounce buffers are free again
+ */
+void I80Panel::finish() {
+  for (int i = 0; i < 2; i++) xSemaphoreTake(freeBuffers, portMAX_DELAY);
+  for (int i = 0; i < 2; i++) xSemaphoreGive(freeBuffers);
+}
+
+#endif  // DISPLAY_HAS_I80
+
+#if DISPLAY_FRAMEBUFFER
+
+/**
+ * @brief FreeRTOS task body sending the rectangles handed over by displayFlush()
+ * @param param Unused
+ *
+ * The conversion runs on DISPLAY_TASK_CORE next to the sensor task, its
+ * CPU time is the transfer time without the waits for a bounce buffer.
+ */
+static void displayTask(void* param) {
+  (void)param;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint32_t start = micros(), waited = 0;
+    for (int i = 0; i < sending.count; i++) waited += displayTransfer(*panel, sendingFrame, SCREEN_WIDTH, sending.rects[i]);
+    stats.transferUs = micros() - start;
+    stats.convertUs = stats.transferUs - waited;
+    stats.rects += sending.count;
+    stats.pixels += dirtyArea(sending);
+    transferBusy = false;
+  }
+}
+
+/**
+ * @brief Release both framebuffers
+ */
+static void freeFrames() {
+  for (int i = 0; i < 2; i++) {
+    if (!frames[i]) continue;
+    frames[i]->deleteSprite();
+    delete frames[i];
+    frames[i] = nullptr;
+  }
+}
+
+/**
+ * @brief Set up the framebuffer backend on a panel
+ *
+ * Allocates both framebuffers, in PSRAM on the target, and starts the
+ * transfer task.
+ */
+bool displayBegin(DisplayPanel& target) {
+  if (panel) return false;
+  for (int i = 0; i < 2; i++) {
+    frames[i] = new TFT_eSprite(&tft);
+    frames[i]->setColorDepth(16);
+    if (!frames[i]->createSprite(SCREEN_WIDTH, SCREEN_HEIGHT)) {
+      freeFrames();
+      return false;
+    }
+  }
+  backFrame = 0;
+  panel = &target;
+  xTaskCreatePinnedToCore(displayTask, "display", DISPLAY_TASK_STACK, nullptr, DISPLAY_TASK_PRIORITY, &displayTaskHandle, DISPLAY_TASK_CORE);
+  return true;
+}
+
+#endif  // DISPLAY_FRAMEBUFFER
+
+/**
+ * @brief Set up the framebuffer backend
+ *
+ * Falls back to direct drawing if there is no PSRAM or the i80 bus cannot
+ * be created. In that case TFT_eSPI is initialized again to get the bus
+ * pins back.
+ */
+bool displayBegin() {
+#if DISPLAY_HAS_I80
+  if (!psramFound()) return false;
+
+  static I80Panel i80;
+  if (i80.begin() && displayBegin(i80)) return true;
+
+  uint8_t rotation = tft.getRotation();
+  tft.init();
+  tft.setRotation(rotation);
+  return false;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Check whether the framebuffer backend is active
+ */
+bool displayBuffered() {
+  return panel != nullptr;
+}
+
+/**
+ * @brief Drawing target for everything that is not a sprite
+ */
+TFT_eSPI& canvas() {
+  if (panel) return *frames[backFrame];
+  return tft;
+}
+
+/**
+ * @brief Mark a region of the back buffer as changed
+ */
+void displayMarkDirty(int32_t x, int32_t y, int32_t w, int32_t h) {
+  if (!panel) return;
+  dirtyAdd(dirty, clipRect(x, y, w, h));
+}
+
+/**
+ * @brief Open one bus transaction for several pushes
+ */
+void displayStartWrite() {
+  if (!panel) tft.startWrite();
+}
+
+/**
+ * @brief Close the bus transaction opened by displayStartWrite()
+ */
+void displayEndWrite() {
+  if (!panel) tft.endWrite();
+}
+
+/**
+ * @brief Push a complete sprite
+ */
+void displayPush(TFT_eSprite& spr, int32_t x, int32_t y) {
+  if (!panel) {
+    spr.pushSprite(x, y);
+    return;
+  }
+  displayPush(spr, x, y, 0, 0, spr.width(), spr.height());
+}
+
+/**
+ * @brief Clip a sprite region against the sprite, then against the screen
+ * @param sx Left edge in the sprite, moved along with the clipped rectangle
+ * @param sy Top edge in the sprite, moved along with the clipped rectangle
+ * @return Rectangle on screen, w = 0 if nothing is left
+ */
+static DisplayRect clipPush(TFT_eSprite& spr, int32_t x, int32_t y, int32_t& sx, int32_t& sy, int32_t w, int32_t h) {
+  if (sx < 0) {
+    x -= sx;
+    w += sx;
+    sx = 0;
+  }
+  if (sy < 0) {
+    y -= sy;
+    h += sy;
+    sy = 0;
+  }
+  if (sx + w > spr.width()) w = spr.width() - sx;
+  if (sy + h > spr.height()) h = spr.height() - sy;
+  DisplayRect rect = clipRect(x, y, w, h);
+  sx += rect.x - x;
+  sy += rect.y - y;
+  return rect;
+}
+
+/**
+ * @brief Push part of a sprite
+ *
+ * In framebuffer mode the rows are copied into the back buffer, nothing is
+ * sent until displayFlush().
+ */
+void displayPush(TFT_eSprite& spr, int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t w, int32_t h) {
+  if (!panel) {
+    spr.pushSprite(x, y, sx, sy, w, h);
+    return;
+  }
+  if (!spr.created()) return;
+
+  DisplayRect rect = clipPush(spr, x, y, sx, sy, w, h);
+  if (rect.w == 0) return;
+
+  const uint16_t* src = (const uint16_t*)spr.getPointer();
+  uint16_t* dst = (uint16_t*)frames[backFrame]->getPointer();
+  for (int16_t row = 0; row < rect.h; row++) {
+    memcpy(dst + (rect.y + row) * SCREEN_WIDTH + rect.x, src + (sy + row) * spr.width() + sx, rect.w * sizeof(uint16_t));
+  }
+  displayMarkDirty(rect.x, rect.y, rect.w, rect.h);
+}
+
+/**
+ * @brief Expand one row of a 1- or 4-bit sprite to byte-swapped RGB565
+ * @param swapped Palette, already byte-swapped like 16-bit sprite buffers
+ * @param out Receives w pixels
+ *
+ * 4-bit sprites hold two pixels per byte, the even column in the high
+ * nibble. 1-bit sprites hold eight pixels per byte, MSB first, with rows
+ * padded to whole bytes.
+ */
+static void expandRow(TFT_eSprite& spr, const uint16_t* swapped, int32_t sx, int32_t sy, int32_t w, uint16_t* out) {
+  const uint8_t* pixels = (const uint8_t*)spr.getPointer();
+  if (spr.getColorDepth() == 4) {
+    const uint8_t* row = pixels + sy * (spr.width() / 2);
+    for (int32_t i = 0; i < w; i++) {
+      int32_t col = sx + i;
+      uint8_t pair = row[col >> 1];
+      out[i] = swapped[(col & 1) ? (pair & 0x0F) : (pair >> 4)];
+    }
+  } else {
+    const uint8_t* row = pixels + sy * ((spr.width() + 7) / 8);
+    for (int32_t i = 0; i < w; i++) {
+      int32_t col = sx + i;
+      out[i] = swapped[(row[col >> 3] >> (7 - (col & 7))) & 1];
+    }
+  }
+}
+
+/**
+ * @brief Push part of a palette sprite, expanded to RGB565 row by row
+ *
+ * In framebuffer mode the rows are expanded straight into the back buffer.
+ * In direct mode the region is one address window and each row streams
+ * into it through a line buffer, so the full-color image never exists in
+ * memory.
+ */
+void displayPushIndexed(TFT_eSprite& spr, const uint16_t* palette, int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t w, int32_t h) {
+  if (!spr.created() || (spr.getColorDepth() != 1 && spr.getColorDepth() != 4)) return;
+  DisplayRect rect = clipPush(spr, x, y, sx, sy, w, h);
+  if (rect.w == 0) return;
+
+  uint16_t swapped[16];
+  int colors = spr.getColorDepth() == 4 ? 16 : 2;
+  for (int i = 0; i < colors; i++) swapped[i] = (palette[i] >> 8) | (palette[i] << 8);
+
+  if (panel) {
+    uint16_t* dst = (uint16_t*)frames[backFrame]->getPointer();
+    for (int16_t row = 0; row < rect.h; row++) {
+      expandRow(spr, swapped, sx, sy + row, rect.w, dst + (rect.y + row) * SCREEN_WIDTH + rect.x);
+    }
+    displayMarkDirty(rect.x, rect.y, rect.w, rect.h);
+    return;
+  }
+
+  static uint16_t line[SCREEN_WIDTH];  ///< One expanded row
+  bool swapBytes = tft.getSwapBytes();
+  tft.setSwapBytes(false);  ///< The line holds sprite byte order, like pushSprite() sends it
+  tft.startWrite();
+  tft.setAddrWindow(rect.x, rect.y, rect.w, rect.h);
+  for (int16_t row = 0; row < rect.h; row++) {
+    expandRow(spr, swapped, sx, sy + row, rect.w, line);
+    tft.pushPixels(line, rect.w);
+  }
+  tft.endWrite();
+  tft.setSwapBytes(swapBytes);
+}
+
+/**
+ * @brief Push a complete palette sprite
+ */
+void displayPushIndexed(TFT_eSprite& spr, const uint16_t* palette, int32_t x, int32_t y) {
+  displayPushIndexed(spr, palette, x, y, 0, 0, spr.width(), spr.height());
+}
+
+/**
+ * @brief Hand the dirty rectangles to the transfer task
+ */
+void displayFlush() {
+  if (!panel || dirty.count == 0) return;
+  if (transferBusy) {
+    stats.deferred++;
+    return;
+  }
+
+  uint32_t start = micros();
+  TFT_eSprite* front = frames[backFrame];
+  backFrame ^= 1;
+  sending = dirty;
+  sendingFrame = (const uint16_t*)front->getPointer();
+  dirty.count = 0;
+  stats.frames++;
+
+  transferBusy = true;
+  xTaskNotifyGive(displayTaskHandle);
+
+  ///< The new back buffer misses exactly the regions being sent
+  for (int i = 0; i < sending.count; i++) copyRect(*front, *frames[backFrame], sending.rects[i]);
+  stats.flushUs = micros() - start;
+}
+
+/**
+ * @brief Keep a copy of the back buffer in the screen cache
+ *
+ * The slot is allocated in PSRAM on first use and kept afterwards.
+ */
+bool displaySave(int slot) {
+  if (!panel) return false;
+  if (!screens[slot]) {
+    screens[slot] = new TFT_eSprite(&tft);
+    screens[slot]->setColorDepth(16);
+  }
+  if (!screens[slot]->created() && !screens[slot]->createSprite(SCREEN_WIDTH, SCREEN_HEIGHT)) return false;
+
+  memcpy(screens[slot]->getPointer(), frames[backFrame]->getPointer(), SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t));
+  return true;
+}
+
+/**
+ * @brief Copy a cached screen into the back buffer
+ */
+bool displayRestore(int slot) {
+  if (!panel || !screens[slot] || !screens[slot]->created()) return false;
+
+  uint32_t start = micros();
+  memcpy(frames[backFrame]->getPointer(), screens[slot]->getPointer(), SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t));
+  displayMarkDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+  stats.restoreUs = micros() - start;
+  return true;
+}
+
+/**
+ * @brief Get the transfer counters
+ */
+const DisplayStats& displayStats() {
+  return stats;
+}
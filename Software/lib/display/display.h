@@ -0,0 +1,261 @@
+/**
+ * @file display.h
+ * @brief Display backend with a PSRAM double buffer pushed by DMA
+ *
+ * Contains:
+ * - DisplayRect, a screen rectangle, and DirtyList, a set of them
+ * - DisplayPanel, the interface of the bus the frames are written to
+ * - Functions to draw into the back buffer and to hand dirty regions to
+ *   the transfer task
+ * - A cache of rendered screens in PSRAM for instant page switching
+ *
+ * If PSRAM and the ESP32-S3 LCD_CAM peripheral are available, all drawing
+ * goes into a 800x480 back buffer in PSRAM. displayFlush() swaps the
+ * buffers and a task on DISPLAY_TASK_CORE converts the dirty region of the
+ * front buffer into DMA bounce buffers that the i80 engine sends to the
+ * SSD1963 while the UI draws the next frame. Without PSRAM everything is
+ * drawn directly with TFT_eSPI as before.
+ *
+ * The UI core only pays for the buffer swap and the copy of the dirty
+ * region. The conversion to 3 bytes per pixel that the 8-bit bus needs is
+ * still a CPU loop, in the transfer task on DISPLAY_TASK_CORE, which it
+ * shares with the sensor task; DisplayStats::convertUs reports its time.
+ */
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <TFT_eSPI.h>
+#include <config.h>
+
+/// SSD1963 on the 8-bit bus takes one byte per color channel
+#define DISPLAY_BYTES_PER_PIXEL 3
+
+/**
+ * @brief Screen rectangle, empty if w or h is 0
+ */
+struct DisplayRect {
+  int16_t x;  ///< Left edge
+  int16_t y;  ///< Top edge
+  int16_t w;  ///< Width in pixels
+  int16_t h;  ///< Height in pixels
+};
+
+/**
+ * @brief Set of dirty rectangles, overlapping ones are merged
+ */
+struct DirtyList {
+  DisplayRect rects[DISPLAY_MAX_DIRTY];  ///< Disjoint rectangles
+  int count;                             ///< Number of rectangles in use
+};
+
+/**
+ * @brief Screens kept in the cache
+ */
+enum ScreenSlot {
+  SCREEN_MAIN,      ///< Main page with boxes, logo and values
+  SCREEN_DETAIL,    ///< Detail page background and hint, without title and data
+  NUM_SCREEN_SLOTS  ///< Number of cached screens
+};
+
+/**
+ * @brief Bus the converted pixels are written to
+ *
+ * Buffers are handed over with write() and become free again once the
+ * panel has sent them. A host implementation can simply copy them.
+ */
+class DisplayPanel {
+ public:
+  virtual ~DisplayPanel() {}
+
+  /**
+   * @brief Size of one bounce buffer in bytes, a multiple of DISPLAY_BYTES_PER_PIXEL
+   */
+  virtual size_t bufferSize() const = 0;
+
+  /**
+   * @brief Wait for a free bounce buffer
+   */
+  virtual uint8_t* acquire() = 0;
+
+  /**
+   * @brief Set the address window of the following writes
+   */
+  virtual void setWindow(const DisplayRect& rect) = 0;
+
+  /**
+   * @brief Queue a filled bounce buffer
+   * @param data Buffer returned by acquire()
+   * @param len Number of bytes to send
+   * @param first true for the first buffer after setWindow()
+   */
+  virtual void write(uint8_t* data, size_t len, bool first) = 0;
+
+  /**
+   * @brief Wait until all queued buffers are sent
+   */
+  virtual void finish() = 0;
+};
+
+/**
+ * @brief Transfer counters of the display backend
+ */
+struct DisplayStats {
+  uint32_t frames;      ///< Dirty lists handed to the transfer task
+  uint32_t rects;       ///< Rectangles sent since boot
+  uint32_t deferred;    ///< Flushes postponed because a transfer was running
+  uint32_t pixels;      ///< Pixels sent since boot
+  uint32_t transferUs;  ///< Duration of the last transfer in microseconds
+  uint32_t convertUs;   ///< CPU time of the last transfer, without waiting for bounce buffers, in microseconds
+  uint32_t flushUs;     ///< UI time spent in the last displayFlush() in microseconds
+  uint32_t restoreUs;   ///< UI time spent in the last displayRestore() in microseconds
+};
+
+/**
+ * @brief Add a rectangle to a dirty list
+ * @param list Dirty list
+ * @param rect Rectangle, empty rectangles are ignored
+ *
+ * The rectangle is merged with every entry whose bounding box is not
+ * larger than both areas together, i.e. overlapping or adjacent ones. If
+ * the list is full, it is merged with the entry that grows the least.
+ */
+void dirtyAdd(DirtyList& list, const DisplayRect& rect);
+
+/**
+ * @brief Total number of pixels in a dirty list
+ */
+uint32_t dirtyArea(const DirtyList& list);
+
+/**
+ * @brief Set up the framebuffer backend
+ * @return true if drawing goes into the PSRAM framebuffer
+ *
+ * Must be called after tft.begin() and setRotation(). Afterwards the bus
+ * pins belong to the LCD_CAM peripheral, so nothing may be drawn with the
+ * TFT object directly, only through canvas() and displayPush().
+ */
+bool displayBegin();
+
+/**
+ * @brief Set up the framebuffer backend on a given panel
+ * @param target Panel the frames are sent to, e.g. an in-memory one on the host
+ * @return false if the framebuffers cannot be allocated or the backend runs already
+ */
+bool displayBegin(DisplayPanel& target);
+
+/**
+ * @brief Check whether the framebuffer backend is active
+ */
+bool displayBuffered();
+
+/**
+ * @brief Drawing target for everything that is not a sprite
+ * @return Back buffer or the TFT itself in direct mode
+ */
+TFT_eSPI& canvas();
+
+/**
+ * @brief Mark a region of the back buffer as changed
+ */
+void displayMarkDirty(int32_t x, int32_t y, int32_t w, int32_t h);
+
+/**
+ * @brief Open one bus transaction for several pushes
+ *
+ * In direct mode the pushes in between share one TFT_eSPI write window.
+ * In framebuffer mode nothing is sent before displayFlush() anyway.
+ */
+void displayStartWrite();
+
+/**
+ * @brief Close the bus transaction opened by displayStartWrite()
+ */
+void displayEndWrite();
+
+/**
+ * @brief Push a complete sprite
+ * @param spr Sprite
+ * @param x Left edge on screen
+ * @param y Top edge on screen
+ */
+void displayPush(TFT_eSprite& spr, int32_t x, int32_t y);
+
+/**
+ * @brief Push part of a sprite
+ * @param spr Sprite
+ * @param x Left edge on screen
+ * @param y Top edge on screen
+ * @param sx Left edge in the sprite
+ * @param sy Top edge in the sprite
+ * @param w Width in pixels
+ * @param h Height in pixels
+ */
+void displayPush(TFT_eSprite& spr, int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t w, int32_t h);
+
+/**
+ * @brief Push part of a 1- or 4-bit palette sprite
+ * @param spr Sprite with a color depth of 1 or 4 (even width)
+ * @param palette RGB565 color of each pixel value, 2 or 16 entries
+ * @param x Left edge on screen
+ * @param y Top edge on screen
+ * @param sx Left edge in the sprite
+ * @param sy Top edge in the sprite
+ * @param w Width in pixels
+ * @param h Height in pixels
+ *
+ * The pixels are expanded to RGB565 only on the way to the screen, the
+ * sprite itself needs a quarter (4-bit) or a sixteenth (1-bit) of the
+ * memory of a 16-bit sprite.
+ */
+void displayPushIndexed(TFT_eSprite& spr, const uint16_t* palette, int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t w, int32_t h);
+
+/**
+ * @brief Push a complete 1- or 4-bit palette sprite
+ * @param spr Sprite with a color depth of 1 or 4 (even width)
+ * @param palette RGB565 color of each pixel value, 2 or 16 entries
+ * @param x Left edge on screen
+ * @param y Top edge on screen
+ */
+void displayPushIndexed(TFT_eSprite& spr, const uint16_t* palette, int32_t x, int32_t y);
+
+/**
+ * @brief Hand the dirty rectangles to the transfer task
+ *
+ * Returns immediately. If the previous transfer is still running, the
+ * rectangles are kept and merged with the changes of the next frame.
+ */
+void displayFlush();
+
+/**
+ * @brief Keep a copy of the back buffer in the screen cache
+ * @param slot Cache slot
+ * @return false in direct mode or if the cache cannot be allocated
+ */
+bool displaySave(int slot);
+
+/**
+ * @brief Copy a cached screen into the back buffer
+ * @param slot Cache slot
+ * @return false if the slot was never saved, the caller has to draw it
+ *
+ * The whole screen is marked dirty and sent with the next flush.
+ */
+bool displayRestore(int slot);
+
+/**
+ * @brief Convert a region of a RGB565 frame and write it to a panel
+ * @param panel Target panel
+ * @param frame Byte-swapped RGB565 pixels as stored by TFT_eSprite
+ * @param stride Width of the frame in pixels
+ * @param rect Region to send
+ * @return Microseconds spent waiting for free bounce buffers
+ */
+uint32_t displayTransfer(DisplayPanel& panel, const uint16_t* frame, int16_t stride, const DisplayRect& rect);
+
+/**
+ * @brief Get the transfer counters
+ */
+const DisplayStats& displayStats();
+
+#endif  // DISPLAY_H
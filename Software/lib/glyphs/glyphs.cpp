@@ -0,0 +1,187 @@
+/**
+ * @file glyphs.cpp
+ * @brief Implementation of the glyph atlas
+ *
+ * Cells are copied row by row with memcpy between 16-bit sprite buffers,
+ * or bit by bit between 1-bit buffers (rows padded to whole bytes, MSB
+ * first). Only the rows between the topmost and bottommost text pixel of
+ * the atlas are copied, the rest of the target is expected to be cleared
+ * to the background color already.
+ */
+
+#include <glyphs.h>
+
+/**
+ * @brief Read a pixel value of a 1-bit sprite buffer
+ */
+static inline uint8_t bitAt(const uint8_t* row, int16_t col) {
+  return (row[col >> 3] >> (7 - (col & 7))) & 1;
+}
+
+/**
+ * @brief Create an empty atlas
+ */
+GlyphAtlas::GlyphAtlas(TFT_eSPI* tft)
+    : spr(tft), fontNumber(1), bgColor(0), count(0), cursor(0), inkTop(0), inkBottom(-1) {
+  memset(charGlyph, -1, sizeof(charGlyph));
+}
+
+/**
+ * @brief Select the font used for measuring and adding glyphs
+ */
+void GlyphAtlas::setFont(const GFXfont* freeFont, uint8_t font) {
+  if (freeFont) {
+    spr.setFreeFont(freeFont);
+    fontNumber = 1;
+  } else {
+    spr.setTextFont(font);
+    fontNumber = font;
+  }
+}
+
+/**
+ * @brief Measure the cell width a token would need
+ */
+int16_t GlyphAtlas::measure(const char* text) {
+  return spr.textWidth(text, fontNumber);
+}
+
+/**
+ * @brief Allocate the atlas sprite
+ */
+bool GlyphAtlas::create(int16_t width, int16_t height, uint16_t fg, uint16_t bg, uint8_t datum, uint8_t depth) {
+  spr.setColorDepth(depth);
+  if (!spr.createSprite(width, height)) return false;
+  bgColor = bg;
+  spr.fillSprite(bg);
+  spr.setTextColor(fg, bg);
+  spr.setTextDatum(datum);
+  return true;
+}
+
+/**
+ * @brief Render a character or token into the next free cell
+ *
+ * The pen advance of a single character is measured as the width of the
+ * character doubled minus the character alone, since free fonts report the
+ * ink width instead of the advance for the last character of a string.
+ */
+int GlyphAtlas::add(const char* text, int16_t y, int16_t lead) {
+  if (count >= MAX_GLYPHS || !spr.created()) return -1;
+
+  int16_t advance = measure(text);
+  int16_t width = advance;
+  if (text[0] && !text[1]) {
+    char twice[3] = {text[0], text[0], 0};
+    advance = measure(twice) - width;
+    if (advance > width) width = advance;
+  }
+  width += lead;
+  if (cursor + width > spr.width()) return -1;
+
+  spr.drawString(text, cursor + lead, y, fontNumber);
+
+  glyphs[count] = {cursor, width, lead, advance};
+  if (text[0] && !text[1] && (uint8_t)text[0] < 128) charGlyph[(uint8_t)text[0]] = count;
+  cursor += width;
+  updateInk(count);
+  return count++;
+}
+
+/**
+ * @brief Rescan a cell after decorations were drawn into it
+ *
+ * Extends the range of rows that drawGlyph() copies.
+ */
+void GlyphAtlas::updateInk(int index) {
+  const Glyph& g = glyphs[index];
+  const uint16_t* pixels = (const uint16_t*)spr.getPointer();
+  const uint8_t* bits = (const uint8_t*)spr.getPointer();
+  uint16_t bg = (bgColor >> 8) | (bgColor << 8);  ///< Sprite buffers hold byte-swapped colors
+  bool oneBit = spr.getColorDepth() == 1;
+  int16_t stride = (spr.width() + 7) / 8;
+
+  for (int16_t row = 0; row < spr.height(); row++) {
+    for (int16_t col = g.x; col < g.x + g.width; col++) {
+      if (oneBit ? bitAt(bits + row * stride, col) == bgColor : pixels[row * spr.width() + col] == bg) continue;
+      if (inkBottom < inkTop) inkTop = inkBottom = row;
+      if (row < inkTop) inkTop = row;
+      if (row > inkBottom) inkBottom = row;
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Width of a text composed from single-character glyphs
+ */
+int16_t GlyphAtlas::textWidth(const char* text) const {
+  int16_t width = 0;
+  for (; *text; text++) {
+    int index = (uint8_t)*text < 128 ? charGlyph[(uint8_t)*text] : -1;
+    if (index >= 0) width += glyphs[index].advance;
+  }
+  return width;
+}
+
+/**
+ * @brief Copy one glyph into a sprite
+ */
+int16_t GlyphAtlas::drawGlyph(TFT_eSprite& dst, int index, int16_t x) const {
+  if (index < 0) return 0;
+  const Glyph& g = glyphs[index];
+  if (!dst.created() || !spr.created() || dst.height() != spr.height() || dst.getColorDepth() != spr.getColorDepth()) return g.advance;
+
+  ///< Clip the cell against the target
+  int16_t src = g.x, width = g.width;
+  x -= g.lead;
+  if (x < 0) {
+    src -= x;
+    width += x;
+    x = 0;
+  }
+  if (x + width > dst.width()) width = dst.width() - x;
+  if (width <= 0) return g.advance;
+
+  if (spr.getColorDepth() == 1) {
+    const uint8_t* from = (const uint8_t*)spr.getPointer();
+    uint8_t* to = (uint8_t*)dst.getPointer();
+    int16_t fromStride = (spr.width() + 7) / 8, toStride = (dst.width() + 7) / 8;
+    for (int16_t row = inkTop; row <= inkBottom; row++) {
+      const uint8_t* in = from + row * fromStride;
+      uint8_t* out = to + row * toStride;
+      ///< Up to one target byte per step: take 8 source bits at any offset, merge the ones that fit
+      for (int16_t i = 0; i < width;) {
+        int16_t s = src + i, d = x + i;
+        int16_t n = 8 - (d & 7);
+        if (n > width - i) n = width - i;
+        uint16_t word = in[s >> 3] << 8;
+        if ((s >> 3) + 1 < fromStride) word |= in[(s >> 3) + 1];
+        uint8_t bits = (uint8_t)((word << (s & 7)) >> 8);
+        uint8_t mask = (uint8_t)(0xFF00 >> n) >> (d & 7);
+        out[d >> 3] = (out[d >> 3] & ~mask) | ((bits >> (d & 7)) & mask);
+        i += n;
+      }
+    }
+    return g.advance;
+  }
+
+  const uint16_t* from = (const uint16_t*)spr.getPointer();
+  uint16_t* to = (uint16_t*)dst.getPointer();
+  for (int16_t row = inkTop; row <= inkBottom; row++) {
+    memcpy(to + row * dst.width() + x, from + row * spr.width() + src, width * sizeof(uint16_t));
+  }
+  return g.advance;
+}
+
+/**
+ * @brief Compose a text from single-character glyphs
+ */
+int16_t GlyphAtlas::drawText(TFT_eSprite& dst, const char* text, int16_t x) const {
+  int16_t start = x;
+  for (; *text; text++) {
+    int index = (uint8_t)*text < 128 ? charGlyph[(uint8_t)*text] : -1;
+    if (index >= 0) x += drawGlyph(dst, index, x);
+  }
+  return x - start;
+}
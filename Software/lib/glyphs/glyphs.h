@@ -0,0 +1,147 @@
+/**
+ * @file glyphs.h
+ * @brief Pre-rendered glyph atlas for composing value text by blitting
+ *
+ * Contains:
+ * - Glyph, the position of one pre-rendered character or token
+ * - GlyphAtlas, a sprite holding glyphs rendered once at boot
+ *
+ * Values on screen only use a handful of characters (digits, '.', '-')
+ * and a few unit tokens. These are rasterised once into an atlas with the
+ * same height, colors and vertical position as the target sprite, so a
+ * value is composed by copying columns instead of decoding font data on
+ * every update.
+ *
+ * An atlas is either 16-bit or 1-bit. A 1-bit atlas holds pixel values 0
+ * and 1 as colors and copies into 1-bit sprites, e.g. the palette sprites
+ * of the detail page.
+ */
+
+#ifndef GLYPHS_H
+#define GLYPHS_H
+
+#include <TFT_eSPI.h>
+
+/// Maximum number of glyphs in one atlas
+#define MAX_GLYPHS 24
+
+/**
+ * @brief One pre-rendered character or token in the atlas
+ */
+struct Glyph {
+  int16_t x;        ///< First column of the cell in the atlas
+  int16_t width;    ///< Width of the cell in pixels
+  int16_t lead;     ///< Columns of the cell left of the pen position
+  int16_t advance;  ///< Pen advance when composing text
+};
+
+/**
+ * @brief Atlas of pre-rendered glyphs in one font and color
+ */
+class GlyphAtlas {
+ public:
+  /**
+   * @brief Create an empty atlas
+   * @param tft TFT object used as parent for the atlas sprite
+   */
+  explicit GlyphAtlas(TFT_eSPI* tft);
+
+  /**
+   * @brief Select the font used for measuring and adding glyphs
+   * @param freeFont Free font or nullptr to use a numbered font
+   * @param font Font number (used if freeFont is nullptr)
+   */
+  void setFont(const GFXfont* freeFont, uint8_t font = 1);
+
+  /**
+   * @brief Measure the cell width a token would need
+   * @param text Token text
+   * @return Width in pixels
+   */
+  int16_t measure(const char* text);
+
+  /**
+   * @brief Allocate the atlas sprite
+   * @param width Total width of all cells
+   * @param height Height, equal to the height of the target sprites
+   * @param fg Text color
+   * @param bg Background color
+   * @param datum Left-aligned text datum used by add() (TL_DATUM, ML_DATUM or BL_DATUM)
+   * @param depth Bits per pixel, 16 or 1 (fg and bg are then 0 or 1)
+   * @return true on success
+   */
+  bool create(int16_t width, int16_t height, uint16_t fg, uint16_t bg, uint8_t datum = ML_DATUM, uint8_t depth = 16);
+
+  /**
+   * @brief Render a character or token into the next free cell
+   * @param text Text to render, a single character is also used by drawText()
+   * @param y Vertical text position in the target sprite, see the datum of create()
+   * @param lead Blank columns left of the pen position, e.g. for decorations
+   * @return Glyph index or -1 if the atlas is full or was not created
+   */
+  int add(const char* text, int16_t y, int16_t lead = 0);
+
+  /**
+   * @brief Rescan a cell after decorations were drawn into it
+   * @param index Glyph index
+   */
+  void updateInk(int index);
+
+  /**
+   * @brief Access the atlas sprite, e.g. to draw decorations into a cell
+   * @return Reference to the atlas sprite
+   */
+  TFT_eSprite& canvas() { return spr; }
+
+  /**
+   * @brief Access a glyph
+   * @param index Glyph index returned by add()
+   * @return Reference to the glyph
+   */
+  const Glyph& glyph(int index) const { return glyphs[index]; }
+
+  /**
+   * @brief Pen advance of a glyph
+   * @param index Glyph index, -1 is accepted and has no width
+   * @return Advance in pixels
+   */
+  int16_t advance(int index) const { return index >= 0 ? glyphs[index].advance : 0; }
+
+  /**
+   * @brief Width of a text composed from single-character glyphs
+   * @param text Text, characters without a glyph are skipped
+   * @return Width in pixels
+   */
+  int16_t textWidth(const char* text) const;
+
+  /**
+   * @brief Copy one glyph into a sprite
+   * @param dst Target sprite (same depth and height as the atlas)
+   * @param index Glyph index, -1 draws nothing
+   * @param x Pen position in the target
+   * @return Pen advance in pixels
+   */
+  int16_t drawGlyph(TFT_eSprite& dst, int index, int16_t x) const;
+
+  /**
+   * @brief Compose a text from single-character glyphs
+   * @param dst Target sprite (same depth and height as the atlas)
+   * @param text Text, characters without a glyph are skipped
+   * @param x Left edge of the text in the target
+   * @return Width of the text in pixels
+   */
+  int16_t drawText(TFT_eSprite& dst, const char* text, int16_t x) const;
+
+ private:
+  mutable TFT_eSprite spr;   ///< Atlas pixels
+  uint8_t fontNumber;        ///< Font number passed to drawString()
+  uint16_t bgColor;          ///< Background color of the cells
+  Glyph glyphs[MAX_GLYPHS];  ///< Glyph cells
+  int count;                 ///< Number of glyphs
+  int16_t cursor;            ///< First free column
+  int16_t inkTop;            ///< First row that contains text in any cell
+  int16_t inkBottom;         ///< Last row that contains text in any cell
+  int8_t charGlyph[128];     ///< Glyph index of each ASCII character, -1 if none
+};
+
+#endif  // GLYPHS_H
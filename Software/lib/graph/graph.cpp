@@ -0,0 +1,315 @@
+/**
+ * @file graph.cpp
+ * @brief Implementation of the incremental history graph
+ *
+ * The plot area is the inside of the outline, one column per sample. The
+ * pixels of column c only depend on the Y positions of the samples in
+ * columns c-1, c and c+1, so after scrolling a column only has to be pushed
+ * if that triple changed, and only between the lowest and highest of those
+ * Y positions.
+ *
+ * Aggregated tiers and the archive go through the M4 decimator: every
+ * column gets one vertical line over the range of its samples and one
+ * segment from the last sample of the previous column, so the number of
+ * draw calls is bounded by the plot width whatever the length of the series.
+ *
+ * Rows come from a fixed-point transform set up once per redraw. The raw
+ * tier is converted straight from the history codes, one pass over each
+ * contiguous run of the ring.
+ *
+ * The sprite is the 4-bit palette sprite of the pool, so everything is
+ * drawn with GraphInk values and scrolling shifts nibbles.
+ */
+
+#include <archive.h>
+#include <config.h>
+#include <decimate.h>
+#include <display.h>
+#include <graph.h>
+#include <history.h>
+#include <methods.h>
+#include <sprites.h>
+#include <ytransform.h>
+
+#define PLOT_LEFT 1                         ///< First column of the plot area in the sprite
+#define PLOT_TOP 1                          ///< First row of the plot area in the sprite
+#define PLOT_COLUMNS (GRAPH_WIDTH - 2)      ///< Number of plotted samples (one per column)
+#define PLOT_BOTTOM (GRAPH_HEIGHT - 11)     ///< Lowest row a sample can map to (outline row)
+#define OUTLINE_HEIGHT (GRAPH_HEIGHT - 10)  ///< Rows pushed, the page keeps its labels in the rows below
+#define NO_POINT -1                         ///< Marker for a column without a sample
+#define WINDOW_COST 4                       ///< Bus bytes of a new address window, in pixels (11 vs 3 bytes)
+
+static_assert(GRAPH_WIDTH % 2 == 0, "rows of the 4-bit graph sprite must start on a byte");
+
+static int graphBox = -1;              ///< Box currently shown in the sprite, -1 if none
+static int graphTier = TIER_RAW;       ///< Tier currently shown in the sprite
+static float graphMin, graphMax;       ///< Y-range of the plot in the sprite
+static uint32_t graphSamples;          ///< Entry count of the tier when the plot was drawn
+static int16_t columnY[PLOT_COLUMNS];  ///< Y position of the sample in each column
+static YTransform transform;           ///< Value to row mapping of the current redraw
+static GraphStats stats = {};          ///< Redraw counters
+
+/**
+ * @brief State of a decimated plot pass
+ */
+struct PlotPass {
+  TFT_eSprite* spr;  ///< Graph sprite
+  bool band;         ///< true: draw the band only, false: draw the line
+  int prevX;         ///< Column of the previous M4Column, -2 if none
+  int16_t prevY;     ///< Row of the last sample of the previous column
+};
+
+/**
+ * @brief Draw one decimated column
+ */
+static void drawColumn(const M4Column& column, void* context) {
+  PlotPass& pass = *(PlotPass*)context;
+  int16_t top = valueToRow(transform, column.maximum);
+  int16_t bottom = valueToRow(transform, column.minimum);
+
+  if (pass.band) {
+    pass.spr->drawFastVLine(PLOT_LEFT + column.x, top, bottom - top + 1, GRAPH_INK_BAND);
+    stats.drawCalls++;
+    return;
+  }
+
+  int16_t firstY = valueToRow(transform, column.first);
+  if (pass.prevX == column.x - 1) {
+    pass.spr->drawLine(PLOT_LEFT + pass.prevX, pass.prevY, PLOT_LEFT + column.x, firstY, GRAPH_INK_LINE);
+    stats.drawCalls++;
+  }
+  if (bottom > top) {
+    pass.spr->drawFastVLine(PLOT_LEFT + column.x, top, bottom - top + 1, GRAPH_INK_LINE);
+    stats.drawCalls++;
+  }
+  pass.prevX = column.x;
+  pass.prevY = valueToRow(transform, column.last);
+}
+
+/**
+ * @brief Plot an aggregated tier, the band in one pass and the means in another
+ */
+static void plotTier(TFT_eSprite& spr, int boxIndex, int tier) {
+  uint16_t length = historyTierLength(tier);
+  M4Decimator decimator;
+  HistoryAggregate entry;
+
+  for (int band = 1; band >= 0; band--) {
+    PlotPass pass = {&spr, band == 1, -2, 0};
+    decimator.begin(length, PLOT_COLUMNS, drawColumn, &pass);
+    for (int age = length - 1; age >= 0; age--) {
+      if (!historyEntry(boxIndex, tier, age, entry)) continue;
+      if (band) {
+        decimator.add(length - 1 - age, entry.mean, entry.minimum, entry.maximum);
+      } else {
+        decimator.add(length - 1 - age, entry.mean);
+      }
+    }
+    decimator.finish();
+  }
+}
+
+/**
+ * @brief Plot every archived sample of a box over the whole archive span
+ */
+static void plotArchive(TFT_eSprite& spr, int boxIndex) {
+  const ArchiveStore& store = archiveStore();
+  if (store.rowCount() == 0) return;
+  uint32_t start = store.block(0).start;
+  uint32_t span = store.block(store.blockCount() - 1).end - start + 1;
+
+  PlotPass pass = {&spr, false, -2, 0};
+  M4Decimator decimator;
+  decimator.begin(span, PLOT_COLUMNS, drawColumn, &pass);
+  ArchiveReader reader(store);
+  ArchiveRow row;
+  while (reader.next(row)) {
+    if (!isnan(row.values[boxIndex])) decimator.add(row.time - start, row.values[boxIndex]);
+  }
+  decimator.finish();
+}
+
+/**
+ * @brief Draw the segment from the previous column to a column
+ * @param spr Graph sprite
+ * @param column Plot column the segment ends in
+ */
+static void drawSegment(TFT_eSprite& spr, int column) {
+  if (column == 0 || columnY[column - 1] == NO_POINT || columnY[column] == NO_POINT) return;
+  spr.drawLine(PLOT_LEFT + column - 1, columnY[column - 1], PLOT_LEFT + column, columnY[column], GRAPH_INK_LINE);
+}
+
+/**
+ * @brief Render the whole plot and push it with the outline
+ */
+static void drawFull(TFT_eSprite& spr, int boxIndex, int tier, int x, int y) {
+  spr.fillSprite(GRAPH_INK_BACKGROUND);
+
+  ///< Graph outline
+  spr.drawRect(0, 0, GRAPH_WIDTH, OUTLINE_HEIGHT, GRAPH_INK_OUTLINE);
+
+  if (tier == TIER_RAW) {
+    ///< Rows of the two contiguous runs of the ring, then the graph line from oldest to newest
+    const CompactHistory<HISTORY_LENGTH>& ring = historyRing(boxIndex);
+    uint16_t first = ring.firstSlot(PLOT_COLUMNS);
+    int run = HISTORY_LENGTH - first < PLOT_COLUMNS ? HISTORY_LENGTH - first : PLOT_COLUMNS;
+    codesToRows(transform, ring.raw() + first, run, columnY);
+    codesToRows(transform, ring.raw(), PLOT_COLUMNS - run, columnY + run);
+    for (int c = 0; c < PLOT_COLUMNS; c++) {
+      if (!ring.isValid((first + c) % HISTORY_LENGTH)) columnY[c] = NO_POINT;
+      drawSegment(spr, c);
+    }
+  } else if (tier == GRAPH_VIEW_ARCHIVE) {
+    plotArchive(spr, boxIndex);
+  } else {
+    ///< Minimum/maximum band first, so the line of the means stays on top
+    plotTier(spr, boxIndex, tier);
+  }
+
+  displayPushIndexed(spr, poolPalette(SPRITE_GRAPH), x, y, 0, 0, GRAPH_WIDTH, OUTLINE_HEIGHT);
+  stats.fullRedraws++;
+  stats.pixelsPushed += GRAPH_WIDTH * OUTLINE_HEIGHT;
+}
+
+/**
+ * @brief Y position in a column, NO_POINT outside the plot
+ * @param ys Y positions of all columns
+ * @param column Plot column
+ * @return Row in the sprite or NO_POINT
+ */
+static int16_t pointAt(const int16_t* ys, int column) {
+  if (column < 0 || column >= PLOT_COLUMNS) return NO_POINT;
+  return ys[column];
+}
+
+/**
+ * @brief Move the plot one column to the left
+ *
+ * Every row from PLOT_TOP to PLOT_BOTTOM is shifted by one nibble as a
+ * whole, then the two outline columns and the freed last plot column are
+ * put back.
+ */
+static void scrollPlot(TFT_eSprite& spr) {
+  uint8_t* pixels = (uint8_t*)spr.getPointer();
+  const int stride = GRAPH_WIDTH / 2;
+  for (int row = PLOT_TOP; row <= PLOT_BOTTOM; row++) {
+    uint8_t* p = pixels + row * stride;
+    uint8_t left = p[0] & 0xF0, right = p[stride - 1] & 0x0F;
+    for (int i = 0; i < stride - 1; i++) p[i] = (p[i] << 4) | (p[i + 1] >> 4);
+    p[stride - 1] = GRAPH_INK_BACKGROUND << 4 | right;  ///< Last plot column is even, GRAPH_WIDTH - 2
+    p[0] = left | (p[0] & 0x0F);
+  }
+}
+
+/**
+ * @brief Rectangle of the plot pushed as one address window
+ */
+struct PushSpan {
+  int left, right;      ///< First and last plot column, right < left if empty
+  int16_t top, bottom;  ///< First and last row in the sprite
+};
+
+/**
+ * @brief Push a span of the plot, nothing if it is empty
+ */
+static void pushSpan(TFT_eSprite& spr, const PushSpan& span, int x, int y) {
+  if (span.right < span.left) return;
+  int w = span.right - span.left + 1, h = span.bottom - span.top + 1;
+  displayPushIndexed(spr, poolPalette(SPRITE_GRAPH), x + PLOT_LEFT + span.left, y + span.top, PLOT_LEFT + span.left, span.top, w, h);
+  stats.pixelsPushed += w * h;
+}
+
+/**
+ * @brief Scroll the plot by one sample and push the changed columns
+ *
+ * Changed columns are collected into spans from left to right. A column
+ * joins the open span if the grown rectangle costs no more bus bytes than
+ * the span and the column as two windows, so neighbouring changes go out
+ * in one window without sending much unchanged plot.
+ */
+static void drawIncremental(TFT_eSprite& spr, int boxIndex, int x, int y) {
+  static int16_t oldY[PLOT_COLUMNS];
+  memcpy(oldY, columnY, sizeof(columnY));
+
+  ///< Move the plot one column to the left and draw the newest segment
+  scrollPlot(spr);
+  spr.drawPixel(PLOT_LEFT + PLOT_COLUMNS - 1, PLOT_BOTTOM, GRAPH_INK_OUTLINE);  ///< Outline under the new column
+
+  memmove(columnY, columnY + 1, (PLOT_COLUMNS - 1) * sizeof(columnY[0]));
+  const CompactHistory<HISTORY_LENGTH>& ring = historyRing(boxIndex);
+  uint16_t newest = ring.slotOf(0);
+  columnY[PLOT_COLUMNS - 1] = ring.isValid(newest) ? codeToRow(transform, ring.raw()[newest]) : NO_POINT;
+  drawSegment(spr, PLOT_COLUMNS - 1);
+
+  ///< Push every column whose neighbourhood of sample positions changed
+  PushSpan span = {0, -1, 0, 0};
+  for (int c = 0; c < PLOT_COLUMNS; c++) {
+    int16_t before[3] = {pointAt(oldY, c - 1), pointAt(oldY, c), pointAt(oldY, c + 1)};
+    int16_t after[3] = {pointAt(columnY, c - 1), pointAt(columnY, c), pointAt(columnY, c + 1)};
+    if (memcmp(before, after, sizeof(before)) == 0) continue;
+
+    int16_t top = PLOT_BOTTOM + 1, bottom = PLOT_TOP - 1;
+    for (int k = 0; k < 6; k++) {
+      int16_t row = k < 3 ? before[k] : after[k - 3];
+      if (row == NO_POINT) continue;
+      if (row < top) top = row;
+      if (row > bottom) bottom = row;
+    }
+    if (top > bottom) continue;  ///< No sample on either side, column stays empty
+
+    if (span.right >= span.left) {
+      int16_t grownTop = top < span.top ? top : span.top;
+      int16_t grownBottom = bottom > span.bottom ? bottom : span.bottom;
+      int32_t grown = (c - span.left + 1) * (grownBottom - grownTop + 1);
+      int32_t apart = (span.right - span.left + 1) * (span.bottom - span.top + 1) + WINDOW_COST + (bottom - top + 1);
+      if (grown <= apart) {
+        span = {span.left, c, grownTop, grownBottom};
+        continue;
+      }
+      pushSpan(spr, span, x, y);
+    }
+    span = {c, c, top, bottom};
+  }
+  pushSpan(spr, span, x, y);
+  stats.incrementalRedraws++;
+}
+
+/**
+ * @brief Draw the history graph of a box and push it to the display
+ */
+void drawGraph(TFT_eSprite& spr, int boxIndex, int tier, float minValue, float maxValue, int x, int y) {
+  if (!spr.created()) {
+    graphBox = -1;  ///< Nothing drawn, the next call with a sprite starts over
+    return;
+  }
+
+  uint32_t samples = tier == GRAPH_VIEW_ARCHIVE ? archiveStore().rowCount() : historyTierCount(boxIndex, tier);
+  bool sameView = boxIndex == graphBox && tier == graphTier && minValue == graphMin && maxValue == graphMax;
+
+  if (sameView && tier == TIER_RAW && samples == graphSamples + 1) {
+    drawIncremental(spr, boxIndex, x, y);
+  } else if (!sameView || samples != graphSamples) {
+    transform = makeYTransform(historyScale(boxIndex), minValue, maxValue, PLOT_TOP, PLOT_BOTTOM);
+    drawFull(spr, boxIndex, tier, x, y);
+  }
+
+  graphBox = boxIndex;
+  graphTier = tier;
+  graphMin = minValue;
+  graphMax = maxValue;
+  graphSamples = samples;
+}
+
+/**
+ * @brief Force the next drawGraph() to be a full redraw
+ */
+void invalidateGraph() {
+  graphBox = -1;
+}
+
+/**
+ * @brief Get the redraw counters of the graph
+ */
+const GraphStats& graphStats() {
+  return stats;
+}
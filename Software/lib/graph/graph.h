@@ -0,0 +1,72 @@
+/**
+ * @file graph.h
+ * @brief History graph on the detail page with incremental scrolling
+ *
+ * Contains:
+ * - Functions to draw the history graph of a box into the graph sprite
+ * - Counters for full and incremental redraws and pushed pixels
+ *
+ * The graph plots one history sample per pixel column, newest on the
+ * right. When exactly one sample was appended and the Y-range did not
+ * change, the plot is scrolled left by one column, only the newest segment
+ * is drawn and only the columns whose content changed are pushed,
+ * neighbouring ones together in one address window.
+ *
+ * The aggregated tiers are stretched over the plot width and drawn as a
+ * minimum/maximum band behind the line of the means. They change at most
+ * every 15 minutes and are always redrawn completely. The archive view
+ * decimates every archived sample to the plot width.
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <TFT_eSPI.h>
+#include <history.h>
+
+/// View of drawGraph() after the history tiers: the whole compressed archive
+#define GRAPH_VIEW_ARCHIVE NUM_TIERS
+
+/// Number of views drawGraph() accepts
+#define NUM_GRAPH_VIEWS (NUM_TIERS + 1)
+
+/**
+ * @brief Redraw counters of the graph
+ */
+struct GraphStats {
+  uint32_t fullRedraws;         ///< Redraws that rendered and pushed the whole sprite
+  uint32_t incrementalRedraws;  ///< Redraws that scrolled by one column
+  uint32_t pixelsPushed;        ///< Pixels sent to the display since boot
+  uint32_t drawCalls;           ///< Lines drawn for decimated views since boot
+};
+
+/**
+ * @brief Draw the history graph of a box and push it to the display
+ * @param spr Graph sprite, the 4-bit pool sprite SPRITE_GRAPH (GRAPH_WIDTH x GRAPH_HEIGHT)
+ * @param boxIndex Index of the box
+ * @param tier History tier or GRAPH_VIEW_ARCHIVE
+ * @param minValue Bottom of the Y-range
+ * @param maxValue Top of the Y-range
+ * @param x X position of the graph on screen
+ * @param y Y position of the graph on screen
+ *
+ * Draws nothing if the sprite could not be allocated. Only the outline and
+ * what is inside it are pushed, the last 10 rows of the sprite stay free
+ * for labels of the page.
+ */
+void drawGraph(TFT_eSprite& spr, int boxIndex, int tier, float minValue, float maxValue, int x, int y);
+
+/**
+ * @brief Force the next drawGraph() to be a full redraw
+ *
+ * Must be called whenever the graph area on screen was overwritten.
+ */
+void invalidateGraph();
+
+/**
+ * @brief Get the redraw counters of the graph
+ * @return Reference to the counters
+ */
+const GraphStats& graphStats();
+
+#endif  // GRAPH_H
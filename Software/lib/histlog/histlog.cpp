@@ -0,0 +1,279 @@
+/**
+ * @file histlog.cpp
+ * @brief Implementation of the history log
+ *
+ * Record layout, little endian: sequence (4 bytes), one code per box
+ * (2 bytes each), validity bits (1 byte), reserved (1 byte, 0), CRC-32 of
+ * all bytes before it (4 bytes).
+ *
+ * With the default settings the log writes 48 appends of 390 bytes a day
+ * and keeps 7 days (about 130 KB) on the partition.
+ */
+
+#include <histlog.h>
+#include <stdlib.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <history.h>
+#endif
+
+static_assert(NUM_BOXES <= 8, "validity bits of a record hold 8 boxes");
+static_assert(HISTORY_LOG_SEGMENT_RECORDS % HISTORY_LOG_FLUSH_RECORDS == 0, "a flush must not span two segments");
+
+/// Upper bound of segments looked at during begin()
+#define MAX_LISTED_SEGMENTS (2 * HISTORY_LOG_SEGMENTS)
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as used by zlib)
+ */
+static uint32_t crc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+/**
+ * @brief Store a 32-bit value little endian
+ */
+static void put32(uint8_t* p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+/**
+ * @brief Load a 32-bit value stored little endian
+ */
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Serialize a record with its CRC
+ */
+void logEncode(const LogRecord& record, uint8_t* out) {
+  put32(out, record.sequence);
+  for (int i = 0; i < NUM_BOXES; i++) {
+    out[4 + 2 * i] = record.codes[i];
+    out[5 + 2 * i] = record.codes[i] >> 8;
+  }
+  out[4 + 2 * NUM_BOXES] = record.valid;
+  out[5 + 2 * NUM_BOXES] = 0;
+  put32(out + HISTORY_LOG_RECORD_BYTES - 4, crc32(out, HISTORY_LOG_RECORD_BYTES - 4));
+}
+
+/**
+ * @brief Check the CRC of a serialized record and decode it
+ */
+bool logDecode(const uint8_t* in, LogRecord& record) {
+  if (get32(in + HISTORY_LOG_RECORD_BYTES - 4) != crc32(in, HISTORY_LOG_RECORD_BYTES - 4)) return false;
+  record.sequence = get32(in);
+  for (int i = 0; i < NUM_BOXES; i++) record.codes[i] = in[4 + 2 * i] | (in[5 + 2 * i] << 8);
+  record.valid = in[4 + 2 * NUM_BOXES];
+  return true;
+}
+
+/**
+ * @brief Attach the storage and replay the kept segments
+ */
+uint32_t HistoryLog::begin(LogStorage& logStorage, ReplayCallback replay) {
+  storage = &logStorage;
+  pendingRecords = 0;
+  segmentRecords = 0;
+
+  ///< Sort the segment numbers, insertion sort is fine for a few dozen
+  uint32_t segments[MAX_LISTED_SEGMENTS];
+  int count = storage->list(segments, MAX_LISTED_SEGMENTS);
+  for (int i = 1; i < count; i++) {
+    uint32_t s = segments[i];
+    int j = i;
+    for (; j > 0 && segments[j - 1] > s; j--) segments[j] = segments[j - 1];
+    segments[j] = s;
+  }
+
+  ///< Keep room for the segment started now, delete everything older
+  int first = count > HISTORY_LOG_SEGMENTS - 1 ? count - (HISTORY_LOG_SEGMENTS - 1) : 0;
+  for (int i = 0; i < first; i++) storage->remove(segments[i]);
+
+  ///< Read a whole segment at once if the heap allows, else in flush-sized chunks
+  const size_t segmentBytes = HISTORY_LOG_SEGMENT_RECORDS * HISTORY_LOG_RECORD_BYTES;
+  uint8_t* buffer = (uint8_t*)malloc(segmentBytes);
+  size_t bufferBytes = buffer != nullptr ? segmentBytes : sizeof(pending);
+  if (buffer == nullptr) buffer = pending;
+
+  uint32_t replayed = 0;
+  for (int i = first; i < count; i++) {
+    size_t offset = 0;
+    bool done = false;
+    while (!done) {
+      size_t len = storage->read(segments[i], offset, buffer, bufferBytes);
+      size_t records = len / HISTORY_LOG_RECORD_BYTES;
+      for (size_t r = 0; r < records; r++) {
+        LogRecord record;
+        if (!logDecode(buffer + r * HISTORY_LOG_RECORD_BYTES, record)) {
+          counters.corrupt++;  ///< Torn or damaged, the rest of the segment is not trusted
+          done = true;
+          break;
+        }
+        if (replay != nullptr) replay(record);
+        sequence = record.sequence + 1;
+        replayed++;
+      }
+      if (!done && len % HISTORY_LOG_RECORD_BYTES != 0) counters.corrupt++;  ///< Partial record at the end
+      offset += len;
+      done = done || len < bufferBytes;
+    }
+  }
+  if (buffer != pending) free(buffer);
+
+  segment = count > 0 ? segments[count - 1] + 1 : 0;
+  oldest = first < count ? segments[first] : segment;
+  counters.replayed = replayed;
+  return replayed;
+}
+
+/**
+ * @brief Append a record, written once HISTORY_LOG_FLUSH_RECORDS are buffered
+ */
+void HistoryLog::append(LogRecord record) {
+  if (storage == nullptr) return;
+  record.sequence = sequence++;
+  logEncode(record, pending + pendingRecords * HISTORY_LOG_RECORD_BYTES);
+  pendingRecords++;
+  counters.records++;
+  if (pendingRecords == HISTORY_LOG_FLUSH_RECORDS) flush();
+}
+
+/**
+ * @brief Write the buffered records now
+ */
+void HistoryLog::flush() {
+  if (storage == nullptr || pendingRecords == 0) return;
+
+  size_t len = pendingRecords * HISTORY_LOG_RECORD_BYTES;
+  if (storage->append(segment, pending, len)) {
+    counters.writes++;
+    counters.bytesWritten += len;
+  } else {
+    counters.failed++;
+  }
+  segmentRecords += pendingRecords;
+  pendingRecords = 0;
+
+  ///< Rotate to a new segment and drop the oldest ones
+  if (segmentRecords >= HISTORY_LOG_SEGMENT_RECORDS) {
+    segment++;
+    segmentRecords = 0;
+    while (segment - oldest + 1 > HISTORY_LOG_SEGMENTS) storage->remove(oldest++);
+  }
+}
+
+#ifdef ARDUINO
+#define LOG_DIR "/hist"  ///< Directory of the segment files
+
+/**
+ * @brief Segments as files LOG_DIR/<number>.log on LittleFS
+ */
+class LittleFsStorage : public LogStorage {
+ public:
+  int list(uint32_t* segments, int max) override {
+    File dir = LittleFS.open(LOG_DIR);
+    if (!dir || !dir.isDirectory()) return 0;
+    int n = 0;
+    for (File f = dir.openNextFile(); f && n < max; f = dir.openNextFile()) {
+      const char* name = strrchr(f.name(), '/');
+      segments[n++] = strtoul(name != nullptr ? name + 1 : f.name(), nullptr, 10);
+    }
+    return n;
+  }
+
+  bool append(uint32_t segment, const uint8_t* data, size_t len) override {
+    File f = LittleFS.open(path(segment), FILE_APPEND);
+    if (!f) return false;
+    size_t written = f.write(data, len);
+    f.close();
+    return written == len;
+  }
+
+  size_t read(uint32_t segment, size_t offset, uint8_t* data, size_t len) override {
+    File f = LittleFS.open(path(segment), FILE_READ);
+    if (!f || !f.seek(offset)) return 0;
+    size_t got = f.read(data, len);
+    f.close();
+    return got;
+  }
+
+  void remove(uint32_t segment) override { LittleFS.remove(path(segment)); }
+
+ private:
+  /**
+   * @brief File name of a segment
+   */
+  const char* path(uint32_t segment) {
+    snprintf(name, sizeof(name), LOG_DIR "/%08lu.log", (unsigned long)segment);
+    return name;
+  }
+
+  char name[24];  ///< Buffer for path()
+};
+
+static LittleFsStorage storage;  ///< Segments on the LittleFS partition
+static HistoryLog historyLog;    ///< Log of the station
+static uint32_t restoreUs = 0;   ///< Duration of the restore at boot
+static uint32_t bootMs = 0;      ///< Time the log was started
+
+/**
+ * @brief Feed a replayed record into the history
+ */
+static void restoreRecord(const LogRecord& record) {
+  for (int i = 0; i < NUM_BOXES; i++) {
+    bool valid = record.valid & (1 << i);
+    updateHistory(i, valid ? historyScale(i).decode(record.codes[i]) : NAN);
+  }
+}
+
+/**
+ * @brief Mount LittleFS and restore the history from the log
+ */
+uint32_t historyLogBegin() {
+  if (!LittleFS.begin(true)) return 0;  ///< Formats the partition on first use
+  LittleFS.mkdir(LOG_DIR);
+
+  uint32_t start = micros();
+  uint32_t restored = historyLog.begin(storage, restoreRecord);
+  restoreUs = micros() - start;
+  bootMs = millis();
+  return restored;
+}
+
+/**
+ * @brief Append the current values of all boxes to the log
+ */
+void historyLogAppend(const float* values) {
+  LogRecord record = {};
+  for (int i = 0; i < NUM_BOXES; i++) {
+    if (isnan(values[i])) continue;
+    record.codes[i] = historyScale(i).encode(values[i]);
+    record.valid |= 1 << i;
+  }
+  historyLog.append(record);
+}
+
+/**
+ * @brief Print restore time and flash writes of the log
+ */
+void historyLogReport(Print& out) {
+  const HistoryLogStats& s = historyLog.stats();
+  uint32_t uptime = millis() - bootMs;
+  float perDay = uptime > 0 ? 86400000.0F / uptime : 0.0F;
+  out.printf("History log: %lu ticks restored in %lu ms (%lu bad segments), %lu writes / %lu bytes (%.0f writes, %.0f bytes per day), %lu failed\n",
+             (unsigned long)s.replayed, (unsigned long)(restoreUs / 1000), (unsigned long)s.corrupt, (unsigned long)s.writes,
+             (unsigned long)s.bytesWritten, s.writes * perDay, s.bytesWritten * perDay, (unsigned long)s.failed);
+}
+#endif
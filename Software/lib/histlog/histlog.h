@@ -0,0 +1,171 @@
+/**
+ * @file histlog.h
+ * @brief Append-only log of the history on the flash filesystem
+ *
+ * Contains:
+ * - LogRecord, one history tick as fixed-point codes
+ * - LogStorage, the interface of the file system the segments live on
+ * - HistoryLog, buffered appending, segment rotation and replay
+ * - Functions to run the log of the station on LittleFS
+ *
+ * Every history tick becomes a record of HISTORY_LOG_RECORD_BYTES with a
+ * CRC-32. Records are buffered in RAM and written HISTORY_LOG_FLUSH_RECORDS
+ * at a time, so a day costs a few dozen small appends instead of one per
+ * tick. They go into numbered segment files of HISTORY_LOG_SEGMENT_RECORDS;
+ * old segments are deleted as a whole, nothing is ever rewritten, and
+ * LittleFS spreads the blocks over the partition.
+ *
+ * After a reboot a new segment is started, so a record torn by a power
+ * loss always stays the last one of its segment. Replay stops reading a
+ * segment at the first record whose CRC does not match.
+ */
+
+#ifndef HISTLOG_H
+#define HISTLOG_H
+
+#include <config.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Size of a serialized record: sequence, codes, validity, reserved, CRC-32
+#define HISTORY_LOG_RECORD_BYTES (4 + 2 * NUM_BOXES + 2 + 4)
+
+class Print;
+
+/**
+ * @brief One history tick
+ */
+struct LogRecord {
+  uint32_t sequence;          ///< Tick number, continues across reboots
+  uint16_t codes[NUM_BOXES];  ///< Value of each box as history code
+  uint8_t valid;              ///< Bit per box, set if the box had a reading
+};
+
+/**
+ * @brief File system holding the numbered segments
+ *
+ * A host implementation can simply use files in a directory.
+ */
+class LogStorage {
+ public:
+  virtual ~LogStorage() {}
+
+  /**
+   * @brief Numbers of all existing segments, in any order
+   * @param segments Receives the numbers
+   * @param max Capacity of segments
+   * @return Number of segments found (at most max)
+   */
+  virtual int list(uint32_t* segments, int max) = 0;
+
+  /**
+   * @brief Append bytes to a segment, creating it if needed
+   * @return false if the write failed
+   */
+  virtual bool append(uint32_t segment, const uint8_t* data, size_t len) = 0;
+
+  /**
+   * @brief Read bytes of a segment
+   * @return Number of bytes read, less than len at the end of the segment
+   */
+  virtual size_t read(uint32_t segment, size_t offset, uint8_t* data, size_t len) = 0;
+
+  /**
+   * @brief Delete a segment
+   */
+  virtual void remove(uint32_t segment) = 0;
+};
+
+/**
+ * @brief Counters of the log
+ */
+struct HistoryLogStats {
+  uint32_t replayed;      ///< Records replayed at boot
+  uint32_t corrupt;       ///< Segments whose replay stopped at a bad record
+  uint32_t records;       ///< Records appended since boot
+  uint32_t writes;        ///< Appends to the file system since boot
+  uint32_t bytesWritten;  ///< Bytes appended since boot
+  uint32_t failed;        ///< Appends the file system rejected
+};
+
+/**
+ * @brief Segmented log of history ticks
+ */
+class HistoryLog {
+ public:
+  /// Called for every replayed record, oldest first
+  typedef void (*ReplayCallback)(const LogRecord& record);
+
+  /**
+   * @brief Attach the storage and replay the kept segments
+   * @param storage File system with the segments
+   * @param replay Callback for every valid record, may be nullptr
+   * @return Number of records replayed
+   *
+   * Appending continues in a new segment after the newest one found.
+   */
+  uint32_t begin(LogStorage& storage, ReplayCallback replay);
+
+  /**
+   * @brief Append a record, written once HISTORY_LOG_FLUSH_RECORDS are buffered
+   * @param record Record, its sequence is set by the log
+   */
+  void append(LogRecord record);
+
+  /**
+   * @brief Write the buffered records now
+   */
+  void flush();
+
+  /**
+   * @brief Get the counters
+   */
+  const HistoryLogStats& stats() const { return counters; }
+
+ private:
+  LogStorage* storage = nullptr;  ///< File system, nullptr before begin()
+  uint32_t segment = 0;           ///< Segment being written
+  uint32_t segmentRecords = 0;    ///< Records in the segment being written
+  uint32_t oldest = 0;            ///< Oldest kept segment
+  uint32_t sequence = 0;          ///< Sequence of the next record
+  uint32_t pendingRecords = 0;    ///< Records in pending
+  HistoryLogStats counters = {};  ///< Counters
+
+  /// Records waiting for the next flush()
+  uint8_t pending[HISTORY_LOG_FLUSH_RECORDS * HISTORY_LOG_RECORD_BYTES];
+};
+
+/**
+ * @brief Serialize a record with its CRC
+ * @param record Record
+ * @param out HISTORY_LOG_RECORD_BYTES bytes
+ */
+void logEncode(const LogRecord& record, uint8_t* out);
+
+/**
+ * @brief Check the CRC of a serialized record and decode it
+ * @param in HISTORY_LOG_RECORD_BYTES bytes
+ * @param record Receives the record
+ * @return false if the CRC does not match
+ */
+bool logDecode(const uint8_t* in, LogRecord& record);
+
+/**
+ * @brief Mount LittleFS and restore the history from the log
+ * @return Number of history ticks restored
+ */
+uint32_t historyLogBegin();
+
+/**
+ * @brief Append the current values of all boxes to the log
+ * @param values Value of each box, NAN if the box had no reading
+ */
+void historyLogAppend(const float* values);
+
+/**
+ * @brief Print restore time and flash writes of the log
+ * @param out Output, usually Serial
+ */
+void historyLogReport(Print& out);
+
+#endif  // HISTLOG_H
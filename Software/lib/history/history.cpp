@@ -0,0 +1,298 @@
+/**
+ * @file history.cpp
+ * @brief Implementation of the history ring buffers
+ *
+ * Memory per box: HISTORY_LENGTH codes of 2 bytes plus a validity bit for
+ * the samples (1.5 KB instead of 2.8 KB of floats), 2 * HISTORY_LENGTH
+ * slot indices for the window extrema, plus (HISTORY_15MIN_LENGTH +
+ * HISTORY_HOUR_LENGTH + HISTORY_DAY_LENGTH) aggregates of three codes for
+ * the tiers (4.4 KB instead of 8.7 KB). Tier entries need no validity
+ * bits, only the newest tierCount entries are ever read. A closed bucket is
+ * passed on to the next tier when it closes, so an hour or a day shows up
+ * in its tier one 15-minute bucket after it ended.
+ */
+
+#include <history.h>
+
+/**
+ * @brief Scale of the codes of each box, in the order of the boxes array
+ *
+ * The step is a tenth of the displayed resolution or finer, so the graph
+ * keeps its detail; the range covers everything the sensor can report.
+ */
+static const HistoryScale historyScales[NUM_BOXES] = {
+    {-50.0F, 0.01F},  ///< Temperature: -50 to 605 C
+    {0.0F, 0.01F},    ///< Humidity: 0 to 655 %
+    {250.0F, 0.02F},  ///< Pressure: 250 to 1560 hPa
+    {0.0F, 1.0F},     ///< Ambient light: raw 16-bit counts
+    {0.0F, 1.0F},     ///< White light: raw 16-bit counts
+    {0.0F, 0.05F},    ///< Gas resistance: 0 to 3276 kOhm
+    {0.0F, 16.0F},    ///< UV: raw 20-bit counts
+    {0.0F, 0.001F}};  ///< UV index: 0 to 65
+
+static CompactHistory<HISTORY_LENGTH> rawHistory[NUM_BOXES];    ///< Newest samples of each box
+static WindowMinMax<HISTORY_LENGTH> historyExtrema[NUM_BOXES];  ///< Minimum and maximum of each history
+
+/**
+ * @brief Open bucket of an aggregated tier
+ */
+struct TierBucket {
+  float minimum;    ///< Smallest sample so far
+  float maximum;    ///< Largest sample so far
+  float sum;        ///< Sum of all samples so far
+  uint32_t weight;  ///< Number of raw samples so far, 0 if the bucket is empty
+  uint32_t number;  ///< Bucket number (start time / period)
+};
+
+/**
+ * @brief Tier entry as codes on the scale of its box
+ */
+struct PackedAggregate {
+  uint16_t minimum;  ///< Code of the smallest sample
+  uint16_t mean;     ///< Code of the mean
+  uint16_t maximum;  ///< Code of the largest sample
+};
+
+static PackedAggregate tier15Min[NUM_BOXES][HISTORY_15MIN_LENGTH];  ///< 15-minute aggregates
+static PackedAggregate tierHour[NUM_BOXES][HISTORY_HOUR_LENGTH];    ///< Hourly aggregates
+static PackedAggregate tierDay[NUM_BOXES][HISTORY_DAY_LENGTH];      ///< Daily aggregates
+
+static uint16_t tierIndex[NUM_BOXES][NUM_TIERS];   ///< Next slot of each tier ring
+static uint32_t tierCount[NUM_BOXES][NUM_TIERS];   ///< Entries appended to each tier since boot
+static TierBucket tierBucket[NUM_BOXES][NUM_TIERS];  ///< Open bucket of each tier
+
+static const uint16_t tierLength[NUM_TIERS] = {HISTORY_LENGTH, HISTORY_15MIN_LENGTH, HISTORY_HOUR_LENGTH, HISTORY_DAY_LENGTH};
+static const uint32_t tierPeriod[NUM_TIERS] = {HISTORY_UPDATE_INTERVAL / 1000, 15 * 60, 60 * 60, 24 * 60 * 60};  ///< Bucket length in seconds
+
+/**
+ * @brief Ring of an aggregated tier
+ * @param boxIndex Index of box
+ * @param tier Aggregated tier (not TIER_RAW)
+ * @return First entry of the ring
+ */
+static PackedAggregate* tierRing(int boxIndex, int tier) {
+  switch (tier) {
+    case TIER_15MIN:
+      return tier15Min[boxIndex];
+    case TIER_HOUR:
+      return tierHour[boxIndex];
+    default:
+      return tierDay[boxIndex];
+  }
+}
+
+/**
+ * @brief Add a sample or a closed bucket of the tier below to a tier
+ * @param boxIndex Index of box
+ * @param tier Aggregated tier
+ * @param in Sample or closed bucket
+ * @param weight Number of raw samples in
+ * @param start Start of in in seconds since the first sample
+ *
+ * If in belongs to a later bucket than the open one, the open bucket is
+ * appended to the ring and handed to the next tier first.
+ */
+static void feedTier(int boxIndex, int tier, const HistoryAggregate& in, uint32_t weight, uint32_t start) {
+  TierBucket& bucket = tierBucket[boxIndex][tier];
+  uint32_t number = start / tierPeriod[tier];
+
+  if (bucket.weight > 0 && number != bucket.number) {
+    HistoryAggregate closed = {bucket.minimum, bucket.sum / bucket.weight, bucket.maximum};
+    const HistoryScale& scale = historyScales[boxIndex];
+    uint16_t& slot = tierIndex[boxIndex][tier];
+    tierRing(boxIndex, tier)[slot] = {scale.encode(closed.minimum), scale.encode(closed.mean), scale.encode(closed.maximum)};
+    slot = (slot + 1) % tierLength[tier];
+    tierCount[boxIndex][tier]++;
+
+    if (tier + 1 < NUM_TIERS) {
+      feedTier(boxIndex, tier + 1, closed, bucket.weight, bucket.number * tierPeriod[tier]);
+    }
+    bucket.weight = 0;
+  }
+
+  if (bucket.weight == 0) {
+    bucket.minimum = in.minimum;
+    bucket.maximum = in.maximum;
+    bucket.sum = 0;
+    bucket.number = number;
+  }
+  if (in.minimum < bucket.minimum) bucket.minimum = in.minimum;
+  if (in.maximum > bucket.maximum) bucket.maximum = in.maximum;
+  bucket.sum += in.mean * weight;
+  bucket.weight += weight;
+}
+
+/**
+ * @brief Update history buffer for a box
+ * @param boxIndex Index of box
+ * @param newValue New sensor value to add to history, NAN for a missing reading
+ */
+void updateHistory(int boxIndex, float newValue) {
+  CompactHistory<HISTORY_LENGTH>& ring = rawHistory[boxIndex];
+  uint32_t start = ring.appended() * tierPeriod[TIER_RAW];
+
+  ///< Save new value in history buffer, the overwritten sample leaves the window
+  historyExtrema[boxIndex].evict(ring.nextSlot());
+  uint16_t slot = ring.push(newValue);
+  if (!ring.isValid(slot)) return;
+  historyExtrema[boxIndex].push(slot, ring.raw());
+
+  ///< Fold the stored (rounded) sample into the aggregated tiers
+  float stored = ring.scale.decode(ring.raw()[slot]);
+  HistoryAggregate sample = {stored, stored, stored};
+  feedTier(boxIndex, TIER_15MIN, sample, 1, start);
+}
+
+/**
+ * @brief Read a sample from the history buffer of a box
+ * @param boxIndex Index of box
+ * @param age Age of the sample in history ticks (0 = newest, < HISTORY_LENGTH)
+ * @param value Receives the sample
+ * @return false if no sample was stored there yet
+ */
+bool historyValue(int boxIndex, int age, float& value) {
+  return rawHistory[boxIndex].read(age, value);
+}
+
+/**
+ * @brief Scale of the codes a box is stored with
+ * @param boxIndex Index of box
+ */
+const HistoryScale& historyScale(int boxIndex) {
+  return historyScales[boxIndex];
+}
+
+/**
+ * @brief Round a value to the resolution the history of a box keeps
+ * @param boxIndex Index of box
+ * @param value Sensor value
+ * @return Value as it would be read back from the history
+ */
+float historyRound(int boxIndex, float value) {
+  if (isnan(value)) return value;
+  return historyScales[boxIndex].decode(historyScales[boxIndex].encode(value));
+}
+
+/**
+ * @brief The newest samples of a box from oldest to newest
+ * @param boxIndex Index of box
+ * @param span Number of samples (<= HISTORY_LENGTH)
+ * @return Range for a range-based for loop
+ */
+CompactHistory<HISTORY_LENGTH>::Range historyRange(int boxIndex, uint16_t span) {
+  return rawHistory[boxIndex].newest(span);
+}
+
+/**
+ * @brief Raw sample ring of a box
+ * @param boxIndex Index of box
+ * @return Ring of the newest samples
+ */
+const CompactHistory<HISTORY_LENGTH>& historyRing(int boxIndex) {
+  return rawHistory[boxIndex];
+}
+
+/**
+ * @brief Number of samples appended to the history of a box since boot
+ * @param boxIndex Index of box
+ * @return Sample count
+ */
+uint32_t historyCount(int boxIndex) {
+  return rawHistory[boxIndex].appended();
+}
+
+/**
+ * @brief Minimum and maximum over the whole history of a box
+ * @param boxIndex Index of box
+ * @param minValue Receives the minimum
+ * @param maxValue Receives the maximum
+ * @return false if the history holds no sample yet
+ */
+bool historyMinMax(int boxIndex, float& minValue, float& maxValue) {
+  if (historyExtrema[boxIndex].empty()) return false;
+  const CompactHistory<HISTORY_LENGTH>& ring = rawHistory[boxIndex];
+  minValue = ring.scale.decode(historyExtrema[boxIndex].minimum(ring.raw()));
+  maxValue = ring.scale.decode(historyExtrema[boxIndex].maximum(ring.raw()));
+  return true;
+}
+
+/**
+ * @brief Capacity of a tier
+ * @param tier History tier
+ * @return Number of entries the tier holds
+ */
+uint16_t historyTierLength(int tier) {
+  return tierLength[tier];
+}
+
+/**
+ * @brief Number of entries appended to a tier of a box since boot
+ * @param boxIndex Index of box
+ * @param tier History tier
+ * @return Entry count
+ */
+uint32_t historyTierCount(int boxIndex, int tier) {
+  if (tier == TIER_RAW) return rawHistory[boxIndex].appended();
+  return tierCount[boxIndex][tier];
+}
+
+/**
+ * @brief Read an entry of a tier
+ * @param boxIndex Index of box
+ * @param tier History tier
+ * @param age Age of the entry (0 = newest)
+ * @param entry Receives the entry
+ * @return false if no entry was stored there yet
+ */
+bool historyEntry(int boxIndex, int tier, int age, HistoryAggregate& entry) {
+  if (tier == TIER_RAW) {
+    float val;
+    if (!historyValue(boxIndex, age, val)) return false;
+    entry = {val, val, val};
+    return true;
+  }
+
+  if (age >= tierLength[tier] || (uint32_t)age >= tierCount[boxIndex][tier]) return false;
+  int slot = (tierIndex[boxIndex][tier] - 1 - age + 2 * tierLength[tier]) % tierLength[tier];
+  const PackedAggregate& packed = tierRing(boxIndex, tier)[slot];
+  const HistoryScale& scale = historyScales[boxIndex];
+  entry = {scale.decode(packed.minimum), scale.decode(packed.mean), scale.decode(packed.maximum)};
+  return true;
+}
+
+/**
+ * @brief Minimum and maximum over a whole tier of a box
+ * @param boxIndex Index of box
+ * @param tier History tier
+ * @param minValue Receives the minimum
+ * @param maxValue Receives the maximum
+ * @return false if the tier holds no entry yet
+ */
+bool historyTierMinMax(int boxIndex, int tier, float& minValue, float& maxValue) {
+  if (tier == TIER_RAW) return historyMinMax(boxIndex, minValue, maxValue);
+
+  HistoryAggregate entry;
+  if (!historyEntry(boxIndex, tier, 0, entry)) return false;
+  minValue = entry.minimum;
+  maxValue = entry.maximum;
+  for (int age = 1; historyEntry(boxIndex, tier, age, entry); age++) {
+    if (entry.minimum < minValue) minValue = entry.minimum;
+    if (entry.maximum > maxValue) maxValue = entry.maximum;
+  }
+  return true;
+}
+
+/**
+ * @brief Clear all history buffers and set the scale of every box
+ */
+void initHistory() {
+  for (int i = 0; i < NUM_BOXES; i++) {
+    rawHistory[i].reset(historyScales[i]);
+    historyExtrema[i].reset();
+    for (int t = 0; t < NUM_TIERS; t++) {
+      tierIndex[i][t] = 0;
+      tierCount[i][t] = 0;
+      tierBucket[i][t].weight = 0;
+    }
+  }
+}
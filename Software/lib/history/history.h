@@ -0,0 +1,417 @@
+/**
+ * @file history.h
+ * @brief History ring buffers of all boxes with sliding-window extrema
+ *
+ * Contains:
+ * - WindowMinMax, amortised O(1) minimum/maximum over a ring buffer
+ * - HistoryScale and CompactHistory, a ring of 16-bit fixed-point samples
+ *   with a validity bitmap and an iterator over the newest samples
+ * - HistoryTier and HistoryAggregate for the aggregated history tiers
+ * - Functions to append to and read from the history of a box
+ *
+ * Every box keeps HISTORY_LENGTH samples, one per HISTORY_UPDATE_INTERVAL.
+ * Samples are stored as unsigned 16-bit codes on a per-box scale, so a
+ * sample takes 2 bytes and 1 bit instead of a 4-byte float.
+ * The window extrema are updated on every append, so the detail page can
+ * show the minimum and maximum of the whole history without a scan.
+ *
+ * Older data is kept as minimum/mean/maximum aggregates in three coarser
+ * rings (15 minutes, hours, days). Each closed bucket is folded into the
+ * next tier, so appending a sample costs O(1) and no tier is ever
+ * computed from the raw samples again. Buckets are aligned to the first
+ * sample after boot, the station has no wall clock.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <config.h>
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @brief Sliding-window minimum and maximum over a ring buffer
+ * @tparam N Capacity of the ring buffer (window length)
+ * @tparam Index Type for ring slots, must hold N - 1 (uint32_t for windows over 65535 samples)
+ *
+ * Two monotonic deques hold ring slots whose values are increasing (minimum)
+ * or decreasing (maximum) from front to back. Every slot is pushed and
+ * popped at most once, so an update is amortised O(1). The deques store
+ * slots, not values, which keeps the cost at 2 * N * sizeof(Index) bytes.
+ * Before a slot is overwritten it is evicted; as the oldest slot in the
+ * ring it can only ever be at the front of a deque.
+ */
+template <uint32_t N, typename Index = uint16_t>
+class WindowMinMax {
+ public:
+  /**
+   * @brief Remove all samples from the window
+   */
+  void reset() {
+    minQ.reset();
+    maxQ.reset();
+  }
+
+  /**
+   * @brief Remove a slot that is about to be overwritten
+   * @param slot Ring slot
+   */
+  void evict(Index slot) {
+    if (!minQ.empty() && minQ.front() == slot) minQ.popFront();
+    if (!maxQ.empty() && maxQ.front() == slot) maxQ.popFront();
+  }
+
+  /**
+   * @brief Add a slot that was just written
+   * @param slot Ring slot
+   * @param ring Ring buffer holding the sample values (floats or codes)
+   */
+  template <typename T>
+  void push(Index slot, const T* ring) {
+    T value = ring[slot];
+    while (!minQ.empty() && ring[minQ.back()] >= value) minQ.popBack();
+    while (!maxQ.empty() && ring[maxQ.back()] <= value) maxQ.popBack();
+    minQ.pushBack(slot);
+    maxQ.pushBack(slot);
+  }
+
+  /**
+   * @brief Check whether the window holds any sample
+   * @return true if no sample was pushed or all were evicted
+   */
+  bool empty() const { return minQ.empty(); }
+
+  /**
+   * @brief Minimum of the window, only valid if not empty()
+   * @param ring Ring buffer holding the sample values
+   * @return Smallest sample in the window
+   */
+  template <typename T>
+  T minimum(const T* ring) const { return ring[minQ.front()]; }
+
+  /**
+   * @brief Maximum of the window, only valid if not empty()
+   * @param ring Ring buffer holding the sample values
+   * @return Largest sample in the window
+   */
+  template <typename T>
+  T maximum(const T* ring) const { return ring[maxQ.front()]; }
+
+ private:
+  /**
+   * @brief Fixed-capacity double-ended queue of ring slots
+   */
+  struct Deque {
+    Index slots[N];      ///< Circular storage
+    uint32_t head = 0;   ///< Position of the front element
+    uint32_t count = 0;  ///< Number of elements
+
+    void reset() { head = count = 0; }
+    bool empty() const { return count == 0; }
+    Index front() const { return slots[head]; }
+    Index back() const { return slots[(head + count - 1) % N]; }
+    void popFront() {
+      head = (head + 1) % N;
+      count--;
+    }
+    void popBack() { count--; }
+    void pushBack(Index slot) {
+      slots[(head + count) % N] = slot;
+      count++;
+    }
+  };
+
+  Deque minQ;  ///< Slots with increasing values, front is the minimum
+  Deque maxQ;  ///< Slots with decreasing values, front is the maximum
+};
+
+/**
+ * @brief Mapping between sample values and 16-bit codes
+ *
+ * value = offset + code * step. Values outside [offset, offset + 65535 * step]
+ * are clamped, the step is the resolution kept in the history.
+ */
+struct HistoryScale {
+  float offset;  ///< Value of code 0
+  float step;    ///< Value difference of two neighbouring codes
+
+  /**
+   * @brief Code of a value, rounded to the nearest step and clamped
+   */
+  uint16_t encode(float value) const {
+    float code = roundf((value - offset) / step);
+    if (code < 0) return 0;
+    if (code > 65535) return 65535;
+    return (uint16_t)code;
+  }
+
+  /**
+   * @brief Value of a code
+   */
+  float decode(uint16_t code) const { return offset + code * step; }
+};
+
+/**
+ * @brief Ring of N fixed-point samples with a validity bit per slot
+ * @tparam N Capacity of the ring (< 65536)
+ *
+ * Slots that were never written or received NAN are invalid. Codes are
+ * monotonic in the value, so extrema can be tracked on the codes directly.
+ */
+template <uint16_t N>
+class CompactHistory {
+ public:
+  /**
+   * @brief One sample as seen by the iterator
+   */
+  struct Sample {
+    bool valid;   ///< false if the slot holds no sample
+    float value;  ///< Decoded sample, only meaningful if valid
+  };
+
+  /**
+   * @brief Forward iterator from older to newer samples
+   */
+  class Iterator {
+   public:
+    Iterator(const CompactHistory* ring, uint16_t slot, uint16_t left) : ring(ring), slot(slot), left(left) {}
+    Sample operator*() const { return {ring->isValid(slot), ring->scale.decode(ring->codes[slot])}; }
+    Iterator& operator++() {
+      slot = slot + 1 == N ? 0 : slot + 1;
+      left--;
+      return *this;
+    }
+    bool operator!=(const Iterator& other) const { return left != other.left; }
+
+   private:
+    const CompactHistory* ring;  ///< Ring being iterated
+    uint16_t slot;               ///< Current slot
+    uint16_t left;               ///< Samples left including the current one
+  };
+
+  /**
+   * @brief The newest samples of the ring, usable in a range-based for
+   */
+  struct Range {
+    Iterator first;  ///< Oldest sample of the range
+    Iterator last;   ///< End marker
+    Iterator begin() const { return first; }
+    Iterator end() const { return last; }
+  };
+
+  /**
+   * @brief Clear the ring and set the scale of the codes
+   */
+  void reset(const HistoryScale& newScale) {
+    scale = newScale;
+    next = 0;
+    count = 0;
+    for (uint16_t i = 0; i < (N + 7) / 8; i++) validBits[i] = 0;
+  }
+
+  /**
+   * @brief Append a sample, overwriting the oldest one
+   * @param value Sample, NAN stores an invalid slot
+   * @return Slot that was written
+   */
+  uint16_t push(float value) {
+    uint16_t slot = next;
+    if (isnan(value)) {
+      codes[slot] = 0;
+      validBits[slot / 8] &= ~(1 << (slot % 8));
+    } else {
+      codes[slot] = scale.encode(value);
+      validBits[slot / 8] |= 1 << (slot % 8);
+    }
+    next = next + 1 == N ? 0 : next + 1;
+    count++;
+    return slot;
+  }
+
+  /**
+   * @brief Slot the next push() writes to
+   */
+  uint16_t nextSlot() const { return next; }
+
+  /**
+   * @brief Number of samples appended since the last reset()
+   */
+  uint32_t appended() const { return count; }
+
+  /**
+   * @brief Slot of a sample
+   * @param age Age of the sample (0 = newest, < N)
+   */
+  uint16_t slotOf(uint16_t age) const { return (next + 2 * N - 1 - age) % N; }
+
+  /**
+   * @brief Check whether a slot holds a sample
+   */
+  bool isValid(uint16_t slot) const { return validBits[slot / 8] & (1 << (slot % 8)); }
+
+  /**
+   * @brief Read a sample
+   * @param age Age of the sample (0 = newest, < N)
+   * @param value Receives the sample
+   * @return false if the slot holds no sample
+   */
+  bool read(uint16_t age, float& value) const {
+    uint16_t slot = slotOf(age);
+    if (!isValid(slot)) return false;
+    value = scale.decode(codes[slot]);
+    return true;
+  }
+
+  /**
+   * @brief The span newest samples from oldest to newest
+   * @param span Number of samples (<= N), slots without a sample are included
+   */
+  Range newest(uint16_t span) const {
+    return {Iterator(this, firstSlot(span), span), Iterator(this, next, 0)};
+  }
+
+  /**
+   * @brief Slot of the oldest of the span newest samples
+   * @param span Number of samples (<= N)
+   */
+  uint16_t firstSlot(uint16_t span) const { return (next + N - span) % N; }
+
+  /**
+   * @brief Raw codes for WindowMinMax and the graph transform, indexed by slot
+   */
+  const uint16_t* raw() const { return codes; }
+
+  HistoryScale scale;  ///< Scale of the codes
+
+ private:
+  uint16_t codes[N];               ///< Sample codes
+  uint8_t validBits[(N + 7) / 8];  ///< One bit per slot, set if the slot holds a sample
+  uint16_t next = 0;               ///< Slot of the next push
+  uint32_t count = 0;              ///< Samples appended since reset
+};
+
+/**
+ * @brief Resolutions of the history
+ */
+enum HistoryTier {
+  TIER_RAW,    ///< One sample per HISTORY_UPDATE_INTERVAL (24 hours)
+  TIER_15MIN,  ///< 15-minute aggregates (48 hours)
+  TIER_HOUR,   ///< Hourly aggregates (7 days)
+  TIER_DAY,    ///< Daily aggregates (1 year)
+  NUM_TIERS    ///< Number of tiers
+};
+
+/**
+ * @brief Minimum, mean and maximum of the samples in one bucket
+ */
+struct HistoryAggregate {
+  float minimum;  ///< Smallest sample
+  float mean;     ///< Mean of all samples
+  float maximum;  ///< Largest sample
+};
+
+/**
+ * @brief Update history buffer for a box
+ * @param boxIndex Index of box
+ * @param newValue New sensor value to add to history
+ */
+void updateHistory(int boxIndex, float newValue);
+
+/**
+ * @brief Clear all history buffers and set the scale of every box
+ */
+void initHistory();
+
+/**
+ * @brief Read a sample from the history buffer of a box
+ * @param boxIndex Index of box
+ * @param age Age of the sample in history ticks (0 = newest, < HISTORY_LENGTH)
+ * @param value Receives the sample
+ * @return false if no sample was stored there yet
+ */
+bool historyValue(int boxIndex, int age, float& value);
+
+/**
+ * @brief Scale of the codes a box is stored with
+ * @param boxIndex Index of box
+ */
+const HistoryScale& historyScale(int boxIndex);
+
+/**
+ * @brief Round a value to the resolution the history of a box keeps
+ * @param boxIndex Index of box
+ * @param value Sensor value
+ * @return Value as it would be read back from the history
+ */
+float historyRound(int boxIndex, float value);
+
+/**
+ * @brief The newest samples of a box from oldest to newest
+ * @param boxIndex Index of box
+ * @param span Number of samples (<= HISTORY_LENGTH)
+ * @return Range for a range-based for loop over CompactHistory::Sample
+ */
+CompactHistory<HISTORY_LENGTH>::Range historyRange(int boxIndex, uint16_t span);
+
+/**
+ * @brief Raw sample ring of a box, for code-level access
+ * @param boxIndex Index of box
+ * @return Ring of the newest samples
+ */
+const CompactHistory<HISTORY_LENGTH>& historyRing(int boxIndex);
+
+/**
+ * @brief Number of samples appended to the history of a box since boot
+ * @param boxIndex Index of box
+ * @return Sample count
+ */
+uint32_t historyCount(int boxIndex);
+
+/**
+ * @brief Minimum and maximum over the whole history of a box
+ * @param boxIndex Index of box
+ * @param minValue Receives the minimum
+ * @param maxValue Receives the maximum
+ * @return false if the history holds no sample yet
+ */
+bool historyMinMax(int boxIndex, float& minValue, float& maxValue);
+
+/**
+ * @brief Capacity of a tier
+ * @param tier History tier
+ * @return Number of entries the tier holds
+ */
+uint16_t historyTierLength(int tier);
+
+/**
+ * @brief Number of entries appended to a tier of a box since boot
+ * @param boxIndex Index of box
+ * @param tier History tier
+ * @return Entry count
+ */
+uint32_t historyTierCount(int boxIndex, int tier);
+
+/**
+ * @brief Read an entry of a tier
+ * @param boxIndex Index of box
+ * @param tier History tier, TIER_RAW returns the sample as minimum, mean and maximum
+ * @param age Age of the entry (0 = newest, < historyTierLength())
+ * @param entry Receives the entry
+ * @return false if no entry was stored there yet
+ */
+bool historyEntry(int boxIndex, int tier, int age, HistoryAggregate& entry);
+
+/**
+ * @brief Minimum and maximum over a whole tier of a box
+ * @param boxIndex Index of box
+ * @param tier History tier
+ * @param minValue Receives the minimum
+ * @param maxValue Receives the maximum
+ * @return false if the tier holds no entry yet
+ *
+ * TIER_RAW uses the window extrema, the aggregated tiers scan their
+ * entries (at most HISTORY_DAY_LENGTH).
+ */
+bool historyTierMinMax(int boxIndex, int tier, float& minValue, float& maxValue);
+
+#endif  // HISTORY_H
@@ -0,0 +1,75 @@
+/**
+ * @file logo.cpp
+ * @brief Implementation of the run-length image decoder and the logo data
+ */
+
+#include <logo.h>
+#include <logo_data.h>
+
+/**
+ * @brief Start decoding at the first row
+ */
+RleDecoder::RleDecoder(const RleImage& image)
+    : image(image), pos(0), lengthBits(8 - image.indexBits) {}
+
+/**
+ * @brief Return the next run
+ */
+bool RleDecoder::nextRun(uint16_t& color, uint16_t& count) {
+  if (pos >= image.length) return false;
+  uint8_t run = image.runs[pos++];
+  color = image.palette[run >> lengthBits];
+  count = (run & ((1 << lengthBits) - 1)) + 1;
+  return true;
+}
+
+/**
+ * @brief Decode the next row
+ */
+bool RleDecoder::nextLine(uint16_t* line) {
+  uint16_t x = 0, color, count;
+  while (x < image.width) {
+    if (!nextRun(color, count) || x + count > image.width) return false;
+    for (uint16_t i = 0; i < count; i++) line[x++] = color;
+  }
+  return true;
+}
+
+/**
+ * @brief Write an image to the TFT without a pixel buffer
+ *
+ * Every run becomes one pushBlock() into the address window, so the whole
+ * image is a single write transaction. Colors are sent like pushImage()
+ * would send a raw array with the current swap setting.
+ */
+void pushRleImage(TFT_eSPI& tft, int32_t x, int32_t y, const RleImage& image) {
+  RleDecoder decoder(image);
+  bool swap = !tft.getSwapBytes();
+  uint16_t color, count;
+
+  tft.startWrite();
+  tft.setAddrWindow(x, y, image.width, image.height);
+  while (decoder.nextRun(color, count)) {
+    tft.pushBlock(swap ? (color >> 8) | (color << 8) : color, count);
+  }
+  tft.endWrite();
+}
+
+/**
+ * @brief Draw an image into any drawing target, e.g. a sprite
+ *
+ * Every run becomes one horizontal line, runs never cross a row end.
+ */
+void drawRleImage(TFT_eSPI& target, int32_t x, int32_t y, const RleImage& image) {
+  RleDecoder decoder(image);
+  uint16_t color, count, col = 0, row = 0;
+
+  while (decoder.nextRun(color, count)) {
+    target.drawFastHLine(x + col, y + row, count, color);
+    col += count;
+    if (col >= image.width) {
+      col = 0;
+      row++;
+    }
+  }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file logo_data.h
+ * @brief Run-length encoded logo, generated by tools/logo2rle.py from logo.png
+ *
+ * Do not edit, run the generator again to change the logo.
+ */
+
+#ifndef LOGO_DATA_H
+#define LOGO_DATA_H
+
+#include <logo.h>
+
+static const uint16_t logoPalette[] = {0xFFFF, 0x0000};
+
+static const uint8_t logoRuns[] = {
+    0x77, 0x77, 0x77, 0x77, 0x3A, 0x81, 0x3A, 0x39, 0x83, 0x39, 0x37, 0x86, 0x38, 0x36, 0x89, 0x36,
+    0x34, 0x8D, 0x34, 0x33, 0x8F, 0x33, 0x32, 0x92, 0x31, 0x30, 0x95, 0x30, 0x2F, 0x97, 0x2F, 0x2D,
+    0x9B, 0x2D, 0x2C, 0x9D, 0x2C, 0x2A, 0xA1, 0x2A, 0x29, 0xA3, 0x29, 0x27, 0xA7, 0x27, 0x26, 0xA9,
+    0x26, 0x24, 0xAD, 0x24, 0x23, 0xAF, 0x23, 0x21, 0xB3, 0x21, 0x20, 0xB5, 0x20, 0x1E, 0xB9, 0x1E,
+    0x1D, 0xBB, 0x1D, 0x1B, 0xBF, 0x1B, 0x1A, 0xA5, 0x04, 0x96, 0x1A, 0x18, 0xA5, 0x02, 0x81, 0x02,
+    0x97, 0x18, 0x17, 0xA6, 0x01, 0x84, 0x01, 0x97, 0x17, 0x15, 0xA7, 0x01, 0x85, 0x01, 0x99, 0x15,
+    0x14, 0xA8, 0x01, 0x84, 0x02, 0x84, 0x00, 0x94, 0x14, 0x12, 0x90, 0x02, 0x96, 0x00, 0x85, 0x01,
+    0x85, 0x01, 0x95, 0x12, 0x11, 0x90, 0x01, 0x98, 0x00, 0x8D, 0x0A, 0x8D, 0x11, 0x0F, 0x91, 0x01,
+    0x99, 0x01, 0x8C, 0x03, 0x84, 0x03, 0x8D, 0x0F, 0x0E, 0x91, 0x01, 0x9B, 0x00, 0x8C, 0x01, 0x89,
+    0x02, 0x8C, 0x0E, 0x0C, 0x88, 0x06, 0x82, 0x02, 0x8D, 0x01, 0x8B, 0x01, 0x84, 0x01, 0x82, 0x02,
+    0x8C, 0x01, 0x8D, 0x0C, 0x0B, 0x86, 0x0F, 0x8D, 0x01, 0x8C, 0x01, 0x83, 0x05, 0x8F, 0x01, 0x8D,
+    0x0B, 0x09, 0x86, 0x04, 0x84, 0x07, 0x8D, 0x01, 0x8D, 0x08, 0x93, 0x00, 0x8E, 0x09, 0x08, 0x86,
+    0x02, 0x87, 0x09, 0x8B, 0x01, 0x9D, 0x01, 0x8A, 0x01, 0x8E, 0x08, 0x08, 0x85, 0x01, 0x89, 0x03,
+    0x81, 0x04, 0x89, 0x01, 0x9D, 0x01, 0x8C, 0x01, 0x8D, 0x08, 0x08, 0x84, 0x01, 0x8A, 0x02, 0x83,
+    0x04, 0x88, 0x01, 0x9D, 0x01, 0x86, 0x02, 0x83, 0x00, 0x8D, 0x08, 0x08, 0x83, 0x01, 0x8A, 0x03,
+    0x85, 0x03, 0x86, 0x01, 0x9F, 0x0D, 0x80, 0x01, 0x8C, 0x08, 0x08, 0x83, 0x00, 0x8B, 0x03, 0x85,
+    0x04, 0x84, 0x01, 0xAD, 0x03, 0x8C, 0x08, 0x08, 0x82, 0x01, 0x8B, 0x03, 0x86, 0x04, 0x82, 0x01,
+    0xB0, 0x01, 0x8C, 0x08, 0x08, 0x82, 0x00, 0x84, 0x01, 0x85, 0x03, 0x86, 0x04, 0xC4, 0x08, 0x08,
+    0x81, 0x01, 0x84, 0x02, 0x83, 0x04, 0x87, 0x04, 0x82, 0x05, 0x82, 0x01, 0x81, 0x02, 0x83, 0x04,
+    0x81, 0x04, 0x82, 0x03, 0x81, 0x06, 0x81, 0x04, 0x82, 0x02, 0x83, 0x08, 0x08, 0x81, 0x01, 0x86,
+    0x01, 0x82, 0x04, 0x87, 0x04, 0x81, 0x06, 0x82, 0x02, 0x80, 0x03, 0x80, 0x03, 0x80, 0x02, 0x81,
+    0x03, 0x82, 0x02, 0x81, 0x07, 0x82, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x81, 0x01, 0x86, 0x01,
+    0x82, 0x04, 0x88, 0x03, 0x80, 0x02, 0x82, 0x02, 0x81, 0x07, 0x80, 0x01, 0x82, 0x02, 0x81, 0x03,
+    0x82, 0x01, 0x82, 0x02, 0x82, 0x01, 0x82, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x81, 0x01, 0x86,
+    0x00, 0x83, 0x04, 0x88, 0x03, 0x80, 0x01, 0x83, 0x02, 0x81, 0x04, 0x82, 0x02, 0x82, 0x03, 0x81,
+    0x02, 0x81, 0x02, 0x82, 0x02, 0x83, 0x00, 0x82, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x81, 0x01,
+    0x85, 0x01, 0x83, 0x04, 0x88, 0x03, 0x81, 0x00, 0x83, 0x02, 0x81, 0x03, 0x83, 0x02, 0x83, 0x02,
+    0x82, 0x02, 0x80, 0x01, 0x83, 0x02, 0x87, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x81, 0x01, 0x85,
+    0x00, 0x84, 0x04, 0x88, 0x03, 0x86, 0x02, 0x81, 0x02, 0x84, 0x02, 0x83, 0x01, 0x83, 0x04, 0x84,
+    0x03, 0x86, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x81, 0x01, 0x8B, 0x03, 0x89, 0x03, 0x85, 0x03,
+    0x81, 0x02, 0x84, 0x02, 0x81, 0x03, 0x84, 0x03, 0x84, 0x05, 0x84, 0x09, 0x83, 0x08, 0x08, 0x82,
+    0x00, 0x8B, 0x03, 0x89, 0x03, 0x83, 0x05, 0x81, 0x02, 0x83, 0x03, 0x80, 0x02, 0x86, 0x03, 0x85,
+    0x05, 0x83, 0x09, 0x83, 0x08, 0x08, 0x82, 0x01, 0x8A, 0x03, 0x89, 0x03, 0x81, 0x02, 0x81, 0x02,
+    0x81, 0x02, 0x83, 0x05, 0x88, 0x03, 0x86, 0x05, 0x82, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x83,
+    0x01, 0x89, 0x03, 0x88, 0x04, 0x80, 0x02, 0x82, 0x02, 0x81, 0x02, 0x83, 0x03, 0x8A, 0x03, 0x88,
+    0x04, 0x81, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x84, 0x01, 0x88, 0x03, 0x88, 0x03, 0x81, 0x02,
+    0x82, 0x02, 0x81, 0x02, 0x84, 0x02, 0x89, 0x01, 0x80, 0x02, 0x88, 0x03, 0x81, 0x02, 0x83, 0x02,
+    0x83, 0x08, 0x08, 0x85, 0x04, 0x84, 0x03, 0x88, 0x03, 0x80, 0x03, 0x82, 0x02, 0x81, 0x02, 0x84,
+    0x02, 0x89, 0x01, 0x80, 0x02, 0x89, 0x02, 0x81, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x8E, 0x04,
+    0x88, 0x03, 0x80, 0x03, 0x82, 0x02, 0x81, 0x02, 0x84, 0x03, 0x87, 0x01, 0x82, 0x02, 0x82, 0x00,
+    0x85, 0x01, 0x81, 0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x8E, 0x04, 0x87, 0x03, 0x81, 0x03, 0x81,
+    0x03, 0x81, 0x02, 0x84, 0x03, 0x83, 0x01, 0x81, 0x01, 0x82, 0x02, 0x82, 0x01, 0x84, 0x01, 0x81,
+    0x02, 0x83, 0x02, 0x83, 0x08, 0x08, 0x8E, 0x03, 0x87, 0x03, 0x83, 0x08, 0x81, 0x02, 0x85, 0x07,
+    0x81, 0x02, 0x82, 0x03, 0x81, 0x02, 0x82, 0x02, 0x81, 0x03, 0x82, 0x02, 0x83, 0x08, 0x08, 0x8E,
+    0x03, 0x87, 0x02, 0x84, 0x04, 0x80, 0x03, 0x80, 0x03, 0x85, 0x05, 0x81, 0x03, 0x82, 0x04, 0x80,
+    0x07, 0x81, 0x04, 0x82, 0x02, 0x83, 0x08, 0x08, 0x8E, 0x02, 0x86, 0x04, 0x85, 0x02, 0x82, 0x01,
+    0x81, 0x03, 0x86, 0x03, 0x82, 0x03, 0x82, 0x04, 0x80, 0x06, 0x82, 0x04, 0x82, 0x02, 0x83, 0x08,
+    0x08, 0x8D, 0x03, 0x85, 0x03, 0xC9, 0x08, 0x08, 0x88, 0x11, 0xCA, 0x08, 0x08, 0x86, 0x11, 0xCC,
+    0x08, 0x08, 0x85, 0x10, 0xAD, 0x06, 0x8F, 0x02, 0x86, 0x08, 0x08, 0x84, 0x01, 0x94, 0x07, 0x87,
+    0x04, 0x81, 0x03, 0x88, 0x10, 0x8A, 0x03, 0x85, 0x08, 0x08, 0x84, 0x01, 0x89, 0x00, 0x86, 0x0E,
+    0x83, 0x01, 0x81, 0x01, 0x80, 0x01, 0x87, 0x05, 0x87, 0x07, 0x88, 0x00, 0x81, 0x00, 0x85, 0x08,
+    0x08, 0x84, 0x01, 0x87, 0x02, 0x82, 0x04, 0x8B, 0x06, 0x84, 0x01, 0x85, 0x04, 0x8F, 0x06, 0x87,
+    0x01, 0x85, 0x08, 0x08, 0x85, 0x00, 0x85, 0x02, 0x84, 0x07, 0x8A, 0x05, 0x84, 0x01, 0x83, 0x02,
+    0x94, 0x01, 0x80, 0x05, 0x81, 0x03, 0x85, 0x08, 0x08, 0x85, 0x07, 0x8C, 0x03, 0x86, 0x07, 0x86,
+    0x00, 0x80, 0x08, 0x91, 0x01, 0x81, 0x08, 0x86, 0x08, 0x08, 0x88, 0x01, 0x92, 0x02, 0x82, 0x03,
+    0x83, 0x02, 0x85, 0x0F, 0x8E, 0x00, 0x81, 0x05, 0x88, 0x08, 0x08, 0x9E, 0x02, 0x80, 0x01, 0x88,
+    0x09, 0x89, 0x03, 0x8E, 0x00, 0x81, 0x00, 0x8C, 0x08, 0x08, 0xA0, 0x02, 0x8B, 0x07, 0x8C, 0x01,
+    0x8D, 0x01, 0x8E, 0x08, 0x08, 0x9F, 0x00, 0x80, 0x03, 0x89, 0x04, 0x90, 0x01, 0x8D, 0x01, 0x8D,
+    0x08, 0x08, 0x92, 0x01, 0x89, 0x00, 0x83, 0x03, 0x85, 0x05, 0x92, 0x01, 0x8C, 0x01, 0x8D, 0x08,
+    0x08, 0x91, 0x01, 0x88, 0x01, 0x86, 0x0D, 0x93, 0x00, 0x8D, 0x00, 0x8D, 0x08, 0x08, 0x91, 0x01,
+    0x86, 0x02, 0x8A, 0x03, 0x83, 0x02, 0x93, 0x00, 0x87, 0x01, 0x83, 0x00, 0x8D, 0x08, 0x08, 0x92,
+    0x01, 0x84, 0x01, 0x94, 0x00, 0x80, 0x00, 0x93, 0x00, 0x86, 0x02, 0x82, 0x01, 0x8D, 0x08, 0x08,
+    0x93, 0x06, 0x94, 0x00, 0x81, 0x01, 0x88, 0x01, 0x87, 0x00, 0x86, 0x01, 0x83, 0x01, 0x8D, 0x08,
+    0x08, 0x94, 0x02, 0x96, 0x01, 0x81, 0x01, 0x88, 0x01, 0x87, 0x00, 0x86, 0x01, 0x82, 0x01, 0x8E,
+    0x08, 0x08, 0xAD, 0x01, 0x82, 0x01, 0x89, 0x01, 0x85, 0x01, 0x87, 0x04, 0x8F, 0x08, 0x09, 0xA2,
+    0x00, 0x87, 0x01, 0x83, 0x02, 0x83, 0x01, 0x82, 0x02, 0x82, 0x02, 0x89, 0x02, 0x8F, 0x09, 0x0B,
+    0x9F, 0x01, 0x86, 0x01, 0x85, 0x01, 0x83, 0x00, 0x85, 0x05, 0x9B, 0x0B, 0x0C, 0x9E, 0x02, 0x83,
+    0x02, 0x87, 0x05, 0xA6, 0x0C, 0x0E, 0x9D, 0x07, 0x8A, 0x01, 0xA7, 0x0D, 0x0F, 0x9E, 0x02, 0xB5,
+    0x0F, 0x11, 0x8D, 0x00, 0x89, 0x02, 0x8A, 0x00, 0x84, 0x00, 0x83, 0x02, 0x80, 0x00, 0x84, 0x00,
+    0x82, 0x00, 0x93, 0x10, 0x12, 0x8C, 0x00, 0x89, 0x00, 0x80, 0x01, 0x8F, 0x00, 0x83, 0x00, 0x88,
+    0x00, 0x82, 0x00, 0x91, 0x12, 0x14, 0x8A, 0x02, 0x80, 0x00, 0x80, 0x00, 0x83, 0x00, 0x81, 0x00,
+    0x80, 0x02, 0x80, 0x00, 0x83, 0x00, 0x80, 0x02, 0x80, 0x00, 0x83, 0x00, 0x82, 0x00, 0x80, 0x02,
+    0x80, 0x02, 0x80, 0x00, 0x81, 0x02, 0x80, 0x00, 0x89, 0x13, 0x15, 0x89, 0x00, 0x80, 0x00, 0x80,
+    0x00, 0x80, 0x00, 0x83, 0x00, 0x81, 0x00, 0x82, 0x00, 0x80, 0x03, 0x80, 0x00, 0x80, 0x00, 0x80,
+    0x00, 0x80, 0x00, 0x83, 0x02, 0x80, 0x00, 0x80, 0x00, 0x82, 0x00, 0x80, 0x00, 0x80, 0x00, 0x81,
+    0x00, 0x80, 0x00, 0x80, 0x02, 0x85, 0x15, 0x17, 0x87, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00,
+    0x83, 0x00, 0x81, 0x00, 0x80, 0x02, 0x80, 0x00, 0x81, 0x00, 0x80, 0x00, 0x80, 0x02, 0x80, 0x00,
+    0x85, 0x00, 0x80, 0x00, 0x80, 0x00, 0x82, 0x00, 0x80, 0x00, 0x80, 0x00, 0x81, 0x02, 0x80, 0x00,
+    0x85, 0x17, 0x18, 0x86, 0x00, 0x80, 0x00, 0x80, 0x02, 0x83, 0x00, 0x80, 0x01, 0x80, 0x00, 0x80,
+    0x00, 0x80, 0x00, 0x81, 0x00, 0x80, 0x00, 0x80, 0x00, 0x82, 0x00, 0x85, 0x00, 0x80, 0x00, 0x80,
+    0x00, 0x82, 0x00, 0x80, 0x00, 0x80, 0x00, 0x81, 0x00, 0x82, 0x00, 0x84, 0x18, 0x1A, 0x84, 0x02,
+    0x82, 0x00, 0x83, 0x02, 0x81, 0x02, 0x80, 0x00, 0x81, 0x00, 0x80, 0x00, 0x80, 0x02, 0x80, 0x01,
+    0x82, 0x02, 0x80, 0x00, 0x80, 0x02, 0x80, 0x00, 0x80, 0x00, 0x80, 0x01, 0x80, 0x02, 0x80, 0x00,
+    0x82, 0x1A, 0x1B, 0x89, 0x00, 0xB4, 0x1B, 0x1D, 0x85, 0x02, 0xB3, 0x1C, 0x1E, 0xB9, 0x1E, 0x20,
+    0xB6, 0x1F, 0x21, 0xB3, 0x21, 0x23, 0xB0, 0x22, 0x24, 0xAD, 0x24, 0x26, 0xA9, 0x26, 0x27, 0xA7,
+    0x27, 0x29, 0xA3, 0x29, 0x2A, 0xA1, 0x2A, 0x2C, 0x9D, 0x2C, 0x2D, 0x9B, 0x2D, 0x2F, 0x97, 0x2F,
+    0x30, 0x95, 0x30, 0x32, 0x91, 0x32, 0x33, 0x8F, 0x33, 0x35, 0x8B, 0x35, 0x36, 0x89, 0x36, 0x38,
+    0x85, 0x38, 0x39, 0x83, 0x39, 0x77, 0x77, 0x77, 0x77, 0x77,
+};
+
+const RleImage logoImage = {120, 120, 1, logoPalette, logoRuns, sizeof(logoRuns)};
+
+#endif  // LOGO_DATA_H
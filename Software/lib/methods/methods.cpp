@@ -5,12 +5,19 @@
  * This file contains the implementation of:
  * - Sensor configuration (BME680, LTR390, VCNL4040)
  * - Layout and drawing of boxes on the main screen
- * - Updating sensor values (real or dummy)
- * - Display backlight control based on ambient light and proximity
- * - Detail page rendering with TFT sprites for smooth updates
+ * - Updating sensor values from the sensors or a SensorSource (demo mode)
+ * - Detail page rendering with persistent TFT sprites for smooth updates
  */
 
+#include <archive.h>
+#include <compositor.h>
+#include <display.h>
+#include <glyphs.h>
+#include <graph.h>
+#include <histlog.h>
 #include <methods.h>
+#include <sprites.h>
+#include <trace.h>
 
 extern TFT_eSPI tft;            ///< TFT object
 extern Adafruit_BME680 bme;     ///< BME680 sensor
@@ -20,35 +27,41 @@ extern bool bme_ok;             ///< Flag indicating BME680 sensor status
 extern bool vcnl_ok;            ///< Flag indicating VCNL4040 sensor status
 extern bool ltr_ok;             ///< Flag indicating LTR390 sensor status
 
-///< Sensor value variables
-float tempValue = 0.0;
-float humidValue = 0.0;
-float pressureValue = 0.0;
-float gasValue = 0.0;
-float distanceValue = 0.0;
-float ambientValue = 0.0;
-float whiteValue = 0.0;
-float uvValue = 0.0;
-float uvIndexValue = 0.0;
-float proximityValue = 0.0;
+///< Sensor values owned by the sensor task, published after every pass
+static SensorSnapshot sensorValues = {};
+
+///< Sensor values owned by the UI task, taken over from the last snapshot
+SensorSnapshot displayValues = {};
+
+///< Lock-free hand-over of snapshots from the sensor task to the UI task
+static TripleBuffer<SensorSnapshot> snapshotExchange;
 
 ///< Last value drawn on detail page to avoid flicker
 extern float lastDetailValue;
 
-float historyBuffers[NUM_BOXES][HISTORY_LENGTH] = {-999.0};  ///< History buffers for graphs
-int historyIndex[NUM_BOXES] = {0};                           ///< Current index in history buffers
-bool detailGraphNeedsRedraw = true;                          ///< Flag to indicate graph redraw needed
+bool detailGraphNeedsRedraw = true;  ///< Flag to indicate graph redraw needed
+int detailTier = TIER_RAW;           ///< History tier or GRAPH_VIEW_ARCHIVE shown on the detail page
+
+#define DETAIL_GRAPH_X ((SCREEN_WIDTH - GRAPH_WIDTH) / 2)  ///< Left edge of the detail graph
+#define DETAIL_GRAPH_Y 150                                ///< Top edge of the detail graph
+
+/// Time span of each graph view, below the graph and in the min/max labels
+static const char* const tierSpan[NUM_GRAPH_VIEWS] = {"Letzte 24 Stunden", "Letzte 48 Stunden", "Letzte 7 Tage", "Letztes Jahr", "Gesamtes Archiv"};
+static const char* const tierShort[NUM_GRAPH_VIEWS] = {"24h", "48h", "7 Tage", "1 Jahr", "Archiv"};
+
+static int shownSpanTier = -1;  ///< View whose span label is on the detail page, -1 if none
+static char shownMinMax[168];   ///< Min and max label text on the detail page, empty if none
 
 /// Array of boxes displayed on screen
 Box boxes[NUM_BOXES] = {
-    {"Temperatur", &tempValue, "C", 0, 0, 0, 0, 1},
-    {"Luftfeuchtigkeit", &humidValue, "%", 0, 0, 0, 0, 1},
-    {"Luftdruck", &pressureValue, "hPa", 0, 0, 0, 0, 0},
-    {"Umgebungslicht", &ambientValue, "lux", 0, 0, 0, 0, 0},
-    {"Weisses Licht", &whiteValue, "", 0, 0, 0, 0, 0},
-    {"Gas", &gasValue, "", 0, 0, 0, 0, 0},
-    {"UV Licht", &uvValue, "", 0, 0, 0, 0, 2},
-    {"UV Index", &uvIndexValue, "", 0, 0, 0, 0, 1}};
+    {"Temperatur", &displayValues.temp, "C", 0, 0, 0, 0, 1, 0.0, 0, 0},
+    {"Luftfeuchtigkeit", &displayValues.humid, "%", 0, 0, 0, 0, 1, 0.0, 0, 0},
+    {"Luftdruck", &displayValues.pressure, "hPa", 0, 0, 0, 0, 0, 0.0, 0, 0},
+    {"Umgebungslicht", &displayValues.ambient, "lux", 0, 0, 0, 0, 0, 1.0, 0, 0},
+    {"Weisses Licht", &displayValues.white, "", 0, 0, 0, 0, 0, 2.0, 0, 0},
+    {"Gas", &displayValues.gas, "", 0, 0, 0, 0, 0, 1.0, 0, 0},
+    {"UV Licht", &displayValues.uv, "", 0, 0, 0, 0, 2, 0.0, 0, 0},
+    {"UV Index", &displayValues.uvIndex, "", 0, 0, 0, 0, 1, 0.0, 0, 0}};
 
 /**
  * @brief Configure all sensors (BME680, LTR390, VCNL4040) with desired parameters
@@ -116,7 +129,12 @@ void drawLogo() {
   int xCenter = x + (boxW - LOGO_WIDTH) / 2;
   int yCenter = y + (boxH - LOGO_HEIGHT) / 2;
 
-  tft.pushImage(xCenter, yCenter, LOGO_WIDTH, LOGO_HEIGHT, logo);
+  if (displayBuffered()) {
+    drawRleImage(canvas(), xCenter, yCenter, logoImage);
+    displayMarkDirty(xCenter, yCenter, LOGO_WIDTH, LOGO_HEIGHT);
+  } else {
+    pushRleImage(tft, xCenter, yCenter, logoImage);
+  }
 }
 
 /**
@@ -124,130 +142,496 @@ void drawLogo() {
  * @param i Index of box in boxes array
  */
 void drawBox(int i) {
-  tft.fillRoundRect(boxes[i].x, boxes[i].y, boxes[i].w, boxes[i].h, BOX_RADIUS, BOX_COLOR);
-  tft.setTextColor(TITLE_COLOR, BOX_COLOR);
-  tft.setTextDatum(TC_DATUM);
-  tft.setFreeFont(&FreeSansBold12pt7b);
-  tft.drawString(boxes[i].title, boxes[i].x + boxes[i].w / 2, boxes[i].y + 15, 1);
+  TFT_eSPI& target = canvas();
+  target.fillRoundRect(boxes[i].x, boxes[i].y, boxes[i].w, boxes[i].h, BOX_RADIUS, BOX_COLOR);
+  target.setTextColor(TITLE_COLOR, BOX_COLOR);
+  target.setTextDatum(TC_DATUM);
+  target.setFreeFont(&FreeSansBold12pt7b);
+  target.drawString(boxes[i].title, boxes[i].x + boxes[i].w / 2, boxes[i].y + 15, 1);
+  displayMarkDirty(boxes[i].x, boxes[i].y, boxes[i].w, boxes[i].h);
 }
 
+/// Sensor jobs, each one is a single I2C transaction
+enum SensorJob { JOB_BME, JOB_PROXIMITY, JOB_AMBIENT, JOB_UV, NUM_SENSOR_JOBS };
+
+/// Schedule of the sensor jobs, the phases spread them over different passes
+static SchedTask sensorJobs[NUM_SENSOR_JOBS] = {
+    {"BME688", "temp, humid, pressure, gas", BME_UPDATE_INTERVAL, 0, 0, 0, 0, 0, 0, 0, 0},
+    {"VCNL4040 prox", "proximity", PROXIMITY_UPDATE_INTERVAL, 10, 0, 0, 0, 0, 0, 0, 0},
+    {"VCNL4040 light", "ambient, white", AMBIENT_UPDATE_INTERVAL, 30, 0, 0, 0, 0, 0, 0, 0},
+    {"LTR390", "uv, uvIndex", UV_UPDATE_INTERVAL, 50, 0, 0, 0, 0, 0, 0, 0}};
+
+static SchedTask historyJob = {"History", "all boxes", HISTORY_UPDATE_INTERVAL, HISTORY_UPDATE_INTERVAL, 0, 0, 0, 0, 0, 0, 0};  ///< History tick
+static SchedTask reportJob = {"Report", "", SCHED_REPORT_INTERVAL, SCHED_REPORT_INTERVAL, 0, 0, 0, 0, 0, 0, 0};                 ///< Statistics output
+
+/// True while a split-phase BME688 conversion is in flight
+static bool bmeMeasuring = false;
+
+/// Replaces the sensors if set, e.g. the synthetic weather of the demo mode
+static SensorSource* sensorSource = nullptr;
+
 /**
- * @brief Update all sensor values, read real sensors if available, else dummy values
+ * @brief Take over a BME688 conversion
  *
- * Also sets display backlight:
- * - Full brightness if hand is near (proximity)
- * - Else adaptive brightness based on ambient light
+ * All raw readings pass through the store functions, which hand them to
+ * the trace recorder on the way.
+ */
+static void storeClimate(const ClimateReading& reading) {
+  traceClimate(millis(), reading);
+  sensorValues.temp = reading.temperature;
+  sensorValues.humid = reading.humidity;
+  sensorValues.pressure = reading.pressure / 100.0F;
+  sensorValues.gas = reading.gasResistance / 1000.0F;
+}
+
+/**
+ * @brief Take over a raw LTR390 reading and calculate the UV index
+ */
+static void storeUV(uint32_t uvs) {
+  traceUV(millis(), uvs);
+  sensorValues.uv = uvs;
+  float uv_mW_per_cm2 = (float)sensorValues.uv / 1048575.0 * 15.0;
+  sensorValues.uvIndex = uv_mW_per_cm2 / 0.25;
+  if (sensorValues.uvIndex > 11.0) sensorValues.uvIndex = 11.0;
+}
+
+/**
+ * @brief Take over a proximity reading
+ */
+static void storeProximity(uint16_t proximity) {
+  traceProximity(millis(), proximity);
+  sensorValues.proximity = proximity;
+}
+
+/**
+ * @brief Take over a light reading
+ */
+static void storeLight(const LightReading& reading) {
+  traceLight(millis(), reading);
+  sensorValues.ambient = reading.ambient;
+  sensorValues.white = reading.white;
+  sensorValues.ambientTick++;
+}
+
+/**
+ * @brief Drive the split-phase BME688 acquisition
+ * @param startConversion Start a new conversion if the sensor is idle
+ * @return true if a finished conversion was collected
+ *
+ * beginReading() starts the TPH conversion and the gas heater and returns
+ * immediately. The result is collected with endReading() on a later pass,
+ * once remainingReadingMillis() reports the measurement as complete, so the
+ * caller never waits for HEATER_DURATION.
+ */
+static bool pollBme(bool startConversion) {
+  bool collected = false;
+  if (!bme_ok) return false;
+
+  if (bmeMeasuring) {
+    if (bme.remainingReadingMillis() > 0) return false;  ///< Still converting
+
+    bmeMeasuring = false;
+    collected = bme.endReading();
+    if (collected) storeClimate({bme.temperature, bme.humidity, bme.pressure, bme.gas_resistance});
+  }
+
+  if (startConversion) bmeMeasuring = bme.beginReading() != 0;
+  return collected;
+}
+
+/**
+ * @brief Check whether the first readings are still outstanding
+ *
+ * The jobs start at different phases, so right after boot some channels
+ * have no reading yet. Missing sensors count as read, their job runs too.
+ */
+bool sensorsPending() {
+  for (int job = 0; job < NUM_SENSOR_JOBS; job++) {
+    if (sensorJobs[job].runs == 0) return true;
+  }
+  return bmeMeasuring;
+}
+
+/**
+ * @brief Run one sensor job on the sensor source
+ * @param job Job to run
+ *
+ * The source answers right away, so the BME688 job has no split phase.
+ */
+static void runSourceJob(int job) {
+  uint32_t now = millis();
+  ClimateReading climate;
+  LightReading light;
+  uint16_t proximity;
+  uint32_t uvs;
+
+  switch (job) {
+    case JOB_BME:
+      if (sensorSource->readClimate(now, climate)) storeClimate(climate);
+      break;
+
+    case JOB_PROXIMITY:
+      if (sensorSource->readProximity(now, proximity)) storeProximity(proximity);
+      break;
+
+    case JOB_AMBIENT:
+      if (sensorSource->readLight(now, light)) storeLight(light);
+      break;
+
+    case JOB_UV:
+      if (sensorSource->readUV(now, uvs)) storeUV(uvs);
+      break;
+  }
+}
+
+/**
+ * @brief Run one sensor job
+ * @param job Job to run
+ *
+ * Every job is a single I2C transaction on one device.
+ */
+static void runSensorJob(int job) {
+  if (sensorSource) {
+    runSourceJob(job);
+    return;
+  }
+
+  switch (job) {
+    case JOB_BME:
+      pollBme(true);
+      break;
+
+    case JOB_PROXIMITY:
+      if (vcnl_ok) storeProximity(vcnl.getProximity());
+      break;
+
+    case JOB_AMBIENT:
+      if (vcnl_ok) storeLight({vcnl.getAmbientLight(), vcnl.getWhiteLight()});
+      break;
+
+    case JOB_UV:
+      // Read LTR390 UV sensor and calculate UV Index
+      if (ltr_ok) storeUV(ltr.readUVS());
+      break;
+  }
+}
+
+/**
+ * @brief Replace the sensors by a source
+ * @param source Source read by the sensor jobs, nullptr for the sensors
+ */
+void setSensorSource(SensorSource* source) {
+  sensorSource = source;
+}
+
+/**
+ * @brief Get the sensor source in use
+ */
+SensorSource* sensorSourceInUse() {
+  return sensorSource;
+}
+
+/**
+ * @brief Update all sensor values from the sensors or the sensor source
+ *
+ * Runs in the sensor task. Every sensor is sampled by its own scheduler job
+ * and at most one I2C transaction happens per call, so the bus load is
+ * spread over the passes. The BME680 is read without blocking: a job starts
+ * the conversion and a later call collects the result. Every pass that
+ * changed a value publishes a new snapshot for the UI task.
  */
 void updateValues() {
-  static unsigned long lastFastUpdate = 0;
-  static unsigned long lastHistoryUpdate = 0;
-  unsigned long currentTime = millis();
+  static bool jobsStarted = false;
+  uint32_t now = millis();
+  bool changed = false;
+
+  if (!jobsStarted) {
+    schedStart(sensorJobs, NUM_SENSOR_JOBS, now);
+    schedStart(&historyJob, 1, now);
+    schedStart(&reportJob, 1, now);
+    jobsStarted = true;
+  }
 
-  bool doFastUpdate = false;
-  bool doHistoryUpdate = false;
+  ///< Flag a history tick every HISTORY_UPDATE_INTERVAL, the UI task appends the samples
+  if (schedDue(historyJob, now)) {
+    sensorValues.historyTick++;
+    changed = true;
+  }
 
-  ///< Fast update every FAST_UPDATE_INTERVAL milliseconds
-  if (currentTime - lastFastUpdate >= FAST_UPDATE_INTERVAL) {
-    lastFastUpdate = currentTime;
-    doFastUpdate = true;
+  ///< Collecting a finished BME680 conversion uses up this pass's I2C transaction
+  if (pollBme(false)) {
+    changed = true;
+  } else {
+    int job = schedMostOverdue(sensorJobs, NUM_SENSOR_JOBS, now);
+    if (job >= 0) {
+      runSensorJob(job);
+      schedRan(sensorJobs[job], now);
+      changed = true;
+    }
   }
 
-  ///< History update every HISTORY_UPDATE_INTERVAL milliseconds
-  if (doFastUpdate && (currentTime - lastHistoryUpdate >= HISTORY_UPDATE_INTERVAL)) {
-    lastHistoryUpdate = currentTime;
-    doHistoryUpdate = true;
+  ///< Hand the new readings over to the UI task
+  if (changed) {
+    sensorValues.version++;
+    snapshotExchange.publish(sensorValues);
+  }
+
+  if (schedDue(reportJob, now)) schedReport(Serial, sensorJobs, NUM_SENSOR_JOBS);
+}
+
+/**
+ * @brief Take over the newest sensor snapshot in the UI task
+ * @return true if a new snapshot was received
+ *
+ * Copies the snapshot into displayValues, which the boxes point at, and
+ * appends to the history buffers, the archive and the flash log whenever
+ * the sensor task flagged a history tick.
+ */
+bool syncValues() {
+  static uint32_t lastHistoryTick = 0;
+
+  if (!snapshotExchange.update()) return false;
+  displayValues = snapshotExchange.read();
+
+  ///< Save every HISTORY_UPDATE_INTERVAL points to history buffers
+  if (displayValues.historyTick != lastHistoryTick) {
+    lastHistoryTick = displayValues.historyTick;
+    float rounded[NUM_BOXES];
+    for (int i = 0; i < NUM_BOXES; i++) {
+      updateHistory(i, *boxes[i].value);
+      rounded[i] = historyRound(i, *boxes[i].value);  ///< Unchanged values compress to one bit
+    }
+    archiveAppend(lastHistoryTick * (HISTORY_UPDATE_INTERVAL / 1000), rounded);
+    historyLogAppend(rounded);
     detailGraphNeedsRedraw = true;
   }
+  return true;
+}
+
+/**
+ * @brief FreeRTOS task body running the sensor acquisition loop
+ * @param param Unused
+ */
+static void sensorTask(void* param) {
+  (void)param;
+  for (;;) {
+    updateValues();
+    vTaskDelay(pdMS_TO_TICKS(SENSOR_TASK_PERIOD));
+  }
+}
+
+/**
+ * @brief Start the sensor acquisition task on SENSOR_TASK_CORE
+ *
+ * The Arduino loop() task stays on the other core and only does touch
+ * handling and drawing.
+ */
+void startSensorTask() {
+  xTaskCreatePinnedToCore(sensorTask, "sensors", SENSOR_TASK_STACK, nullptr, SENSOR_TASK_PRIORITY, nullptr, SENSOR_TASK_CORE);
+}
+
+static GlyphAtlas boxAtlas(&tft);          ///< Font 4 characters and units of the boxes
+static GlyphAtlas detailValueAtlas(&tft);  ///< Large characters of the detail value
+static GlyphAtlas detailUnitAtlas(&tft);   ///< Units of the detail value
+static int boxUnitGlyph[NUM_BOXES];        ///< Unit token of each box in boxAtlas
+static int detailUnitGlyph[NUM_BOXES];     ///< Unit token of each box in detailUnitAtlas
 
-  ///< If no fast update needed, return
-  if (!doFastUpdate) return;
+///< Values currently drawn in the boxes (NAN if the box is empty)
+static float shownValues[NUM_BOXES];
 
-  // Read BME680 sensor values
-  if (bme_ok && bme.performReading()) {
-    tempValue = bme.temperature;
-    humidValue = bme.humidity;
-    pressureValue = bme.pressure / 100.0F;
-    gasValue = bme.gas_resistance / 1000.0F;
+///< Last sample seen by updateValue(), to count every sample once
+static float seenValues[NUM_BOXES];
+
+///< Compositor widget of each box value
+static int boxWidgets[NUM_BOXES];
+
+///< Characters a formatted value can consist of
+static const char VALUE_CHARS[] = "0123456789.-";
+
+/**
+ * @brief Render the characters and units of all values into glyph atlases
+ *
+ * Must be called once after the TFT is initialized. Values are composed by
+ * copying pre-rendered glyphs afterwards, the font is not decoded again.
+ * If an atlas cannot be allocated the affected values stay blank.
+ */
+void initValueGlyphs() {
+  char boxUnit[NUM_BOXES][8];
+  int16_t boxWidth = 0, valueWidth = 0, unitWidth = 0;
+
+  boxAtlas.setFont(nullptr, 4);
+  detailValueAtlas.setFont(&FreeSansBold24pt7b);
+  detailUnitAtlas.setFont(&FreeSansBold12pt7b);
+
+  ///< Size the atlases, a character cell is never wider than the character doubled
+  for (const char* c = VALUE_CHARS; *c; c++) {
+    char twice[3] = {*c, *c, 0};
+    boxWidth += boxAtlas.measure(twice);
+    valueWidth += detailValueAtlas.measure(twice);
+  }
+  for (int i = 0; i < NUM_BOXES; i++) {
+    bool isTemp = strcmp(boxes[i].title, "Temperatur") == 0;
+    snprintf(boxUnit[i], sizeof(boxUnit[i]), isTemp ? "  C" : " %s", boxes[i].unit);  ///< Extra space for temperature circle
+    boxWidth += boxAtlas.measure(boxUnit[i]);
+    unitWidth += detailUnitAtlas.measure(isTemp ? "C" : boxes[i].unit) + (isTemp ? 10 : 0);
   }
 
-  // Read VCNL4040 sensor values
-  if (vcnl_ok) {
-    ambientValue = vcnl.getAmbientLight();
-    whiteValue = vcnl.getWhiteLight();
-    proximityValue = vcnl.getProximity();
+  ///< The value sprites are 1-bit, so are their atlases
+  boxAtlas.create(boxWidth, 40, TEXT_INK, TEXT_INK_BACKGROUND, TL_DATUM, 1);
+  detailValueAtlas.create(valueWidth, 60, TEXT_INK, TEXT_INK_BACKGROUND, ML_DATUM, 1);
+  detailUnitAtlas.create(unitWidth, 60, TEXT_INK, TEXT_INK_BACKGROUND, ML_DATUM, 1);
+
+  for (const char* c = VALUE_CHARS; *c; c++) {
+    char single[2] = {*c, 0};
+    boxAtlas.add(single, 10);
+    detailValueAtlas.add(single, 28);
   }
 
-  // Read LTR390 UV sensor and calculate UV Index
-  if (ltr_ok) {
-    uvValue = ltr.readUVS();
-    float uv_mW_per_cm2 = (float)uvValue / 1048575.0 * 15.0;
-    uvIndexValue = uv_mW_per_cm2 / 0.25;
-    if (uvIndexValue > 11.0) uvIndexValue = 11.0;
+  int cWidth = boxAtlas.measure("C");
+  for (int i = 0; i < NUM_BOXES; i++) {
+    if (strcmp(boxes[i].title, "Temperatur") == 0) {
+      ///< Small circle for temperature unit "C", drawn left of the letter
+      boxUnitGlyph[i] = boxAtlas.add(boxUnit[i], 10);
+      detailUnitGlyph[i] = detailUnitAtlas.add("C", 32, 10);
+      if (boxUnitGlyph[i] >= 0) {
+        const Glyph& g = boxAtlas.glyph(boxUnitGlyph[i]);
+        boxAtlas.canvas().drawCircle(g.x + g.width - cWidth - 2, 10, 3, TEXT_INK);
+        boxAtlas.canvas().drawCircle(g.x + g.width - cWidth - 2, 10, 2, TEXT_INK);
+        boxAtlas.updateInk(boxUnitGlyph[i]);
+      }
+      if (detailUnitGlyph[i] >= 0) {
+        const Glyph& g = detailUnitAtlas.glyph(detailUnitGlyph[i]);
+        detailUnitAtlas.canvas().drawCircle(g.x + 5, 23, 5, TEXT_INK);
+        detailUnitAtlas.updateInk(detailUnitGlyph[i]);
+      }
+    } else {
+      boxUnitGlyph[i] = boxAtlas.add(boxUnit[i], 10);
+      detailUnitGlyph[i] = detailUnitAtlas.add(boxes[i].unit, 32);
+    }
   }
+}
 
-  ///< Save every HISTORY_UPDATE_INTERVAL points to history buffers
-  if (doHistoryUpdate) {
-    updateHistory(0, tempValue);
-    updateHistory(1, humidValue);
-    updateHistory(2, pressureValue);
-    updateHistory(3, ambientValue);
-    updateHistory(4, whiteValue);
-    updateHistory(5, gasValue);
-    updateHistory(6, uvValue);
-    updateHistory(7, uvIndexValue);
+/**
+ * @brief Forget the values shown in the boxes
+ *
+ * Must be called whenever the boxes were drawn empty, so the next
+ * updateValue() draws every value.
+ */
+void invalidateValues() {
+  for (int i = 0; i < NUM_BOXES; i++) shownValues[i] = seenValues[i] = NAN;
+}
+
+/**
+ * @brief Round a value to the integer steps of its printed precision
+ */
+static long quantize(float value, int decimals) {
+  double scaled = value;
+  for (int d = 0; d < decimals; d++) scaled *= 10.0;
+  return lround(scaled);
+}
+
+/**
+ * @brief Check whether a new value changes the text shown in a box
+ *
+ * The values are compared after rounding to Box::decimals like the
+ * printed text, so noise below the display precision causes no redraw.
+ * The hysteresis band additionally suppresses a value flickering between
+ * two neighbouring digits.
+ */
+bool valueTextChanged(const Box& box, float shown, float value) {
+  if (isnan(shown)) return true;
+  if (quantize(value, box.decimals) == quantize(shown, box.decimals)) return false;
+  return fabs(value - shown) > box.hysteresis;
+}
+
+/**
+ * @brief Print the redraw counters of all boxes
+ */
+void boxReport(Print& out) {
+  out.println("Box               Redraws  Skipped");
+  for (int i = 0; i < NUM_BOXES; i++) {
+    out.printf("%-17s %7lu  %7lu\n", boxes[i].title, (unsigned long)boxes[i].redraws, (unsigned long)boxes[i].skipped);
   }
 }
 
 /**
- * @brief Update a single box value on the main screen if it has changed
+ * @brief Show the main page
+ *
+ * The main page is restored from the screen cache if it was saved when
+ * the detail page was opened. The cached values are still in shownValues,
+ * so updateValue() only redraws the boxes whose value changed meanwhile.
+ * Otherwise the page is drawn with empty boxes and all value widgets are
+ * damaged, so the next composeFrame() fills them in.
+ */
+void drawMainPage() {
+  if (displayRestore(SCREEN_MAIN)) return;
+
+  canvas().fillScreen(COLOR_BACKGROUND);
+  displayMarkDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+  drawLogo();
+  for (int i = 0; i < NUM_BOXES; i++) drawBox(i);
+  damageAll();
+}
+
+/**
+ * @brief Draw the value of a box (compositor render function)
  * @param i Index of the box in the boxes array
  *
- * Uses a TFT sprite to draw the value to reduce flicker.
+ * Uses the box's persistent pool sprite to draw the value to reduce flicker.
  */
-void updateValue(int i) {
-  static float lastValues[NUM_BOXES] = {0};
+static void renderBoxValue(int i) {
   float newVal = *(boxes[i].value);
+  shownValues[i] = newVal;
+  boxes[i].redraws++;
 
-  ///< Only update if value changed significantly
-  if (abs(newVal - lastValues[i]) < 0.001) return;
-  lastValues[i] = newVal;
+  ///< Prepare value string in a stack buffer (no String heap allocation)
+  char valueText[20];
+  snprintf(valueText, sizeof(valueText), "%.*f", boxes[i].decimals, newVal);
 
-  ///< Prepare value string
-  char buf[20];
-  sprintf(buf, "%.*f", boxes[i].decimals, newVal);
+  ///< Reuse the box's persistent sprite for smooth drawing
+  TFT_eSprite& spr = poolSprite(SPRITE_BOX_VALUE + i);
+  spr.fillSprite(TEXT_INK_BACKGROUND);
 
-  String fullText = String(buf);
-  if (strcmp(boxes[i].title, "Temperatur") == 0) {
-    fullText += "  C";  ///< Extra space for temperature circle
-  } else {
-    fullText += " " + String(boxes[i].unit);
-  }
+  ///< Center text within sprite
+  int textW = boxAtlas.textWidth(valueText) + boxAtlas.advance(boxUnitGlyph[i]);
+  int x = (boxes[i].w - 20) / 2 - textW / 2;
 
-  ///< Create a sprite for smooth drawing
-  TFT_eSprite spr = TFT_eSprite(&tft);
-  spr.createSprite(boxes[i].w - 20, 40);
-  spr.fillSprite(BOX_COLOR);
-  spr.setTextColor(VALUE_COLOR, BOX_COLOR);
-  spr.setTextDatum(TL_DATUM);
+  ///< Compose the value string and unit from pre-rendered glyphs
+  x += boxAtlas.drawText(spr, valueText, x);
+  boxAtlas.drawGlyph(spr, boxUnitGlyph[i], x);
 
-  ///< Center text within sprite
-  int textW = spr.textWidth(fullText, 4);
-  int xCenter = (boxes[i].w - 20) / 2 - textW / 2;
-  int yCenter = 10;
-
-  ///< Draw the value string
-  spr.drawString(fullText, xCenter, yCenter, 4);
-
-  ///< Draw small circle for temperature unit "C"
-  if (strcmp(boxes[i].title, "Temperatur") == 0) {
-    int cWidth = spr.textWidth("C", 4);
-    spr.drawCircle(xCenter + textW - cWidth - 2, yCenter, 3, VALUE_COLOR);
-    spr.drawCircle(xCenter + textW - cWidth - 2, yCenter, 2, VALUE_COLOR);
+  ///< Push sprite to TFT screen in the box colors
+  displayPushIndexed(spr, poolPalette(SPRITE_BOX_VALUE + i), boxes[i].x + 10, boxes[i].y + boxes[i].h / 2 - 20);
+}
+
+/**
+ * @brief Register the value area of every box as compositor widget
+ *
+ * Must be called after layoutBoxes().
+ */
+void initBoxWidgets() {
+  for (int i = 0; i < NUM_BOXES; i++) {
+    DisplayRect area = {(int16_t)(boxes[i].x + 10), (int16_t)(boxes[i].y + boxes[i].h / 2 - 20), (int16_t)(boxes[i].w - 20), 40};
+    boxWidgets[i] = addWidget(area, renderBoxValue, i);
   }
+}
 
-  ///< Push sprite to TFT screen
-  spr.pushSprite(boxes[i].x + 10, boxes[i].y + boxes[i].h / 2 - 20);
-  spr.deleteSprite();
+/**
+ * @brief Mark a box value as damaged if its text has changed
+ * @param i Index of the box in the boxes array
+ *
+ * The value is drawn by the next composeFrame().
+ */
+void updateValue(int i) {
+  float newVal = *(boxes[i].value);
+  if (newVal == seenValues[i]) return;  ///< Same sample as in the last pass
+  seenValues[i] = newVal;
+
+  if (valueTextChanged(boxes[i], shownValues[i], newVal)) {
+    damageWidget(boxWidgets[i]);
+  } else {
+    boxes[i].skipped++;
+  }
 }
 
 /**
@@ -257,153 +641,143 @@ void updateValue(int i) {
  * Draws the title, current value, unit, and a hint text to return.
  */
 void drawDetailPage(int boxIndex) {
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(TFT_BLACK, COLOR_BACKGROUND);
-  tft.setFreeFont(&FreeSansBold18pt7b);
+  TFT_eSPI& target = canvas();
+  target.setTextDatum(MC_DATUM);
+  target.setTextColor(TFT_BLACK, COLOR_BACKGROUND);
+  target.setFreeFont(&FreeSansBold18pt7b);
 
   ///< Title and value
   String title = "Details: " + String(boxes[boxIndex].title);
   String valueStr = String(*boxes[boxIndex].value, boxes[boxIndex].decimals) + " " + boxes[boxIndex].unit;
 
   ///< Draw title and value
-  tft.drawString(title, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 40, 1);
-  tft.setFreeFont(&FreeSansBold12pt7b);
-  tft.drawString(valueStr, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, 1);
+  target.drawString(title, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 40, 1);
+  target.setFreeFont(&FreeSansBold12pt7b);
+  target.drawString(valueStr, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, 1);
 
   ///< Hint text
-  tft.setFreeFont(&FreeSans9pt7b);
-  tft.setTextColor(TFT_DARKGREY, COLOR_BACKGROUND);
-  tft.drawString("Tippen, um zur Hauptseite zu gelangen", SCREEN_WIDTH / 2, SCREEN_HEIGHT - 40, 1);
+  target.setFreeFont(&FreeSans9pt7b);
+  target.setTextColor(TFT_DARKGREY, COLOR_BACKGROUND);
+  target.drawString("Tippen, um zur Hauptseite zu gelangen", SCREEN_WIDTH / 2, SCREEN_HEIGHT - 40, 1);
+  displayMarkDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 }
 
 /**
- * @brief Draw the detail page for a box using a sprite for the value
+ * @brief Push the value and unit of the detail page
  * @param boxIndex Index of the box
- *
- * Updates the detail page only if the value changed.
- * Uses a TFT sprite for smooth animation.
+ * @param value Value to show
  */
-void drawDetailPageWithSprite(int boxIndex) {
-  float currentValue = *boxes[boxIndex].value;
+static void drawDetailValue(int boxIndex, float value) {
+  TFT_eSprite& valueSpr = poolSprite(SPRITE_DETAIL_VALUE);
+  valueSpr.fillSprite(TEXT_INK_BACKGROUND);
 
-  ///< Only update if value changed significantly
-  if (abs(currentValue - lastDetailValue) < 0.001 && !detailGraphNeedsRedraw) return;
+  char valuePart[20];
+  snprintf(valuePart, sizeof(valuePart), "%.*f", boxes[boxIndex].decimals, value);
 
-  lastDetailValue = currentValue;
+  int valueWidth, totalWidth, startX;
 
-  ///< Display value
-  TFT_eSprite valueSpr = TFT_eSprite(&tft);
-  valueSpr.createSprite(SCREEN_WIDTH - 40, 60);
-  valueSpr.fillSprite(COLOR_BACKGROUND);
+  ///< Compose value and unit from pre-rendered glyphs
+  valueWidth = detailValueAtlas.textWidth(valuePart);
+  totalWidth = valueWidth + 10;  // 10 pixels spacing
+  startX = (SCREEN_WIDTH - 40 - totalWidth) / 2;
+  detailValueAtlas.drawText(valueSpr, valuePart, startX);
+  detailUnitAtlas.drawGlyph(valueSpr, detailUnitGlyph[boxIndex], startX + valueWidth + 15);
+  displayPushIndexed(valueSpr, poolPalette(SPRITE_DETAIL_VALUE), 20, 80);
+}
 
-  char buf[20];
-  sprintf(buf, "%.*f", boxes[boxIndex].decimals, currentValue);
-  String valuePart = String(buf);
-  String unitPart = (strcmp(boxes[boxIndex].title, "Temperatur") == 0) ? "C" : String(boxes[boxIndex].unit);
+/**
+ * @brief Draw the span label below the detail graph
+ *
+ * The label only changes with the view, so it is drawn once per view. The
+ * rows below the graph outline belong to the label, drawGraph() does not
+ * push them.
+ */
+static void drawDetailSpan() {
+  if (detailTier == shownSpanTier) return;
+  shownSpanTier = detailTier;
+
+  TFT_eSPI& target = canvas();
+  target.fillRect(0, DETAIL_GRAPH_Y + GRAPH_HEIGHT - 10, SCREEN_WIDTH, 26, COLOR_BACKGROUND);  ///< From below the outline
+  target.setTextDatum(BL_DATUM);
+  target.setTextColor(TFT_BLACK);
+  target.setFreeFont(&FreeSans9pt7b);
+  target.drawString(tierSpan[detailTier], DETAIL_GRAPH_X, DETAIL_GRAPH_Y + GRAPH_HEIGHT + 8, 1);
+
+  target.setTextDatum(BR_DATUM);
+  target.drawString("Jetzt", DETAIL_GRAPH_X + GRAPH_WIDTH, DETAIL_GRAPH_Y + GRAPH_HEIGHT + 8, 1);
+  displayMarkDirty(0, DETAIL_GRAPH_Y + GRAPH_HEIGHT - 10, SCREEN_WIDTH, 26);
+}
 
-  int valueWidth, unitWidth, totalWidth, startX;
+/**
+ * @brief Push the min and max labels of the detail page if their text changed
+ * @param boxIndex Index of the box
+ * @param minValue Bottom of the graph range
+ * @param maxValue Top of the graph range
+ */
+static void drawDetailMinMax(int boxIndex, float minValue, float maxValue) {
+  char minStr[80], maxStr[80], text[sizeof(shownMinMax)];
+  snprintf(minStr, sizeof(minStr), "Minimum (%s): %.*f %s", tierShort[detailTier], boxes[boxIndex].decimals, minValue, boxes[boxIndex].unit);
+  snprintf(maxStr, sizeof(maxStr), "Maximum (%s): %.*f %s", tierShort[detailTier], boxes[boxIndex].decimals, maxValue, boxes[boxIndex].unit);
+  snprintf(text, sizeof(text), "%s|%s", minStr, maxStr);
+  if (strcmp(text, shownMinMax) == 0) return;
+  strcpy(shownMinMax, text);
+
+  TFT_eSprite& minMaxSpr = poolSprite(SPRITE_MIN_MAX);
+  minMaxSpr.fillSprite(TEXT_INK_BACKGROUND);
+  minMaxSpr.setTextDatum(ML_DATUM);
+  minMaxSpr.setTextColor(TEXT_INK, TEXT_INK_BACKGROUND);
+  minMaxSpr.setFreeFont(&FreeSans9pt7b);
 
-  ///< Draw value
-  valueSpr.setTextDatum(MC_DATUM);
-  valueSpr.setTextColor(TFT_BLACK, COLOR_BACKGROUND);
-  valueSpr.setFreeFont(&FreeSansBold24pt7b);
-  valueWidth = valueSpr.textWidth(valuePart);
-  totalWidth = valueWidth + 10;  // 10 pixels spacing
-  startX = (SCREEN_WIDTH - 40 - totalWidth) / 2;
-  valueSpr.drawString(valuePart, startX + valueWidth / 2, 28, 1);
+  minMaxSpr.drawString(minStr, 0, 15, 1);
+  minMaxSpr.setTextDatum(MR_DATUM);
+  minMaxSpr.drawString(maxStr, SCREEN_WIDTH - 40, 15, 1);
 
-  ///< Draw unit
-  valueSpr.setFreeFont(&FreeSansBold12pt7b);
-  unitWidth = valueSpr.textWidth(unitPart);
-  valueSpr.drawString(unitPart, startX + valueWidth + 15 + unitWidth / 2, 32, 1);
+  displayPushIndexed(minMaxSpr, poolPalette(SPRITE_MIN_MAX), 20, 420);
+}
 
-  ///< Draw small circle for temperature unit "C"
-  if (strcmp(boxes[boxIndex].title, "Temperatur") == 0) {
-    valueSpr.drawCircle(startX + valueWidth + 10, 23, 5, TFT_BLACK);
+/**
+ * @brief Draw the detail page for a box using a sprite for the value
+ * @param boxIndex Index of the box
+ *
+ * Updates the detail page only if the value changed or a graph redraw is
+ * due. The value and the labels are only pushed when their text changed,
+ * so a history tick usually sends just the scrolled columns of the graph.
+ * Uses persistent pool sprites for smooth animation.
+ */
+void drawDetailPageWithSprite(int boxIndex) {
+  float currentValue = *boxes[boxIndex].value;
+
+  ///< Only update if value changed significantly
+  if (valueTextChanged(boxes[boxIndex], lastDetailValue, currentValue)) {
+    lastDetailValue = currentValue;
+    drawDetailValue(boxIndex, currentValue);
   }
-  valueSpr.pushSprite(20, 80);
-  valueSpr.deleteSprite();
 
   ///< Draw graph if needed
   if (!detailGraphNeedsRedraw) return;
   detailGraphNeedsRedraw = false;
 
-  ///< Calculate min and max from history
+  ///< Min and max of the raw history are kept up to date by updateHistory()
   float minValue = currentValue;
   float maxValue = currentValue;
-  for (int i = 0; i < HISTORY_LENGTH; i++) {
-    float val = historyBuffers[boxIndex][i];
-    if (val != -999.0) {
-      if (val < minValue) minValue = val;
-      if (val > maxValue) maxValue = val;
-    }
+  float historyMin, historyMax;
+  bool found = detailTier == GRAPH_VIEW_ARCHIVE ? archiveMinMax(archiveStore(), boxIndex, historyMin, historyMax)
+                                               : historyTierMinMax(boxIndex, detailTier, historyMin, historyMax);
+  if (found) {
+    if (historyMin < minValue) minValue = historyMin;
+    if (historyMax > maxValue) maxValue = historyMax;
   }
   if (fabs(maxValue - minValue) < 0.1) {
     maxValue += 0.05;
     minValue -= 0.05;
   }
 
-  ///< Draw graph using sprite
-  const int LABEL_HEIGHT = 16;
-  TFT_eSprite graphSpr = TFT_eSprite(&tft);
-  graphSpr.createSprite(GRAPH_WIDTH, GRAPH_HEIGHT);
-  graphSpr.fillSprite(COLOR_BACKGROUND);
-  graphSpr.setTextColor(TFT_BLACK);
-  graphSpr.setFreeFont(&FreeSans9pt7b);
-
-  ///< Graph outline
-  graphSpr.drawRect(0, 0, GRAPH_WIDTH, GRAPH_HEIGHT - 10, TFT_BLACK);
-
-  ///< Graph line
-  int prevX = -1, prevY = -1;
-  int oldestIndex = (historyIndex[boxIndex] + 1) % HISTORY_LENGTH;
-  for (int i = 0; i < HISTORY_LENGTH; i++) {
-    int dataIndex = (oldestIndex + i) % HISTORY_LENGTH;
-    float val = historyBuffers[boxIndex][dataIndex];
-    if (val == -999.0) {
-      prevX = -1;
-      prevY = -1;
-      continue;
-    }
-    int y = map((long)(val * 100), (long)(minValue * 100), (long)(maxValue * 100), GRAPH_HEIGHT - 11, 1);
-    int x = map(i, 0, HISTORY_LENGTH - 1, 1, GRAPH_WIDTH - 2);
-
-    if (prevX != -1) graphSpr.drawLine(prevX, prevY, x, y, GRAPH_COLOR);
-
-    prevX = x;
-    prevY = y;
-  }
-
-  graphSpr.pushSprite((SCREEN_WIDTH - GRAPH_WIDTH) / 2, 150);
-  graphSpr.deleteSprite();
-
-  ///< Graph labels
-  tft.setTextDatum(BL_DATUM);
-  tft.setTextColor(TFT_BLACK);
-  tft.setFreeFont(&FreeSans9pt7b);
-  tft.drawString("Letzte 24 Stunden", (SCREEN_WIDTH - GRAPH_WIDTH) / 2, 150 + GRAPH_HEIGHT + 8, 1);
-
-  tft.setTextDatum(BR_DATUM);
-  tft.drawString("Jetzt", (SCREEN_WIDTH + GRAPH_WIDTH) / 2, 150 + GRAPH_HEIGHT + 8, 1);
-
-  ///< Min and Max labels
-  TFT_eSprite minMaxSpr = TFT_eSprite(&tft);
-  minMaxSpr.createSprite(SCREEN_WIDTH - 40, 30);
-  minMaxSpr.fillSprite(COLOR_BACKGROUND);
-  minMaxSpr.setTextDatum(ML_DATUM);
-  minMaxSpr.setTextColor(TFT_BLACK, COLOR_BACKGROUND);
-  minMaxSpr.setFreeFont(&FreeSans9pt7b);
-
-  char minStr[80], maxStr[80];
-  sprintf(minStr, "Minimum (24h): %.*f %s", boxes[boxIndex].decimals, minValue, boxes[boxIndex].unit);
-  sprintf(maxStr, "Maximum (24h): %.*f %s", boxes[boxIndex].decimals, maxValue, boxes[boxIndex].unit);
-
-  minMaxSpr.drawString(minStr, 0, 15, 1);
-  minMaxSpr.setTextDatum(MR_DATUM);
-  minMaxSpr.drawString(maxStr, SCREEN_WIDTH - 40, 15, 1);
+  ///< Draw graph using sprite, scrolled incrementally when possible
+  drawGraph(poolSprite(SPRITE_GRAPH), boxIndex, detailTier, minValue, maxValue, DETAIL_GRAPH_X, DETAIL_GRAPH_Y);
 
-  minMaxSpr.pushSprite(20, 420);
-  minMaxSpr.deleteSprite();
+  ///< Graph labels, the span label changes with the tier
+  drawDetailSpan();
+  drawDetailMinMax(boxIndex, minValue, maxValue);
 }
 
 /**
@@ -413,44 +787,35 @@ void drawDetailPageWithSprite(int boxIndex) {
  * Clears the screen and displays title and "tap to return" hint.
  */
 void drawDetailPageTitle(int boxIndex) {
-  tft.fillScreen(COLOR_BACKGROUND);
-
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(TFT_BLACK, COLOR_BACKGROUND);
+  TFT_eSPI& target = canvas();
+  invalidateGraph();  ///< Graph area was cleared, next draw must be complete
+  shownSpanTier = -1;  ///< So were the labels
+  shownMinMax[0] = '\0';
+
+  ///< Background and hint are the same for all boxes and come from the cache
+  if (!displayRestore(SCREEN_DETAIL)) {
+    target.fillScreen(COLOR_BACKGROUND);
+    target.setTextDatum(MC_DATUM);
+    target.setFreeFont(&FreeSans9pt7b);
+    target.setTextColor(TFT_DARKGREY, COLOR_BACKGROUND);
+    target.drawString("Tippen, um zur Hauptseite zu gelangen", SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, 1);
+    displayMarkDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    displaySave(SCREEN_DETAIL);
+  }
 
-  tft.setFreeFont(&FreeSansBold18pt7b);
+  target.setTextDatum(MC_DATUM);
+  target.setTextColor(TFT_BLACK, COLOR_BACKGROUND);
+  target.setFreeFont(&FreeSansBold18pt7b);
   String title = "Details: " + String(boxes[boxIndex].title);
-
-  tft.drawString(title, SCREEN_WIDTH / 2, 40, 1);
-
-  tft.setFreeFont(&FreeSans9pt7b);
-  tft.setTextColor(TFT_DARKGREY, COLOR_BACKGROUND);
-  tft.drawString("Tippen, um zur Hauptseite zu gelangen", SCREEN_WIDTH / 2, SCREEN_HEIGHT - 20, 1);
+  target.drawString(title, SCREEN_WIDTH / 2, 40, 1);
 }
 
 /**
- * @brief Update history buffer for a box
- * @param boxIndex Index of box
- * @param newValue New sensor value to add to history
+ * @brief Check whether a screen position lies on the detail graph
+ * @param tx X position on screen
+ * @param ty Y position on screen
  */
-void updateHistory(int boxIndex, float newValue) {
-  ///< Save new value in history buffer
-  historyBuffers[boxIndex][historyIndex[boxIndex]] = newValue;
-
-  ///< Increment history index with wrap-around
-  historyIndex[boxIndex]++;
-  if (historyIndex[boxIndex] >= HISTORY_LENGTH) {
-    historyIndex[boxIndex] = 0;  // Ring buffer
-  }
-}
-
-/**
- * @brief Initialize all history buffers with the invalid marker value.
- */
-void initHistory() {
-  for (int i = 0; i < NUM_BOXES; i++) {
-    for (int j = 0; j < HISTORY_LENGTH; j++) {
-      historyBuffers[i][j] = -999.0;
-    }
-  }
+bool detailGraphHit(int tx, int ty) {
+  return tx >= DETAIL_GRAPH_X && tx < DETAIL_GRAPH_X + GRAPH_WIDTH &&
+         ty >= DETAIL_GRAPH_Y && ty < DETAIL_GRAPH_Y + GRAPH_HEIGHT;
 }
@@ -4,7 +4,7 @@
  *
  * Contains:
  * - Box structure definition
- * - Sensor configuration
+ * - Sensor configuration and the sensor source of the demo mode
  * - Functions for layout and drawing of boxes
  * - Updating sensor values and the display
  * - Drawing detail pages for individual sensors
@@ -18,7 +18,11 @@
 #include <Adafruit_VCNL4040.h>
 #include <Arduino.h>
 #include <config.h>
+#include <history.h>
 #include <logo.h>
+#include <scheduler.h>
+#include <snapshot.h>
+#include <source.h>
 
 /**
  * @brief Structure representing a single box on the display
@@ -30,15 +34,34 @@ struct Box {
   int x, y;           ///< Position on screen
   int w, h;           ///< Width and height of box
   int decimals;       ///< Number of decimals for display
+  float hysteresis;   ///< Changes up to this amount are not shown even if the rounded text differs
+  uint32_t redraws;   ///< Value redraws since boot
+  uint32_t skipped;   ///< New samples not drawn because the text would not change
 };
 
-extern Box boxes[NUM_BOXES];  ///< Array of boxes on screen
+extern Box boxes[NUM_BOXES];          ///< Array of boxes on screen
+extern SensorSnapshot displayValues;  ///< Sensor values shown by the UI task
 
 /**
  * @brief Configure all sensors with default settings
  */
 void configureSensors(bool bme_ok, bool vcnl_ok, bool ltr_ok);
 
+/**
+ * @brief Read a sensor source instead of the sensors
+ * @param source Source, e.g. SyntheticWeather, or nullptr for the sensors
+ *
+ * Call before startSensorTask(). The readings are converted like those of
+ * the sensors, so boxes, history and graph work unchanged.
+ */
+void setSensorSource(SensorSource* source);
+
+/**
+ * @brief Get the sensor source in use
+ * @return nullptr if the sensors are read
+ */
+SensorSource* sensorSourceInUse();
+
 /**
  * @brief Layout boxes on screen in grid
  */
@@ -56,16 +79,68 @@ void drawLogo();
 void drawBox(int i);
 
 /**
- * @brief Update all sensor values
+ * @brief Render the characters and units of all values into glyph atlases
+ */
+void initValueGlyphs();
+
+/**
+ * @brief Update all sensor values and publish a snapshot (sensor task)
  */
 void updateValues();
 
+/**
+ * @brief Take over the newest sensor snapshot (UI task)
+ * @return true if a new snapshot was received
+ */
+bool syncValues();
+
+/**
+ * @brief Start the sensor acquisition task on SENSOR_TASK_CORE
+ */
+void startSensorTask();
+
+/**
+ * @brief Check whether the first readings are still outstanding
+ * @return true until every sensor job has run once and the first BME688 conversion has been collected
+ */
+bool sensorsPending();
+
+/**
+ * @brief Check whether a new value changes the text shown in a box
+ * @param box Box with decimals and hysteresis
+ * @param shown Value currently drawn, NAN if none
+ * @param value New value
+ * @return true if the box has to be redrawn
+ */
+bool valueTextChanged(const Box& box, float shown, float value);
+
+/**
+ * @brief Print the redraw counters of all boxes
+ * @param out Output, e.g. Serial
+ */
+void boxReport(Print& out);
+
 /**
  * @brief Update a single box value if changed
  * @param i Index of box
  */
 void updateValue(int i);
 
+/**
+ * @brief Register the value area of every box as compositor widget
+ */
+void initBoxWidgets();
+
+/**
+ * @brief Forget the values shown in the boxes so all are drawn again
+ */
+void invalidateValues();
+
+/**
+ * @brief Show the main page, from the screen cache if possible
+ */
+void drawMainPage();
+
 /**
  * @brief Draw the detail page for a box
  * @param boxIndex Index of box
@@ -85,12 +160,10 @@ void drawDetailPageWithSprite(int boxIndex);
 void drawDetailPageTitle(int boxIndex);
 
 /**
- * @brief Update history buffer for a box
- * @param boxIndex Index of box
- * @param newValue New sensor value to add to history
+ * @brief Check whether a screen position lies on the detail graph
+ * @param tx X position on screen
+ * @param ty Y position on screen
  */
-void updateHistory(int boxIndex, float newValue);
-
-void initHistory();
+bool detailGraphHit(int tx, int ty);
 
 #endif  // METHODS_H
\ No newline at end of file
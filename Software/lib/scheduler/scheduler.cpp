@@ -0,0 +1,95 @@
+/**
+ * @file scheduler.cpp
+ * @brief Implementation of the deadline scheduler
+ *
+ * Deadlines advance by whole periods from the phase set at start, so a late
+ * run does not shift later runs. A job that falls more than one period
+ * behind skips the missed periods instead of running back to back.
+ */
+
+#include <scheduler.h>
+
+/**
+ * @brief Reset statistics and set the first deadlines
+ */
+void schedStart(SchedTask* tasks, int count, uint32_t now) {
+  for (int i = 0; i < count; i++) {
+    tasks[i].next = now + tasks[i].phase;
+    tasks[i].runs = 0;
+    tasks[i].first = 0;
+    tasks[i].last = 0;
+    tasks[i].totalLate = 0;
+    tasks[i].maxLate = 0;
+    tasks[i].skipped = 0;
+  }
+}
+
+/**
+ * @brief Find the due job whose deadline passed longest ago
+ */
+int schedMostOverdue(const SchedTask* tasks, int count, uint32_t now) {
+  int best = -1;
+  int32_t bestLate = -1;
+
+  for (int i = 0; i < count; i++) {
+    int32_t late = (int32_t)(now - tasks[i].next);
+    if (late > bestLate) {
+      best = i;
+      bestLate = late;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Record a run of a job and advance its deadline
+ */
+void schedRan(SchedTask& task, uint32_t now) {
+  uint32_t late = now - task.next;
+
+  if (task.runs == 0) task.first = now;
+  task.last = now;
+  task.runs++;
+  task.totalLate += late;
+  if (late > task.maxLate) task.maxLate = late;
+
+  task.next += task.period;
+  if ((int32_t)(now - task.next) >= 0) {
+    uint32_t missed = (now - task.next) / task.period + 1;
+    task.skipped += missed;
+    task.next += missed * task.period;
+  }
+}
+
+/**
+ * @brief Run check for a single job
+ */
+bool schedDue(SchedTask& task, uint32_t now) {
+  if ((int32_t)(now - task.next) < 0) return false;
+  schedRan(task, now);
+  return true;
+}
+
+/**
+ * @brief Actual mean period of a job
+ */
+float schedActualPeriod(const SchedTask& task) {
+  if (task.runs < 2) return 0.0;
+  return (float)(task.last - task.first) / (task.runs - 1);
+}
+
+/**
+ * @brief Print requested vs. actual rate and lateness of all jobs
+ */
+void schedReport(Print& out, const SchedTask* tasks, int count) {
+  out.println("Job             Channels                    Req Hz  Act Hz  Late avg/max ms  Skipped");
+  for (int i = 0; i < count; i++) {
+    const SchedTask& t = tasks[i];
+    float actualPeriod = schedActualPeriod(t);
+    float actualRate = actualPeriod > 0.0 ? 1000.0 / actualPeriod : 0.0;
+    float meanLate = t.runs > 0 ? (float)t.totalLate / t.runs : 0.0;
+
+    out.printf("%-15s %-27s %6.2f  %6.2f  %6.1f/%-8lu  %lu\n", t.name, t.channels, 1000.0 / t.period, actualRate,
+               meanLate, (unsigned long)t.maxLate, (unsigned long)t.skipped);
+  }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file scheduler.h
+ * @brief Small deadline scheduler for periodic sensor and housekeeping jobs
+ *
+ * Contains:
+ * - SchedTask, a periodic job with its own period, phase and statistics
+ * - Functions to pick due jobs and record their runs
+ * - A report of requested vs. actual rate and lateness per job
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Periodic job with timing statistics
+ *
+ * Only name, channels, period and phase are set by the user, the remaining
+ * fields are maintained by the scheduler.
+ */
+struct SchedTask {
+  const char* name;      ///< Name used in the report
+  const char* channels;  ///< Channels updated by this job
+  uint32_t period;       ///< Requested period in milliseconds
+  uint32_t phase;        ///< Offset of the first run from schedStart() in milliseconds
+  uint32_t next;         ///< Deadline of the next run
+  uint32_t runs;         ///< Number of runs since start
+  uint32_t first;        ///< Time of the first run
+  uint32_t last;         ///< Time of the last run
+  uint32_t totalLate;    ///< Sum of lateness over all runs in milliseconds
+  uint32_t maxLate;      ///< Largest lateness of a single run in milliseconds
+  uint32_t skipped;      ///< Number of periods skipped because the job fell behind
+};
+
+/**
+ * @brief Reset statistics and set the first deadlines
+ * @param tasks Array of jobs
+ * @param count Number of jobs
+ * @param now Current time in milliseconds
+ */
+void schedStart(SchedTask* tasks, int count, uint32_t now);
+
+/**
+ * @brief Find the due job whose deadline passed longest ago
+ * @param tasks Array of jobs
+ * @param count Number of jobs
+ * @param now Current time in milliseconds
+ * @return Index of the job or -1 if none is due
+ */
+int schedMostOverdue(const SchedTask* tasks, int count, uint32_t now);
+
+/**
+ * @brief Record a run of a job and advance its deadline
+ * @param task Job that ran
+ * @param now Current time in milliseconds
+ */
+void schedRan(SchedTask& task, uint32_t now);
+
+/**
+ * @brief Run check for a single job
+ * @param task Job to check
+ * @param now Current time in milliseconds
+ * @return true if the job is due, in which case the run is already recorded
+ */
+bool schedDue(SchedTask& task, uint32_t now);
+
+/**
+ * @brief Actual mean period of a job
+ * @param task Job
+ * @return Mean time between runs in milliseconds, 0 before the second run
+ */
+float schedActualPeriod(const SchedTask& task);
+
+/**
+ * @brief Print requested vs. actual rate and lateness of all jobs
+ * @param out Output stream
+ * @param tasks Array of jobs
+ * @param count Number of jobs
+ */
+void schedReport(Print& out, const SchedTask* tasks, int count);
+
+#endif  // SCHEDULER_H
@@ -0,0 +1,85 @@
+/**
+ * @file snapshot.h
+ * @brief Lock-free exchange of sensor samples between the sensor and UI tasks
+ *
+ * Contains:
+ * - SensorSnapshot, the versioned set of all sensor channels
+ * - TripleBuffer, a single-producer/single-consumer exchange without locks
+ *
+ * The sensor task publishes a complete snapshot after every acquisition pass
+ * and the UI task picks up the newest one at the start of each frame. Neither
+ * side ever waits for the other, so a slow I2C transaction cannot stall a
+ * frame and a long redraw cannot delay a sensor reading.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief One consistent set of sensor readings
+ */
+struct SensorSnapshot {
+  uint32_t version;      ///< Incremented by the producer on every publish
+  uint32_t historyTick;  ///< Incremented when a history sample is due
+  uint32_t ambientTick;  ///< Incremented on every ambient light reading
+  float temp;            ///< Temperature in degrees Celsius
+  float humid;           ///< Relative humidity in percent
+  float pressure;        ///< Air pressure in hPa
+  float gas;             ///< Gas resistance in kOhm
+  float ambient;         ///< Ambient light in lux
+  float white;           ///< White light counts
+  float uv;              ///< Raw UV counts
+  float uvIndex;         ///< Calculated UV index
+  float proximity;       ///< Proximity counts
+};
+
+/**
+ * @brief Triple buffer for one producer and one consumer
+ *
+ * The producer owns the back slot, the consumer owns the front slot and the
+ * third slot is handed between them with a single atomic exchange. A fresh
+ * flag in the shared index tells the consumer whether anything new was
+ * published since its last update().
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  /**
+   * @brief Publish a new value (producer side)
+   * @param value Value to copy into the back slot
+   */
+  void publish(const T& value) {
+    slots[back] = value;
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  /**
+   * @brief Take over the newest published value (consumer side)
+   * @return true if a new value was published since the last call
+   */
+  bool update() {
+    if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * @brief Access the value taken over by the last update() (consumer side)
+   * @return Reference to the front slot
+   */
+  const T& read() const { return slots[front]; }
+
+ private:
+  static constexpr uint32_t INDEX_MASK = 0x3;  ///< Slot index bits
+  static constexpr uint32_t FRESH = 0x4;       ///< Set while the middle slot is unread
+
+  T slots[3] = {};                  ///< Back, middle and front slots
+  uint32_t back = 0;                ///< Slot written by the producer
+  uint32_t front = 2;               ///< Slot read by the consumer
+  std::atomic<uint32_t> middle{1};  ///< Slot in transit plus FRESH flag
+};
+
+#endif  // SNAPSHOT_H
@@ -0,0 +1,74 @@
+/**
+ * @file source.h
+ * @brief Interface of a replacement for the sensors
+ *
+ * Contains:
+ * - ClimateReading and LightReading, raw readings as the drivers return them
+ * - SensorSource, the interface the sensor task reads instead of the devices
+ *
+ * A source is asked for the same channels as the sensor jobs read, at the
+ * time the job runs, and answers in the units of the drivers: Pascal and
+ * Ohm for the BME688, counts for the VCNL4040 and the LTR390. The sensor
+ * task converts them exactly like real readings, so everything downstream
+ * of updateValues() cannot tell the difference.
+ */
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdint.h>
+
+/**
+ * @brief One BME688 conversion
+ */
+struct ClimateReading {
+  float temperature;       ///< Temperature in Celsius
+  float humidity;          ///< Relative humidity in percent
+  uint32_t pressure;       ///< Pressure in Pascal
+  uint32_t gasResistance;  ///< Gas resistance in Ohm
+};
+
+/**
+ * @brief One VCNL4040 light reading
+ */
+struct LightReading {
+  uint16_t ambient;  ///< Ambient light counts
+  uint16_t white;    ///< White light counts
+};
+
+/**
+ * @brief Stand-in for the sensors, e.g. synthetic weather or a recording
+ *
+ * Every method returns false if the source has no value for the channel,
+ * the shown value then stays as it is.
+ */
+class SensorSource {
+ public:
+  virtual ~SensorSource() {}
+
+  /**
+   * @brief Temperature, humidity, pressure and gas
+   * @param now millis() of the sensor job
+   */
+  virtual bool readClimate(uint32_t now, ClimateReading& reading) = 0;
+
+  /**
+   * @brief Proximity counts
+   * @param now millis() of the sensor job
+   */
+  virtual bool readProximity(uint32_t now, uint16_t& proximity) = 0;
+
+  /**
+   * @brief Ambient and white light
+   * @param now millis() of the sensor job
+   */
+  virtual bool readLight(uint32_t now, LightReading& reading) = 0;
+
+  /**
+   * @brief Raw UV counts of the LTR390 (20 bit, gain 18)
+   * @param now millis() of the sensor job
+   */
+  virtual bool readUV(uint32_t now, uint32_t& uvs) = 0;
+};
+
+#endif  // SOURCE_H
@@ -0,0 +1,98 @@
+/**
+ * @file sprites.h
+ * @brief Pool of persistent sprites reused across frames
+ *
+ * Contains:
+ * - The sprite slots for the box values and the detail page
+ * - The pixel values of the palette sprites of the detail page
+ * - Functions to allocate the pool once at boot and to acquire a sprite
+ * - Allocation counters to verify that the steady state does not allocate
+ *
+ * Every sprite only ever shows a handful of colors, so all of them hold
+ * palette indices: 4 bits per pixel for the graph, 1 bit for the box
+ * values, the detail value and the min/max labels. Drawing into them uses
+ * the index enums below as colors, pushing goes through
+ * displayPushIndexed() with poolPalette().
+ */
+
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <TFT_eSPI.h>
+#include <config.h>
+
+/**
+ * @brief Sprite slots in the pool
+ */
+enum SpriteSlot {
+  SPRITE_BOX_VALUE = 0,             ///< First box value sprite, one per box
+  SPRITE_DETAIL_VALUE = NUM_BOXES,  ///< Current value on the detail page
+  SPRITE_GRAPH,                     ///< Graph on the detail page
+  SPRITE_MIN_MAX,                   ///< Minimum and maximum labels on the detail page
+  NUM_SPRITES                       ///< Number of sprite slots
+};
+
+/**
+ * @brief Pixel values of the 4-bit graph sprite
+ */
+enum GraphInk {
+  GRAPH_INK_BACKGROUND,  ///< COLOR_BACKGROUND
+  GRAPH_INK_OUTLINE,     ///< Black outline
+  GRAPH_INK_LINE,        ///< GRAPH_COLOR
+  GRAPH_INK_BAND,        ///< GRAPH_BAND_COLOR
+  NUM_GRAPH_INKS         ///< Number of used palette entries
+};
+
+/**
+ * @brief Pixel values of the 1-bit text sprites
+ */
+enum TextInk {
+  TEXT_INK_BACKGROUND,  ///< COLOR_BACKGROUND, BOX_COLOR in the box value sprites
+  TEXT_INK              ///< Black text, VALUE_COLOR in the box value sprites
+};
+
+/**
+ * @brief Allocation counters of the sprite pool
+ */
+struct SpritePoolStats {
+  uint32_t allocations;   ///< Successful createSprite() calls since boot
+  uint32_t failures;      ///< Failed createSprite() calls since boot
+  uint32_t acquisitions;  ///< Number of poolSprite() calls since boot
+  uint32_t bytes;         ///< Bytes held by the pool
+  uint32_t detailBytes;   ///< Part of bytes held by the detail page sprites
+};
+
+/**
+ * @brief Allocate all sprites of the pool
+ *
+ * Must be called after layoutBoxes(), the box value sprites take their
+ * size from the box layout.
+ */
+void initSpritePool();
+
+/**
+ * @brief Get a sprite from the pool
+ * @param slot Sprite slot (SPRITE_BOX_VALUE + box index for box values)
+ * @return Reference to the persistent sprite
+ *
+ * A sprite whose allocation failed is retried here at most once every
+ * SPRITE_RETRY_INTERVAL, otherwise no memory is allocated. Check
+ * created() before drawing into the returned sprite.
+ */
+TFT_eSprite& poolSprite(int slot);
+
+/**
+ * @brief Palette of a slot
+ * @param slot Sprite slot
+ * @return RGB565 color of each pixel value, 16 entries for 4-bit and 2
+ *         for 1-bit slots
+ */
+const uint16_t* poolPalette(int slot);
+
+/**
+ * @brief Get the allocation counters of the pool
+ * @return Reference to the counters
+ */
+const SpritePoolStats& spritePoolStats();
+
+#endif  // SPRITES_H
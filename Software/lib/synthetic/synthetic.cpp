@@ -0,0 +1,187 @@
+/**
+ * @file synthetic.cpp
+ * @brief Implementation of the synthetic weather
+ */
+
+#include <math.h>
+#include <synthetic.h>
+
+/// Independent random sequences, one per drifting quantity and sensor channel
+enum SyntheticChannel {
+  DRIFT_FRONTS,       ///< Passing highs and lows, a few days apart
+  DRIFT_SHOWERS,      ///< Short pressure disturbances
+  DRIFT_CLOUDS,       ///< Clouds independent of the pressure
+  DRIFT_TEMPERATURE,  ///< Warm and cold spells
+  DRIFT_DEW_POINT,    ///< Moisture of the air mass
+  DRIFT_GAS,          ///< Air quality seen by the gas sensor
+  NOISE_TEMPERATURE,
+  NOISE_HUMIDITY,
+  NOISE_PRESSURE,
+  NOISE_GAS,
+  NOISE_PROXIMITY,
+  NOISE_AMBIENT,
+  NOISE_WHITE,
+  NOISE_UV
+};
+
+#define DEG_TO_RADIANS (M_PI / 180.0)
+
+/**
+ * @brief Hash three words into one (murmur3 finalizer)
+ */
+static uint32_t mix(uint32_t a, uint32_t b, uint32_t c) {
+  uint32_t h = a * 0x9E3779B1U ^ b * 0x85EBCA77U ^ c * 0xC2B2AE3DU;
+  h ^= h >> 16;
+  h *= 0x7FEB352DU;
+  h ^= h >> 15;
+  h *= 0x846CA68BU;
+  h ^= h >> 16;
+  return h;
+}
+
+/**
+ * @brief Map a hash to [-1, 1)
+ */
+static float unit(uint32_t h) {
+  return (h >> 8) * (2.0F / 16777216.0F) - 1.0F;
+}
+
+/**
+ * @brief Smooth random curve in [-1, 1] with one random knot per period
+ */
+static float drift(uint32_t seed, int channel, double seconds, double period) {
+  double x = seconds / period;
+  double knot = floor(x);
+  float f = (float)(x - knot);
+  float a = unit(mix(seed, channel, (uint32_t)(int64_t)knot));
+  float b = unit(mix(seed, channel, (uint32_t)(int64_t)knot + 1));
+  f = f * f * (3 - 2 * f);
+  return a + (b - a) * f;
+}
+
+/**
+ * @brief Limit a value to a range
+ */
+static float clampf(float value, float low, float high) {
+  return value < low ? low : value > high ? high : value;
+}
+
+/**
+ * @brief Relative humidity from temperature and dew point (Magnus formula)
+ */
+static float relativeHumidity(float temperature, float dewPoint) {
+  const float a = 17.62F, b = 243.12F;
+  return 100.0F * expf(a * dewPoint / (b + dewPoint) - a * temperature / (b + temperature));
+}
+
+/**
+ * @brief Weather at a simulated time
+ */
+void SyntheticWeather::weather(double seconds, WeatherState& state) const {
+  const uint32_t seed = config.seed;
+  double day = config.startDay + seconds / 86400.0;
+  float hour = (float)fmod(seconds / 3600.0, 24.0);
+  if (hour < 0) hour += 24;
+
+  ///< Course of the sun
+  double declination = 23.44 * DEG_TO_RADIANS * sin(2 * M_PI * (284 + day) / 365);
+  double latitude = config.latitude * DEG_TO_RADIANS;
+  double hourAngle = (hour - 12) * 15 * DEG_TO_RADIANS;
+  state.sunElevation = (float)(sin(latitude) * sin(declination) + cos(latitude) * cos(declination) * cos(hourAngle));
+
+  ///< Fronts a few days apart, short disturbances and the twice-daily atmospheric tide
+  state.pressure = 1013.0F + 12.0F * drift(seed, DRIFT_FRONTS, seconds, 2.5 * 86400) + 1.5F * drift(seed, DRIFT_SHOWERS, seconds, 8 * 3600) +
+                   0.5F * cosf(2 * (float)M_PI * (hour - 10) / 12);
+
+  ///< Low pressure brings clouds
+  state.cloudCover = clampf(0.45F - (state.pressure - 1013.0F) / 16.0F + 0.35F * drift(seed, DRIFT_CLOUDS, seconds, 3 * 3600), 0, 1);
+
+  ///< Seasonal mean, coldest around 20 January, and a daily course damped by clouds
+  float mean = 9.0F - 9.0F * (float)cos(2 * M_PI * (day - 20) / 365);
+  float amplitude = 5.0F * (1 - 0.6F * state.cloudCover);
+  state.temperature = mean + amplitude * sinf(2 * (float)M_PI * (hour - 9) / 24) + 3.0F * drift(seed, DRIFT_TEMPERATURE, seconds, 1.5 * 86400);
+
+  ///< Humidity follows from a slowly drifting dew point a little under the night's low, moister under clouds
+  float dewPoint = mean - amplitude - 2.0F + 2.5F * drift(seed, DRIFT_DEW_POINT, seconds, 86400) + 2.0F * state.cloudCover;
+  if (dewPoint > state.temperature) dewPoint = state.temperature;
+  state.humidity = clampf(relativeHumidity(state.temperature, dewPoint), 5, 100);
+
+  ///< The metal-oxide layer conducts better in humid and polluted air
+  state.gasResistance = 150000.0F * expf(-(state.humidity - 50) / 40) * (1 + 0.2F * drift(seed, DRIFT_GAS, seconds, 6 * 3600));
+
+  ///< Light and UV through the clouds
+  float sun = state.sunElevation > 0 ? state.sunElevation : 0;
+  state.lux = config.peakLux * powf(sun, 1.3F) * (1 - 0.75F * state.cloudCover);
+  state.uvIndex = 12.5F * powf(sun, 2.42F) * (1 - 0.6F * state.cloudCover);
+}
+
+/**
+ * @brief Simulated seconds at a millis() value
+ */
+double SyntheticWeather::simulatedSeconds(uint32_t now) const {
+  return config.startHour * 3600.0 + now / 1000.0 * config.timeScale;
+}
+
+/**
+ * @brief Normally distributed sensor noise (sum of four uniform samples)
+ */
+float SyntheticWeather::noise(int channel, uint32_t now, float sigma) const {
+  if (config.noise == 0) return 0;
+  float sum = 0;
+  for (uint32_t i = 0; i < 4; i++) sum += unit(mix(config.seed ^ 0xA5A5A5A5U, channel * 4 + i, now));
+  return sum * 0.8660254F * sigma * config.noise;  ///< Four samples in [-1, 1) have a variance of 4/3
+}
+
+bool SyntheticWeather::readClimate(uint32_t now, ClimateReading& reading) {
+  WeatherState state;
+  weather(simulatedSeconds(now), state);
+  reading.temperature = state.temperature + noise(NOISE_TEMPERATURE, now, 0.05F);
+  reading.humidity = clampf(state.humidity + noise(NOISE_HUMIDITY, now, 0.3F), 0, 100);
+  reading.pressure = (uint32_t)lroundf(state.pressure * 100 + noise(NOISE_PRESSURE, now, 3));
+  reading.gasResistance = (uint32_t)lroundf(state.gasResistance * (1 + noise(NOISE_GAS, now, 0.01F)));
+  return true;
+}
+
+bool SyntheticWeather::readProximity(uint32_t now, uint16_t& proximity) {
+  proximity = (uint16_t)lroundf(clampf(3 + noise(NOISE_PROXIMITY, now, 1.5F), 0, 65535));  ///< Nobody in front of the display
+  return true;
+}
+
+bool SyntheticWeather::readLight(uint32_t now, LightReading& reading) {
+  WeatherState state;
+  weather(simulatedSeconds(now), state);
+  float counts = state.lux * 10;  ///< 0.1 lux per count at 80 ms integration
+  reading.ambient = (uint16_t)lroundf(clampf(counts * (1 + noise(NOISE_AMBIENT, now, 0.02F)) + noise(NOISE_AMBIENT, now + 1, 2), 0, 65535));
+  reading.white = (uint16_t)lroundf(clampf(1.25F * counts * (1 + noise(NOISE_WHITE, now, 0.02F)) + noise(NOISE_WHITE, now + 1, 2), 0, 65535));
+  return true;
+}
+
+bool SyntheticWeather::readUV(uint32_t now, uint32_t& uvs) {
+  WeatherState state;
+  weather(simulatedSeconds(now), state);
+  float counts = state.uvIndex * 0.25F / 15.0F * 1048575.0F;  ///< Inverse of the UV index conversion of the sensor task
+  uvs = (uint32_t)lroundf(clampf(counts * (1 + noise(NOISE_UV, now, 0.03F)) + noise(NOISE_UV, now + 1, 20), 0, 1048575));
+  return true;
+}
+
+/**
+ * @brief Read all sensors and convert the readings to box values
+ */
+void SyntheticWeather::boxValues(uint32_t now, float* values) {
+  ClimateReading climate;
+  LightReading light;
+  uint32_t uvs;
+  readClimate(now, climate);
+  readLight(now, light);
+  readUV(now, uvs);
+  values[0] = climate.temperature;
+  values[1] = climate.humidity;
+  values[2] = climate.pressure / 100.0F;
+  values[3] = light.ambient;
+  values[4] = light.white;
+  values[5] = climate.gasResistance / 1000.0F;
+  values[6] = uvs;
+  float uv_mW_per_cm2 = (float)uvs / 1048575.0 * 15.0;
+  values[7] = uv_mW_per_cm2 / 0.25;
+  if (values[7] > 11.0) values[7] = 11.0;
+}
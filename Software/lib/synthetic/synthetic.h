@@ -0,0 +1,98 @@
+/**
+ * @file synthetic.h
+ * @brief Synthetic weather as sensor source for the demo mode
+ *
+ * Contains:
+ * - SyntheticConfig, seed, noise, place and clock of the simulation
+ * - WeatherState, the noise-free weather at one moment
+ * - SyntheticWeather, the SensorSource that turns it into raw readings
+ *
+ * The weather is a pure function of the simulated time and the seed: the
+ * sun follows latitude and day of the year, temperature has a seasonal and
+ * a daily course damped by clouds, pressure fronts pass every few days and
+ * pull the clouds in, the dew point drifts slowly and gives the humidity.
+ * Light and UV follow the sun's elevation through the clouds. The sensor
+ * noise on top is hashed from the reading time, so the same clock always
+ * gives the same readings, however often and in which order they are read.
+ */
+
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <config.h>
+#include <source.h>
+
+/**
+ * @brief Settings of the simulation, defaults from config.h
+ */
+struct SyntheticConfig {
+  uint32_t seed = DEMO_SEED;             ///< Seed of the weather and the sensor noise
+  float noise = DEMO_NOISE;              ///< Scale of the sensor noise, 0 for smooth curves
+  float latitude = DEMO_LATITUDE;        ///< Latitude in degrees
+  float startDay = DEMO_START_DAY;       ///< Day of the year at millis() 0
+  float startHour = DEMO_START_HOUR;     ///< Local solar time at millis() 0
+  uint32_t timeScale = DEMO_TIME_SCALE;  ///< Simulated seconds per second of millis()
+  float peakLux = DEMO_PEAK_LUX;         ///< Ambient light under a clear midday sky
+};
+
+/**
+ * @brief Weather at one moment, without sensor noise
+ */
+struct WeatherState {
+  float temperature;    ///< Air temperature in Celsius
+  float humidity;       ///< Relative humidity in percent
+  float pressure;       ///< Air pressure in hPa
+  float gasResistance;  ///< BME688 gas resistance in Ohm
+  float sunElevation;   ///< Sine of the sun's elevation, negative at night
+  float cloudCover;     ///< 0 for a clear sky, 1 for overcast
+  float lux;            ///< Ambient light in lux
+  float uvIndex;        ///< UV index
+};
+
+/**
+ * @brief Sensor source of the demo mode
+ */
+class SyntheticWeather : public SensorSource {
+ public:
+  explicit SyntheticWeather(const SyntheticConfig& config = SyntheticConfig()) : config(config) {}
+
+  /**
+   * @brief Weather at a simulated time
+   * @param seconds Simulated seconds since the start of day startDay, midnight
+   * @param state Receives the weather
+   */
+  void weather(double seconds, WeatherState& state) const;
+
+  /**
+   * @brief Simulated seconds at a millis() value
+   */
+  double simulatedSeconds(uint32_t now) const;
+
+  /**
+   * @brief Read all sensors and convert the readings to box values
+   * @param now millis() of the readings
+   * @param values Receives one value per box, in box order, converted as the sensor task does
+   */
+  void boxValues(uint32_t now, float* values);
+
+  /**
+   * @brief Settings of the simulation
+   */
+  const SyntheticConfig& settings() const { return config; }
+
+  bool readClimate(uint32_t now, ClimateReading& reading) override;
+  bool readProximity(uint32_t now, uint16_t& proximity) override;
+  bool readLight(uint32_t now, LightReading& reading) override;
+  bool readUV(uint32_t now, uint32_t& uvs) override;
+
+ private:
+  /**
+   * @brief Normally distributed sensor noise of one channel at one reading
+   * @return Sample with standard deviation sigma times the noise setting
+   */
+  float noise(int channel, uint32_t now, float sigma) const;
+
+  SyntheticConfig config;  ///< Settings
+};
+
+#endif  // SYNTHETIC_H
@@ -0,0 +1,182 @@
+/**
+ * @file touch.cpp
+ * @brief Implementation of the interrupt-driven touch input
+ *
+ * This file contains the implementation of:
+ * - The pen state machine (debounce, press, move, release)
+ * - The bounded event queue
+ * - The pen interrupt and the controller sampling glue
+ */
+
+#include <Arduino.h>
+#include <TFT_Touch.h>
+#include <config.h>
+#include <touch.h>
+
+extern TFT_Touch touch;  ///< Touch controller instance
+
+static TouchState touchState = {};         ///< State of the touch panel
+static volatile bool penIrqFired = false;  ///< Set by the pen interrupt
+
+/**
+ * @brief Append an event to the queue
+ * @param s Touch state
+ * @param type Kind of event
+ * @param now Current time in milliseconds
+ *
+ * Consecutive moves are merged into one. When the queue is full the oldest
+ * event is dropped.
+ */
+static void pushEvent(TouchState& s, TouchEventType type, uint32_t now) {
+  if (type == TOUCH_MOVE && s.count > 0) {
+    TouchEvent& last = s.queue[(s.head + s.count - 1) % TOUCH_QUEUE_LENGTH];
+    if (last.type == TOUCH_MOVE) {
+      last.x = s.x;
+      last.y = s.y;
+      last.time = now;
+      return;
+    }
+  }
+
+  if (s.count == TOUCH_QUEUE_LENGTH) {
+    s.head = (s.head + 1) % TOUCH_QUEUE_LENGTH;
+    s.count--;
+  }
+  s.queue[(s.head + s.count) % TOUCH_QUEUE_LENGTH] = {type, s.x, s.y, now};
+  s.count++;
+}
+
+/**
+ * @brief Switch the state machine to a new phase
+ * @param s Touch state
+ * @param phase New phase
+ * @param now Current time in milliseconds
+ */
+static void enterPhase(TouchState& s, TouchPhase phase, uint32_t now) {
+  s.phase = phase;
+  s.since = now;
+}
+
+/**
+ * @brief Check whether the state machine needs a position sample
+ */
+bool touchWantsSample(const TouchState& s, uint32_t now) {
+  switch (s.phase) {
+    case TOUCH_DEBOUNCE:
+      return now - s.since >= TOUCH_DEBOUNCE_TIME && now - s.lastSample >= TOUCH_SAMPLE_INTERVAL;
+    case TOUCH_DOWN:
+      return now - s.lastSample >= TOUCH_SAMPLE_INTERVAL;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Advance the pen state machine by one step
+ */
+void touchStep(TouchState& s, uint32_t now, bool penDown, bool sampled, int16_t x, int16_t y) {
+  switch (s.phase) {
+    case TOUCH_IDLE:
+      if (penDown) enterPhase(s, TOUCH_DEBOUNCE, now);
+      break;
+
+    case TOUCH_DEBOUNCE:
+      if (!penDown) {
+        enterPhase(s, TOUCH_IDLE, now);
+      } else if (touchWantsSample(s, now)) {
+        s.lastSample = now;  ///< Too little pressure is retried after TOUCH_SAMPLE_INTERVAL
+        if (sampled) {
+          s.x = x;
+          s.y = y;
+          enterPhase(s, TOUCH_DOWN, now);
+          pushEvent(s, TOUCH_PRESS, now);
+        }
+      }
+      break;
+
+    case TOUCH_DOWN:
+      if (!penDown) {
+        enterPhase(s, TOUCH_RELEASING, now);
+      } else if (sampled) {
+        s.lastSample = now;
+        if (abs(x - s.x) + abs(y - s.y) >= TOUCH_MOVE_THRESHOLD) {
+          s.x = x;
+          s.y = y;
+          pushEvent(s, TOUCH_MOVE, now);
+        }
+      }
+      break;
+
+    case TOUCH_RELEASING:
+      if (penDown) {
+        s.phase = TOUCH_DOWN;  ///< Contact bounced, keep the press
+      } else if (now - s.since >= TOUCH_DEBOUNCE_TIME) {
+        enterPhase(s, TOUCH_IDLE, now);
+        pushEvent(s, TOUCH_RELEASE, now);
+      }
+      break;
+  }
+}
+
+/**
+ * @brief Remove the oldest event from the queue
+ */
+bool touchPopEvent(TouchState& s, TouchEvent& event) {
+  if (s.count == 0) return false;
+  event = s.queue[s.head];
+  s.head = (s.head + 1) % TOUCH_QUEUE_LENGTH;
+  s.count--;
+  return true;
+}
+
+/**
+ * @brief Pen interrupt handler, only records that the pen went down
+ */
+static void IRAM_ATTR onPenIrq() {
+  penIrqFired = true;
+}
+
+/**
+ * @brief Attach the pen interrupt on TOUCH_IRQ
+ *
+ * The XPT2046 pulls its PENIRQ output low while the panel is pressed.
+ */
+void touchBegin() {
+  pinMode(TOUCH_IRQ, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(TOUCH_IRQ), onPenIrq, FALLING);
+}
+
+/**
+ * @brief Sample the touch controller if the pen is down and queue events
+ *
+ * While the state machine is idle only the interrupt flag is checked. The
+ * PENIRQ line also toggles during conversions, so its level is re-read
+ * between transactions instead of trusting the flag alone.
+ */
+void pollTouch() {
+  uint32_t now = millis();
+
+  if (touchState.phase == TOUCH_IDLE && !penIrqFired) return;  ///< Nobody touching
+  penIrqFired = false;
+
+  bool penDown = digitalRead(TOUCH_IRQ) == LOW;
+  bool sampled = false;
+  int16_t x = 0, y = 0;
+
+  if (penDown && touchWantsSample(touchState, now)) {
+    sampled = touch.Pressed();
+    if (sampled) {
+      x = touch.X();
+      y = touch.Y();
+    }
+  }
+
+  touchStep(touchState, now, penDown, sampled, x, y);
+}
+
+/**
+ * @brief Take the next pending touch event
+ */
+bool nextTouchEvent(TouchEvent& event) {
+  return touchPopEvent(touchState, event);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file touch.h
+ * @brief Interrupt-driven touch input with debouncing and an event queue
+ *
+ * Contains:
+ * - Touch event and state machine definitions
+ * - The hardware independent pen state machine
+ * - Glue to the TFT_Touch controller and the TOUCH_IRQ pen interrupt
+ *
+ * The touch controller is only sampled over SPI while the pen-IRQ line
+ * reports a pen on the panel. Debounced press, move and release events are
+ * queued for the UI to consume.
+ */
+
+#ifndef TOUCH_H
+#define TOUCH_H
+
+#include <stdint.h>
+
+/// Number of events the queue can hold before the oldest is dropped
+#define TOUCH_QUEUE_LENGTH 8
+
+/**
+ * @brief Kind of touch event
+ */
+enum TouchEventType : uint8_t {
+  TOUCH_PRESS,    ///< Pen went down (after debouncing)
+  TOUCH_MOVE,     ///< Pen moved while down
+  TOUCH_RELEASE,  ///< Pen was lifted (after debouncing)
+};
+
+/**
+ * @brief Single touch event in screen coordinates
+ */
+struct TouchEvent {
+  TouchEventType type;  ///< Kind of event
+  int16_t x, y;         ///< Position on screen
+  uint32_t time;        ///< Time of the event in milliseconds
+};
+
+/**
+ * @brief Phase of the pen state machine
+ */
+enum TouchPhase : uint8_t {
+  TOUCH_IDLE,       ///< No pen on the panel, nothing is sampled
+  TOUCH_DEBOUNCE,   ///< Pen-IRQ asserted, waiting for it to settle
+  TOUCH_DOWN,       ///< Pen is down, position is sampled periodically
+  TOUCH_RELEASING,  ///< Pen-IRQ released, waiting for it to settle
+};
+
+/**
+ * @brief State of the pen state machine and its event queue
+ */
+struct TouchState {
+  TouchPhase phase;                      ///< Current phase
+  uint32_t since;                        ///< Time the current phase was entered
+  uint32_t lastSample;                   ///< Time of the last position sample
+  int16_t x, y;                          ///< Last reported position
+  TouchEvent queue[TOUCH_QUEUE_LENGTH];  ///< Ring buffer of pending events
+  uint8_t head;                          ///< Index of the oldest pending event
+  uint8_t count;                         ///< Number of pending events
+};
+
+/**
+ * @brief Check whether the state machine needs a position sample
+ * @param s Touch state
+ * @param now Current time in milliseconds
+ * @return true if the controller should be read on this pass
+ */
+bool touchWantsSample(const TouchState& s, uint32_t now);
+
+/**
+ * @brief Advance the pen state machine by one step
+ * @param s Touch state
+ * @param now Current time in milliseconds
+ * @param penDown Level of the pen-IRQ line (true = pen on the panel)
+ * @param sampled true if x/y hold a valid position sample
+ * @param x Sampled X position
+ * @param y Sampled Y position
+ */
+void touchStep(TouchState& s, uint32_t now, bool penDown, bool sampled, int16_t x, int16_t y);
+
+/**
+ * @brief Remove the oldest event from the queue
+ * @param s Touch state
+ * @param event Receives the event
+ * @return true if an event was available
+ */
+bool touchPopEvent(TouchState& s, TouchEvent& event);
+
+/**
+ * @brief Attach the pen interrupt on TOUCH_IRQ
+ */
+void touchBegin();
+
+/**
+ * @brief Sample the touch controller if the pen is down and queue events
+ *
+ * Returns without any SPI traffic while nobody touches the screen.
+ */
+void pollTouch();
+
+/**
+ * @brief Take the next pending touch event
+ * @param event Receives the event
+ * @return true if an event was available
+ */
+bool nextTouchEvent(TouchEvent& event);
+
+#endif  // TOUCH_H
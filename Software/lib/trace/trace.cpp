@@ -0,0 +1,481 @@
+/**
+ * @file trace.cpp
+ * @brief Implementation of the sensor trace
+ *
+ * The encoding is described in trace.h. Writer and reader keep the same
+ * TraceState, reset at the start of every block, and update it record by
+ * record in the same way.
+ */
+
+#include <string.h>
+#include <trace.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <LittleFS.h>
+#endif
+
+/// Magic at the start of every block
+static const uint8_t TRACE_MAGIC[4] = {'W', 's', 'T', 'r'};
+
+/// Payload bytes of a full block
+#define TRACE_PAYLOAD_BYTES (TRACE_BLOCK_BYTES - TRACE_HEADER_BYTES - TRACE_TRAILER_BYTES)
+
+/// Longest record: tag, time varint and four 32-bit varints
+#define TRACE_MAX_RECORD_BYTES (1 + 4 * 5 + 5)
+
+/// Time difference that does not fit into the tag and follows as varint
+#define TRACE_TIME_ESCAPE 31
+
+/// Tag bit of a record whose values equal the previous reading
+#define TRACE_UNCHANGED 0x20
+
+static_assert(TRACE_PAYLOAD_BYTES >= TRACE_MAX_RECORD_BYTES && TRACE_PAYLOAD_BYTES <= 0xFFFF, "TRACE_BLOCK_BYTES out of range");
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as used by zlib)
+ */
+static uint32_t crc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ */
+static void put32(uint8_t* p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+/**
+ * @brief Load a 32-bit little-endian value
+ */
+static uint32_t get32(const uint8_t* p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * @brief Map a signed difference to an unsigned number, small magnitudes first
+ */
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/**
+ * @brief Inverse of zigzag()
+ */
+static int32_t unzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * @brief Append a varint (7 bits per byte, low bits first)
+ * @return Bytes written
+ */
+static size_t putVarint(uint8_t* p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)v | 0x80;
+    v >>= 7;
+  }
+  p[n++] = v;
+  return n;
+}
+
+/**
+ * @brief Read a varint
+ * @return false if it runs past end
+ */
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (p >= end) return false;
+    uint8_t b = *p++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Bits of a float
+ */
+static uint32_t floatBits(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+/**
+ * @brief Float of its bits
+ */
+static float bitsFloat(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+/**
+ * @brief Reset the references at the start of a block
+ */
+static void resetState(TraceState& state, uint32_t time) {
+  memset(&state, 0, sizeof(state));
+  for (int c = 0; c < NUM_TRACE_CHANNELS; c++) state.time[c] = time;
+}
+
+/**
+ * @brief The values of a record as 32-bit words, in encoding order
+ * @param channel Channel the record is read as
+ * @return Number of words of the channel
+ */
+static int recordWords(int channel, const TraceRecord& record, uint32_t* words) {
+  switch (channel) {
+    case TRACE_CLIMATE:
+      words[0] = floatBits(record.climate.temperature);
+      words[1] = floatBits(record.climate.humidity);
+      words[2] = record.climate.pressure;
+      words[3] = record.climate.gasResistance;
+      return 4;
+    case TRACE_PROXIMITY:
+      words[0] = record.proximity;
+      return 1;
+    case TRACE_LIGHT:
+      words[0] = record.light.ambient;
+      words[1] = record.light.white;
+      return 2;
+    default:
+      words[0] = record.uvs;
+      return 1;
+  }
+}
+
+/**
+ * @brief Set the values of a record from its words
+ */
+static void setRecordWords(TraceRecord& record, const uint32_t* words) {
+  switch (record.channel) {
+    case TRACE_CLIMATE:
+      record.climate.temperature = bitsFloat(words[0]);
+      record.climate.humidity = bitsFloat(words[1]);
+      record.climate.pressure = words[2];
+      record.climate.gasResistance = words[3];
+      break;
+    case TRACE_PROXIMITY:
+      record.proximity = words[0];
+      break;
+    case TRACE_LIGHT:
+      record.light.ambient = words[0];
+      record.light.white = words[1];
+      break;
+    default:
+      record.uvs = words[0];
+      break;
+  }
+}
+
+/**
+ * @brief Floats are XORed with the previous value, integers subtracted
+ */
+static bool isFloatWord(int channel, int word) {
+  return channel == TRACE_CLIMATE && word < 2;
+}
+
+void TraceWriter::begin(TraceSink& traceSink) {
+  sink = &traceSink;
+  length = 0;
+  records = 0;
+}
+
+void TraceWriter::startBlock(uint32_t time) {
+  resetState(state, time);
+  put32(block + 6, time);
+  length = 0;
+  records = 0;
+}
+
+void TraceWriter::append(const TraceRecord& record) {
+  if (sink == nullptr || record.channel >= NUM_TRACE_CHANNELS) return;
+  if (records > 0 && length + TRACE_MAX_RECORD_BYTES > TRACE_PAYLOAD_BYTES) flush();
+  if (records == 0) startBlock(record.time);
+
+  const int c = record.channel;
+  uint8_t* p = block + TRACE_HEADER_BYTES + length;
+  size_t n = 1;
+
+  ///< Time as difference to the previous step of the channel
+  uint32_t step = record.time - state.time[c];
+  uint32_t time = zigzag((int32_t)(step - state.step[c]));
+  state.time[c] = record.time;
+  state.step[c] = step;
+  uint8_t tag = c << 6;
+  if (time < TRACE_TIME_ESCAPE) {
+    tag |= time;
+  } else {
+    tag |= TRACE_TIME_ESCAPE;
+    n += putVarint(p + n, time);
+  }
+
+  ///< Values as differences to the previous reading
+  uint32_t words[4], lastWords[4];
+  int count = recordWords(c, record, words);
+  recordWords(c, state.last[c], lastWords);
+  if (memcmp(words, lastWords, count * sizeof(uint32_t)) == 0) {
+    tag |= TRACE_UNCHANGED;
+  } else {
+    for (int w = 0; w < count; w++) {
+      n += putVarint(p + n, isFloatWord(c, w) ? words[w] ^ lastWords[w] : zigzag((int32_t)(words[w] - lastWords[w])));
+    }
+  }
+  p[0] = tag;
+  state.last[c] = record;
+
+  length += n;
+  records++;
+  counters.records++;
+}
+
+void TraceWriter::flush() {
+  if (sink == nullptr || records == 0) return;
+  memcpy(block, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  block[4] = length;
+  block[5] = length >> 8;
+  size_t total = TRACE_HEADER_BYTES + length;
+  put32(block + total, crc32(block, total));
+  total += TRACE_TRAILER_BYTES;
+
+  if (sink->write(block, total)) {
+    counters.blocks++;
+    counters.bytes += total;
+  } else {
+    counters.failed++;
+  }
+  length = 0;
+  records = 0;
+}
+
+bool TraceReader::nextBlock() {
+  while (pos + TRACE_HEADER_BYTES + TRACE_TRAILER_BYTES <= len) {
+    const uint8_t* p = data + pos;
+    if (memcmp(p, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+      pos++;  ///< Text or noise between the blocks
+      continue;
+    }
+
+    size_t length = p[4] | p[5] << 8;
+    size_t total = TRACE_HEADER_BYTES + length + TRACE_TRAILER_BYTES;
+    if (length > TRACE_PAYLOAD_BYTES || pos + total > len || get32(p + total - TRACE_TRAILER_BYTES) != crc32(p, total - TRACE_TRAILER_BYTES)) {
+      counters.failed++;
+      pos++;
+      continue;
+    }
+
+    payload = p + TRACE_HEADER_BYTES;
+    payloadLength = length;
+    payloadPos = 0;
+    resetState(state, get32(p + 6));
+    pos += total;
+    counters.blocks++;
+    counters.bytes += total;
+    return true;
+  }
+  return false;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+  for (;;) {
+    if (payload == nullptr || payloadPos >= payloadLength) {
+      if (!nextBlock()) return false;
+      continue;
+    }
+
+    const uint8_t* p = payload + payloadPos;
+    const uint8_t* end = payload + payloadLength;
+    uint8_t tag = *p++;
+    const int c = tag >> 6;
+    uint32_t time = tag & TRACE_TIME_ESCAPE;
+    bool ok = time != TRACE_TIME_ESCAPE || getVarint(p, end, time);
+
+    memset(&record, 0, sizeof(record));
+    record.channel = c;
+    uint32_t words[4], lastWords[4];
+    int count = recordWords(c, state.last[c], lastWords);
+    for (int w = 0; w < count && ok; w++) {
+      if (tag & TRACE_UNCHANGED) {
+        words[w] = lastWords[w];
+        continue;
+      }
+      uint32_t v;
+      ok = getVarint(p, end, v);
+      words[w] = isFloatWord(c, w) ? v ^ lastWords[w] : lastWords[w] + (uint32_t)unzigzag(v);
+    }
+    if (!ok) {
+      payloadPos = payloadLength;  ///< A valid CRC over a bad record: format mismatch, skip the block
+      counters.failed++;
+      continue;
+    }
+
+    uint32_t step = state.step[c] + (uint32_t)unzigzag(time);
+    record.time = state.time[c] + step;
+    setRecordWords(record, words);
+    state.time[c] = record.time;
+    state.step[c] = step;
+    state.last[c] = record;
+    payloadPos = p - payload;
+    counters.records++;
+    return true;
+  }
+}
+
+TraceSource::TraceSource(const uint8_t* data, size_t len) : reader(data, len) {
+  memset(current, 0, sizeof(current));
+  memset(&pending, 0, sizeof(pending));
+  hasPending = reader.next(pending);
+  origin = hasPending ? pending.time : 0;
+
+  ///< One pass over the whole trace for its length
+  TraceReader scan(data, len);
+  TraceRecord record;
+  lastTime = origin;
+  while (scan.next(record)) lastTime = record.time;
+}
+
+void TraceSource::advance(uint32_t now) {
+  while (hasPending && pending.time - origin <= now) {
+    current[pending.channel] = pending;
+    valid[pending.channel] = true;
+    hasPending = reader.next(pending);
+  }
+}
+
+bool TraceSource::readClimate(uint32_t now, ClimateReading& reading) {
+  advance(now);
+  if (!valid[TRACE_CLIMATE]) return false;
+  reading = current[TRACE_CLIMATE].climate;
+  return true;
+}
+
+bool TraceSource::readProximity(uint32_t now, uint16_t& proximity) {
+  advance(now);
+  if (!valid[TRACE_PROXIMITY]) return false;
+  proximity = current[TRACE_PROXIMITY].proximity;
+  return true;
+}
+
+bool TraceSource::readLight(uint32_t now, LightReading& reading) {
+  advance(now);
+  if (!valid[TRACE_LIGHT]) return false;
+  reading = current[TRACE_LIGHT].light;
+  return true;
+}
+
+bool TraceSource::readUV(uint32_t now, uint32_t& uvs) {
+  advance(now);
+  if (!valid[TRACE_UV]) return false;
+  uvs = current[TRACE_UV].uvs;
+  return true;
+}
+
+#ifdef ARDUINO
+/**
+ * @brief Blocks as binary data on USB CDC, between the text output
+ */
+class SerialSink : public TraceSink {
+ public:
+  bool write(const uint8_t* data, size_t len) override { return Serial.write(data, len) == len; }
+};
+
+/**
+ * @brief Blocks appended to TRACE_FILE until TRACE_FILE_LIMIT
+ */
+class FileSink : public TraceSink {
+ public:
+  bool write(const uint8_t* data, size_t len) override {
+    if (!file || written + len > TRACE_FILE_LIMIT) return false;
+    size_t n = file.write(data, len);
+    file.flush();  ///< A block survives a reset once written
+    written += n;
+    return n == len;
+  }
+
+  File file;             ///< Open trace file
+  uint32_t written = 0;  ///< Bytes in file
+};
+
+static SerialSink serialSink;   ///< USB CDC
+static FileSink fileSink;       ///< LittleFS
+static TraceWriter writer;      ///< Recorder of the station
+static bool recording = false;  ///< traceBegin() attached a sink
+
+/**
+ * @brief Start recording as set by SENSOR_TRACE
+ */
+void traceBegin() {
+#if SENSOR_TRACE == 1
+  writer.begin(serialSink);
+  recording = true;
+#elif SENSOR_TRACE == 2
+  LittleFS.remove(TRACE_FILE_OLD);
+  LittleFS.rename(TRACE_FILE, TRACE_FILE_OLD);
+  fileSink.file = LittleFS.open(TRACE_FILE, FILE_WRITE);
+  if (!fileSink.file) return;
+  writer.begin(fileSink);
+  recording = true;
+#endif
+}
+
+/**
+ * @brief Add a record to the trace of the station
+ */
+static void record(TraceRecord& r) {
+  if (recording) writer.append(r);
+}
+
+void traceClimate(uint32_t now, const ClimateReading& reading) {
+  TraceRecord r = {};
+  r.time = now;
+  r.channel = TRACE_CLIMATE;
+  r.climate = reading;
+  record(r);
+}
+
+void traceProximity(uint32_t now, uint16_t proximity) {
+  TraceRecord r = {};
+  r.time = now;
+  r.channel = TRACE_PROXIMITY;
+  r.proximity = proximity;
+  record(r);
+}
+
+void traceLight(uint32_t now, const LightReading& reading) {
+  TraceRecord r = {};
+  r.time = now;
+  r.channel = TRACE_LIGHT;
+  r.light = reading;
+  record(r);
+}
+
+void traceUV(uint32_t now, uint32_t uvs) {
+  TraceRecord r = {};
+  r.time = now;
+  r.channel = TRACE_UV;
+  r.uvs = uvs;
+  record(r);
+}
+
+/**
+ * @brief Print the counters of the recording
+ */
+void traceReport(Print& out) {
+  if (!recording) return;
+  const TraceStats& s = writer.stats();
+  out.printf("Trace: %lu records in %lu blocks, %lu bytes, %lu blocks failed\n", (unsigned long)s.records, (unsigned long)s.blocks,
+             (unsigned long)s.bytes, (unsigned long)s.failed);
+}
+#endif
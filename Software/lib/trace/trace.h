@@ -0,0 +1,260 @@
+/**
+ * @file trace.h
+ * @brief Recording of the raw sensor readings and their replay
+ *
+ * Contains:
+ * - TraceRecord, one raw reading of a sensor job with its time
+ * - TraceSink, the interface of where finished blocks go
+ * - TraceWriter, encoding of records into CRC-checked blocks
+ * - TraceReader, decoding of the blocks from any byte stream
+ * - TraceSource, the SensorSource that plays a trace back
+ * - Functions to record the station's readings to USB CDC or flash
+ *
+ * A trace is a sequence of blocks of at most TRACE_BLOCK_BYTES:
+ *   magic "WsTr" (4), payload length (2), time of the block in ms (4),
+ *   payload, CRC-32 of everything before (4)
+ * Blocks are self-contained, so a reader can start at any block, skip
+ * text written to the same USB CDC stream between two blocks and lose no
+ * more than one block to corruption.
+ *
+ * Each record in the payload starts with one byte: the channel in bits
+ * 7-6, bit 5 set if all values equal the previous reading of the channel,
+ * and in bits 4-0 the zigzag difference of its time step to the previous
+ * step of the channel (31: the difference follows as varint). The values
+ * follow as varints: integers as zigzag differences to the previous
+ * reading, floats as the XOR of their bits with the previous reading. So
+ * an unchanged proximity reading on schedule costs one byte, a BME688
+ * conversion about a dozen. Floats are stored bit-exact, which makes a
+ * replay give bit-identical values.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <config.h>
+#include <source.h>
+#include <stddef.h>
+#include <stdint.h>
+
+class Print;
+
+/// Bytes before the payload of a block: magic, length, time
+#define TRACE_HEADER_BYTES 10
+
+/// Bytes after the payload of a block: CRC-32
+#define TRACE_TRAILER_BYTES 4
+
+/**
+ * @brief Channels of the trace, one per sensor job
+ */
+enum TraceChannel {
+  TRACE_CLIMATE,    ///< BME688 temperature, humidity, pressure and gas
+  TRACE_PROXIMITY,  ///< VCNL4040 proximity
+  TRACE_LIGHT,      ///< VCNL4040 ambient and white light
+  TRACE_UV,         ///< LTR390 raw UV
+  NUM_TRACE_CHANNELS
+};
+
+/**
+ * @brief One raw reading, only the fields of its channel are used
+ */
+struct TraceRecord {
+  uint32_t time;           ///< millis() of the reading
+  uint8_t channel;         ///< TraceChannel
+  ClimateReading climate;  ///< TRACE_CLIMATE
+  uint16_t proximity;      ///< TRACE_PROXIMITY
+  LightReading light;      ///< TRACE_LIGHT
+  uint32_t uvs;            ///< TRACE_UV
+};
+
+/**
+ * @brief Destination of finished blocks, e.g. USB CDC or a file
+ */
+class TraceSink {
+ public:
+  virtual ~TraceSink() {}
+
+  /**
+   * @brief Write a complete block
+   * @return false if the block was not written
+   */
+  virtual bool write(const uint8_t* data, size_t len) = 0;
+};
+
+/**
+ * @brief Counters of a writer or reader
+ */
+struct TraceStats {
+  uint32_t records;  ///< Records written or read
+  uint32_t blocks;   ///< Blocks written or read
+  uint32_t bytes;    ///< Bytes of all those blocks
+  uint32_t failed;   ///< Blocks the sink rejected, or corrupt blocks skipped by the reader
+};
+
+/**
+ * @brief Previous reading of every channel, the reference of the next one
+ */
+struct TraceState {
+  uint32_t time[NUM_TRACE_CHANNELS];     ///< Time of the previous reading
+  uint32_t step[NUM_TRACE_CHANNELS];     ///< Time since the reading before
+  TraceRecord last[NUM_TRACE_CHANNELS];  ///< Values of the previous reading
+};
+
+/**
+ * @brief Encodes records into blocks and hands them to a sink
+ */
+class TraceWriter {
+ public:
+  /**
+   * @brief Attach the sink
+   */
+  void begin(TraceSink& sink);
+
+  /**
+   * @brief Add a record, a full block is written first
+   */
+  void append(const TraceRecord& record);
+
+  /**
+   * @brief Write the pending records as a block now
+   */
+  void flush();
+
+  /**
+   * @brief Get the counters
+   */
+  const TraceStats& stats() const { return counters; }
+
+ private:
+  /**
+   * @brief Start an empty block at a time
+   */
+  void startBlock(uint32_t time);
+
+  TraceSink* sink = nullptr;  ///< Destination, nullptr before begin()
+  TraceState state = {};      ///< References of the block being filled
+  uint16_t length = 0;        ///< Payload bytes in block
+  uint32_t records = 0;       ///< Records in block
+  TraceStats counters = {};   ///< Counters
+
+  /// Block being filled
+  uint8_t block[TRACE_BLOCK_BYTES];
+};
+
+/**
+ * @brief Decodes the records of a trace held in memory
+ *
+ * Anything between the blocks is skipped, as are blocks with a wrong CRC.
+ */
+class TraceReader {
+ public:
+  TraceReader(const uint8_t* data, size_t len) : data(data), len(len) {}
+
+  /**
+   * @brief Decode the next record
+   * @return false at the end of the trace
+   */
+  bool next(TraceRecord& record);
+
+  /**
+   * @brief Get the counters
+   */
+  const TraceStats& stats() const { return counters; }
+
+ private:
+  /**
+   * @brief Find the next block with a valid CRC
+   * @return false if there is none
+   */
+  bool nextBlock();
+
+  const uint8_t* data;               ///< Whole trace
+  size_t len;                        ///< Bytes in data
+  size_t pos = 0;                    ///< Start of the next block search
+  const uint8_t* payload = nullptr;  ///< Payload of the current block
+  size_t payloadLength = 0;          ///< Bytes in payload
+  size_t payloadPos = 0;             ///< Next record in payload
+  TraceState state = {};             ///< References of the current block
+  TraceStats counters = {};          ///< Counters
+};
+
+/**
+ * @brief Plays a trace back through the sensor jobs
+ *
+ * Every channel answers with its newest recorded reading at or before the
+ * time asked for, measured from the first record of the trace. A channel
+ * has no value before its first reading. The answers depend on nothing but
+ * the trace and the times of the jobs, so the same clock gives the same
+ * replay, however fast it runs.
+ */
+class TraceSource : public SensorSource {
+ public:
+  TraceSource(const uint8_t* data, size_t len);
+
+  /**
+   * @brief Time of the last record, relative to the first
+   */
+  uint32_t duration() const { return lastTime - origin; }
+
+  /**
+   * @brief Counters of the reader
+   */
+  const TraceStats& stats() const { return reader.stats(); }
+
+  bool readClimate(uint32_t now, ClimateReading& reading) override;
+  bool readProximity(uint32_t now, uint16_t& proximity) override;
+  bool readLight(uint32_t now, LightReading& reading) override;
+  bool readUV(uint32_t now, uint32_t& uvs) override;
+
+ private:
+  /**
+   * @brief Take over every record up to a time
+   * @param now Time relative to the first record
+   */
+  void advance(uint32_t now);
+
+  TraceReader reader;                       ///< Records in time order
+  TraceRecord pending;                      ///< Next record, not yet due
+  bool hasPending = false;                  ///< pending is valid
+  uint32_t origin = 0;                      ///< Time of the first record
+  uint32_t lastTime = 0;                    ///< Time of the last record
+  TraceRecord current[NUM_TRACE_CHANNELS];  ///< Newest due reading per channel
+  bool valid[NUM_TRACE_CHANNELS] = {};      ///< current holds a reading
+};
+
+/**
+ * @brief Start recording as set by SENSOR_TRACE
+ *
+ * USB CDC needs no setup. For flash, LittleFS has to be mounted already
+ * (historyLogBegin()); the trace of the previous boot is kept as
+ * TRACE_FILE_OLD.
+ */
+void traceBegin();
+
+/**
+ * @brief Record a BME688 conversion (sensor task)
+ */
+void traceClimate(uint32_t now, const ClimateReading& reading);
+
+/**
+ * @brief Record a proximity reading (sensor task)
+ */
+void traceProximity(uint32_t now, uint16_t proximity);
+
+/**
+ * @brief Record a light reading (sensor task)
+ */
+void traceLight(uint32_t now, const LightReading& reading);
+
+/**
+ * @brief Record a raw UV reading (sensor task)
+ */
+void traceUV(uint32_t now, uint32_t uvs);
+
+/**
+ * @brief Print the counters of the recording
+ * @param out Output, e.g. Serial
+ */
+void traceReport(Print& out);
+
+#endif  // TRACE_H
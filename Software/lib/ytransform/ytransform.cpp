@@ -0,0 +1,98 @@
+/**
+ * @file ytransform.cpp
+ * @brief Implementation of the fixed-point graph transform
+ *
+ * Setup rounds the range ends to the grid and reduces the fraction
+ * (code units - low) * rows / (high - low) by the common factors of its
+ * terms. The divisor is then replaced by a multiplication with
+ * ceil(2^shift / divisor), which gives the floor of the fraction exactly as
+ * long as rows * divisor^2 <= 2^shift. shift is the largest one that keeps
+ * the products in codeToRow() below 2^62. Ranges whose ends are codes
+ * reduce to a divisor of at most 65535 and are always exact. Ends off the
+ * code grid, e.g. a live value, stay exact up to a range of about 90,000
+ * units; beyond that a row can be one off right below a boundary.
+ */
+
+#include <math.h>
+#include <ytransform.h>
+
+/**
+ * @brief Greatest common divisor of two non-negative numbers
+ */
+static int64_t gcd(int64_t a, int64_t b) {
+  while (b != 0) {
+    int64_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+/**
+ * @brief Set up the transform of a redraw
+ */
+YTransform makeYTransform(const HistoryScale& scale, float minValue, float maxValue, int16_t top, int16_t bottom) {
+  YTransform t;
+  t.rows = bottom - top;
+  t.bottom = bottom;
+  t.minValue = minValue;
+
+  double range = maxValue > minValue ? (double)maxValue - minValue : 1.0;
+  t.rowsPerUnit = t.rows / range;
+
+  ///< Codes and range ends in whole grid units
+  int64_t units = scale.step < 0.01F ? llround(1.0 / scale.step) : 100;
+  int64_t perCode = llround((double)scale.step * units);
+  int64_t zero = llround((double)scale.offset * units);
+  int64_t low = llround((double)minValue * units);
+  int64_t high = llround((double)maxValue * units);
+  if (high <= low) high = low + 1;
+
+  t.base = (int32_t)floor((double)(low - zero) / perCode);
+  if (t.base > 65535) t.base = 65535;
+  int32_t limit = (int32_t)ceil((double)(high - zero) / perCode);
+  if (limit > 65535) limit = 65535;
+  t.span = limit > t.base ? limit - t.base : 0;
+
+  ///< row = (d * perCode + first) * rows / divisor, reduced
+  int64_t first = zero + (int64_t)t.base * perCode - low;
+  int64_t divisor = high - low;
+  int64_t common = gcd(gcd(perCode, first < 0 ? -first : first), divisor);
+  perCode /= common;
+  first /= common;
+  divisor /= common;
+
+  double largest = ((double)(t.span + 1) * perCode + (first < 0 ? -first : first)) * (t.rows + 1);  ///< Bounds slope too
+  int fit = ilogb(ldexp(1.0, 62) / largest * divisor);  ///< Estimate, the loop corrects it by a step at most
+  t.shift = fit < 0 ? 0 : (fit > YTRANSFORM_MAX_SHIFT ? YTRANSFORM_MAX_SHIFT : fit);
+  while (t.shift > 0 && largest * ceil(ldexp(1.0, t.shift) / divisor) >= ldexp(1.0, 62)) t.shift--;
+  int64_t inverse = (int64_t)((((uint64_t)1 << t.shift) + divisor - 1) / divisor);
+  t.slope = perCode * t.rows * inverse;
+  t.offset = first * t.rows * inverse;
+  return t;
+}
+
+/**
+ * @brief Convert a run of codes to rows
+ */
+void codesToRows(const YTransform& t, const uint16_t* codes, int count, int16_t* rows) {
+  const int32_t base = t.base, span = t.span, shift = t.shift, limit = t.rows, bottom = t.bottom;
+  const int64_t slope = t.slope, offset = t.offset;
+  for (int i = 0; i < count; i++) {
+    int32_t d = (int32_t)codes[i] - base;
+    d = d < 0 ? 0 : (d > span ? span : d);
+    int32_t r = (d * slope + offset) >> shift;
+    r = r < 0 ? 0 : (r > limit ? limit : r);
+    rows[i] = bottom - r;
+  }
+}
+
+/**
+ * @brief Row of a value that is not a code
+ */
+int16_t valueToRow(const YTransform& t, float value) {
+  float r = (value - t.minValue) * t.rowsPerUnit;
+  if (!(r > 0)) return t.bottom;  ///< Also NAN
+  if (r >= t.rows) return t.bottom - t.rows;
+  return t.bottom - (int16_t)r;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file ytransform.h
+ * @brief Fixed-point mapping of history codes and values to graph rows
+ *
+ * Contains:
+ * - YTransform, the scale and offset of one redraw
+ * - Functions to set it up and to convert single values or whole runs of
+ *   history codes
+ *
+ * The transform is computed once per redraw. A code then costs one
+ * 32x64-bit multiply-add, a shift and two clamps, with no float and no
+ * division, and the run conversion is a plain loop over contiguous codes the
+ * compiler can unroll or vectorise.
+ *
+ * The mapping works on a grid of hundredths, or of the step where the codes
+ * are finer, the resolution of the previous map() on hundredths. The range
+ * ends are rounded to the grid and rows are the floor of the mapping of the
+ * codes onto it, computed in integers. So the float rounding of the range
+ * ends, e.g. 21.37 stored as 21.3699999, does not move a code that lies on
+ * a row boundary into the row below. Every scale of the history has its
+ * step and offset on this grid.
+ *
+ * No Arduino dependencies, also builds on the host.
+ */
+
+#ifndef YTRANSFORM_H
+#define YTRANSFORM_H
+
+#include <history.h>
+#include <stdint.h>
+
+/// Upper bound of the fraction bits of slope and offset
+#define YTRANSFORM_MAX_SHIFT 62
+
+/**
+ * @brief Mapping from codes of one box to rows of one plot
+ *
+ * row = bottom - (((code - base) * slope + offset) >> shift), with code - base
+ * clamped to [0, span] and the row clamped to [top, bottom]; larger values
+ * are higher up.
+ */
+struct YTransform {
+  int32_t base;       ///< Code at or below the bottom of the range
+  int32_t span;       ///< Codes from base to the first code at or above the top
+  int64_t slope;      ///< Rows per code, shift fraction bits
+  int64_t offset;     ///< Rows from the bottom of the range to base (<= 0), shift fraction bits
+  int16_t shift;      ///< Fraction bits of slope and offset
+  int16_t rows;       ///< bottom - top
+  int16_t bottom;     ///< Row of the bottom of the range
+  float minValue;     ///< Bottom of the range
+  float rowsPerUnit;  ///< Rows per value unit, for values off the code grid
+};
+
+/**
+ * @brief Set up the transform of a redraw
+ * @param scale Scale of the codes
+ * @param minValue Value mapped to bottom
+ * @param maxValue Value mapped to top, larger than minValue
+ * @param top Topmost row (< bottom)
+ * @param bottom Lowest row
+ */
+YTransform makeYTransform(const HistoryScale& scale, float minValue, float maxValue, int16_t top, int16_t bottom);
+
+/**
+ * @brief Row of one code
+ */
+inline int16_t codeToRow(const YTransform& t, uint16_t code) {
+  int32_t d = (int32_t)code - t.base;
+  d = d < 0 ? 0 : (d > t.span ? t.span : d);
+  int32_t r = (d * t.slope + t.offset) >> t.shift;  ///< Below 2^31 after the shift, d is clamped
+  r = r < 0 ? 0 : (r > t.rows ? t.rows : r);
+  return t.bottom - r;
+}
+
+/**
+ * @brief Convert a run of codes to rows
+ * @param t Transform
+ * @param codes Contiguous codes
+ * @param count Number of codes
+ * @param rows Receives count rows
+ */
+void codesToRows(const YTransform& t, const uint16_t* codes, int count, int16_t* rows);
+
+/**
+ * @brief Row of a value that is not a code, e.g. a mean of an aggregate
+ */
+int16_t valueToRow(const YTransform& t, float value);
+
+#endif  // YTRANSFORM_H
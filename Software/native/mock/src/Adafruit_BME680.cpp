@@ -0,0 +1,47 @@
+/**
+ * @file Adafruit_BME680.cpp
+ * @brief Conversion timing of the host BME680
+ */
+
+#include <Adafruit_BME680.h>
+
+bool Adafruit_BME680::begin(uint8_t addr, bool initSettings) {
+  (void)addr;
+  (void)initSettings;
+  measuring = false;
+  return hostPresent;
+}
+
+bool Adafruit_BME680::setGasHeater(uint16_t heaterTemp, uint16_t heaterTime) {
+  heaterMs = heaterTemp == 0 ? 0 : heaterTime;
+  return true;
+}
+
+uint32_t Adafruit_BME680::beginReading() {
+  if (!hostPresent) return 0;
+  if (!measuring) {
+    measuring = true;
+    measureStart = millis();
+  }
+  return measureStart + BME680_HOST_TPH_MS + heaterMs;
+}
+
+int Adafruit_BME680::remainingReadingMillis() {
+  if (!measuring) return -1;  ///< No reading started
+  int remaining = (int)(BME680_HOST_TPH_MS + heaterMs) - (int)(millis() - measureStart);
+  return remaining < 0 ? 0 : remaining;
+}
+
+bool Adafruit_BME680::endReading() {
+  if (beginReading() == 0) return false;
+  int remaining = remainingReadingMillis();
+  if (remaining > 0) delay(remaining);
+  measuring = false;
+
+  temperature = hostTemperature;
+  humidity = hostHumidity;
+  pressure = hostPressure;
+  gas_resistance = hostGas;
+  hostReadings++;
+  return true;
+}
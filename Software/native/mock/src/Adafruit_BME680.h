@@ -0,0 +1,76 @@
+/**
+ * @file Adafruit_BME680.h
+ * @brief Host stand-in for the Adafruit BME680/BME688 library
+ *
+ * Readings are the host* members, set by the harness at any time. The
+ * asynchronous API keeps its timing on the virtual clock: a conversion
+ * started with beginReading() is complete after the TPH time plus the
+ * heater duration, and endReading() before that waits like the library.
+ */
+
+#ifndef ADAFRUIT_BME680_HOST_H
+#define ADAFRUIT_BME680_HOST_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define BME68X_OS_NONE 0
+#define BME68X_OS_1X 1
+#define BME68X_OS_2X 2
+#define BME68X_OS_4X 3
+#define BME68X_OS_8X 4
+#define BME68X_OS_16X 5
+
+#define BME68X_FILTER_OFF 0
+#define BME68X_FILTER_SIZE_1 1
+#define BME68X_FILTER_SIZE_3 2
+#define BME68X_FILTER_SIZE_7 3
+#define BME68X_FILTER_SIZE_15 4
+#define BME68X_FILTER_SIZE_31 5
+#define BME68X_FILTER_SIZE_63 6
+#define BME68X_FILTER_SIZE_127 7
+
+#define BME68X_ODR_NONE 8
+
+/// Duration of a TPH conversion with the oversampling of the firmware
+#define BME680_HOST_TPH_MS 40
+
+/**
+ * @brief Temperature, humidity, pressure and gas sensor
+ */
+class Adafruit_BME680 {
+ public:
+  explicit Adafruit_BME680(TwoWire* wire = &Wire) { (void)wire; }
+
+  bool begin(uint8_t addr = 0x77, bool initSettings = true);
+  bool setTemperatureOversampling(uint8_t os) { return os <= BME68X_OS_16X; }
+  bool setPressureOversampling(uint8_t os) { return os <= BME68X_OS_16X; }
+  bool setHumidityOversampling(uint8_t os) { return os <= BME68X_OS_16X; }
+  bool setIIRFilterSize(uint8_t fs) { return fs <= BME68X_FILTER_SIZE_127; }
+  bool setODR(uint8_t odr) { return odr <= BME68X_ODR_NONE; }
+  bool setGasHeater(uint16_t heaterTemp, uint16_t heaterTime);
+
+  bool performReading() { return endReading(); }
+  uint32_t beginReading();
+  bool endReading();
+  int remainingReadingMillis();
+
+  float temperature = 0;        ///< Last reading in Celsius
+  uint32_t pressure = 0;        ///< Last reading in Pascal
+  float humidity = 0;           ///< Last reading in percent
+  uint32_t gas_resistance = 0;  ///< Last reading in Ohm
+
+  bool hostPresent = true;         ///< Sensor answers on the bus
+  float hostTemperature = 21.5F;   ///< Next temperature in Celsius
+  float hostHumidity = 45.0F;      ///< Next humidity in percent
+  uint32_t hostPressure = 101325;  ///< Next pressure in Pascal
+  uint32_t hostGas = 50000;        ///< Next gas resistance in Ohm
+  uint32_t hostReadings = 0;       ///< Completed conversions
+
+ private:
+  uint16_t heaterMs = 0;      ///< Heater duration, 0 if off
+  bool measuring = false;     ///< Conversion started and not collected
+  uint32_t measureStart = 0;  ///< millis() of beginReading()
+};
+
+#endif  // ADAFRUIT_BME680_HOST_H
@@ -0,0 +1,140 @@
+/**
+ * @file Arduino.cpp
+ * @brief Serial, String and helper functions of the host Arduino core
+ *
+ * Timing, pins and tasks live in host.cpp.
+ */
+
+#include <Arduino.h>
+#include <host.h>
+
+HWCDC Serial;
+
+static FILE* serialOut = stdout;  ///< Target of Serial, nullptr drops the output
+
+void hostSerialOutput(FILE* out) {
+  serialOut = out;
+}
+
+/**
+ * @brief Format an integer in any base like the Arduino core
+ */
+static std::string formatInteger(unsigned long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36) base = 10;
+  char digits[72];
+  int n = 0;
+  do {
+    int d = value % base;
+    digits[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+    value /= base;
+  } while (value > 0);
+  if (negative) digits[n++] = '-';
+  std::reverse(digits, digits + n);
+  return std::string(digits, n);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base)
+    : text(formatInteger(value < 0 && base == 10 ? -(unsigned long)value : (unsigned long)value, value < 0 && base == 10, base)) {}
+
+String::String(unsigned long value, unsigned char base) : text(formatInteger(value, false, base)) {}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+  text = buffer;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char small[128];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if ((size_t)len < sizeof(small)) return write((const uint8_t*)small, len);
+
+  std::string large(len + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&large[0], large.size(), format, args);
+  va_end(args);
+  return write((const uint8_t*)large.data(), len);
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+  size_t n = 0;
+  while (n < length) {
+    int c = read();
+    if (c < 0) break;
+    buffer[n++] = c;
+  }
+  return n;
+}
+
+size_t HWCDC::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HWCDC::write(const uint8_t* buffer, size_t size) {
+  if (serialOut) fwrite(buffer, 1, size, serialOut);
+  return size;
+}
+
+void HWCDC::flush() {
+  if (serialOut) fflush(serialOut);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  const long run = in_max - in_min;
+  if (run == 0) return -1;  ///< Like the ESP32 core
+  return (x - in_min) * (out_max - out_min) / run + out_min;
+}
+
+static uint32_t randomState = 1;  ///< State of random(), fixed unless seeded
+
+/**
+ * @brief xorshift32, the same sequence on every host
+ */
+static uint32_t nextRandom() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  return nextRandom() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) randomState = seed;
+}
+
+bool psramFound() {
+  return true;
+}
+
+void* ps_malloc(size_t size) {
+  return malloc(size);
+}
+
+void* ps_calloc(size_t n, size_t size) {
+  return calloc(n, size);
+}
@@ -0,0 +1,175 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the ESP32 Arduino core
+ *
+ * Contains:
+ * - Timing (millis(), micros(), delay()) on the virtual clock of host.h
+ * - GPIO and interrupts on a pin table the harness drives
+ * - Print, Stream, the Serial object and a small String
+ * - psramFound() and ps_malloc() backed by the host heap
+ * - The FreeRTOS task API through freertos/FreeRTOS.h
+ *
+ * Only the part of the core the firmware uses is provided. Like on the
+ * ESP32, millis() and micros() are 32 bits wide and wrap around.
+ */
+
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using std::abs;
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define ONLOW 0x04
+#define ONHIGH 0x05
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define digitalPinToInterrupt(p) (p)
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+bool psramFound();
+void* ps_malloc(size_t size);
+void* ps_calloc(size_t n, size_t size);
+
+/**
+ * @brief Minimal Arduino String
+ */
+class String {
+ public:
+  String(const char* s = "") : text(s ? s : "") {}
+  String(const std::string& s) : text(s) {}
+  String(char c) : text(1, c) {}
+  String(int value, unsigned char base = 10);
+  String(unsigned int value, unsigned char base = 10);
+  String(long value, unsigned char base = 10);
+  String(unsigned long value, unsigned char base = 10);
+  String(float value, unsigned int decimals = 2);
+  String(double value, unsigned int decimals = 2);
+
+  const char* c_str() const { return text.c_str(); }
+  unsigned int length() const { return text.length(); }
+  bool equals(const String& s) const { return text == s.text; }
+  bool operator==(const String& s) const { return text == s.text; }
+  bool operator!=(const String& s) const { return text != s.text; }
+  char operator[](unsigned int i) const { return i < text.size() ? text[i] : 0; }
+  String& operator+=(const String& s) {
+    text += s.text;
+    return *this;
+  }
+  friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+
+ private:
+  std::string text;  ///< Characters
+};
+
+/**
+ * @brief Formatted text output
+ */
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int n) { return printf("%d", n); }
+  size_t print(unsigned int n) { return printf("%u", n); }
+  size_t print(long n) { return printf("%ld", n); }
+  size_t print(unsigned long n) { return printf("%lu", n); }
+  size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T value) {
+    size_t n = print(value);
+    return n + println();
+  }
+  size_t println(double n, int digits) {
+    size_t len = print(n, digits);
+    return len + println();
+  }
+};
+
+/**
+ * @brief Input side of a serial port
+ */
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  size_t readBytes(uint8_t* buffer, size_t length);
+};
+
+/**
+ * @brief USB CDC port of the ESP32-S3, written to stdout on the host
+ */
+class HWCDC : public Stream {
+ public:
+  void begin(unsigned long baud = 0) { (void)baud; }
+  void end() {}
+  operator bool() const { return true; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  void flush();
+};
+
+extern HWCDC Serial;
+
+#endif  // ARDUINO_HOST_H
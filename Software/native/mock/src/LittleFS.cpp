@@ -0,0 +1,213 @@
+/**
+ * @file LittleFS.cpp
+ * @brief Files and directories of the host LittleFS
+ */
+
+#include <LittleFS.h>
+#include <dirent.h>
+#include <errno.h>
+#include <host.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+fs::LittleFSFS LittleFS;
+
+static std::string fsRoot = "littlefs";  ///< Host directory of the partition
+
+void hostFsRoot(const char* dir) {
+  fsRoot = dir;
+}
+
+namespace fs {
+
+/**
+ * @brief Host handle behind a File
+ */
+struct FileImpl {
+  std::string path;      ///< Path on the partition
+  std::string name;      ///< Last path component
+  std::string hostPath;  ///< Path on the host
+  FILE* file = nullptr;  ///< Open file, nullptr for a directory
+  DIR* dir = nullptr;    ///< Open directory
+
+  ~FileImpl() {
+    if (file) fclose(file);
+    if (dir) closedir(dir);
+  }
+};
+
+/**
+ * @brief Open a host path as file or directory
+ */
+static std::shared_ptr<FileImpl> openHost(const std::string& path, const std::string& hostPath, const char* mode) {
+  auto impl = std::make_shared<FileImpl>();
+  impl->path = path;
+  size_t slash = path.rfind('/');
+  impl->name = slash == std::string::npos ? path : path.substr(slash + 1);
+  impl->hostPath = hostPath;
+
+  struct stat st;
+  bool exists = stat(hostPath.c_str(), &st) == 0;
+  if (exists && S_ISDIR(st.st_mode)) {
+    impl->dir = opendir(hostPath.c_str());
+    return impl->dir ? impl : nullptr;
+  }
+  if (!exists && mode[0] == 'r') return nullptr;
+
+  std::string binary = std::string(mode) + "b";
+  impl->file = fopen(hostPath.c_str(), binary.c_str());
+  return impl->file ? impl : nullptr;
+}
+
+File::operator bool() const {
+  return impl && (impl->file || impl->dir);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!impl || !impl->file) return 0;
+  return fwrite(buf, 1, size, impl->file);
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!impl || !impl->file) return 0;
+  return fread(buf, 1, size, impl->file);
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::available() {
+  if (!impl || !impl->file) return 0;
+  return size() - position();
+}
+
+bool File::seek(uint32_t pos) {
+  if (!impl || !impl->file || pos > size()) return false;
+  return fseek(impl->file, pos, SEEK_SET) == 0;
+}
+
+size_t File::position() {
+  if (!impl || !impl->file) return 0;
+  return ftell(impl->file);
+}
+
+size_t File::size() {
+  if (!impl || !impl->file) return 0;
+  fflush(impl->file);
+  struct stat st;
+  return stat(impl->hostPath.c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+void File::flush() {
+  if (impl && impl->file) fflush(impl->file);
+}
+
+void File::close() {
+  impl.reset();
+}
+
+const char* File::name() const {
+  return impl ? impl->name.c_str() : "";
+}
+
+const char* File::path() const {
+  return impl ? impl->path.c_str() : "";
+}
+
+bool File::isDirectory() {
+  return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+  if (!impl || !impl->dir) return File();
+  for (struct dirent* entry = readdir(impl->dir); entry; entry = readdir(impl->dir)) {
+    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) continue;
+    std::string path = impl->path == "/" ? "/" + std::string(entry->d_name) : impl->path + "/" + entry->d_name;
+    return File(openHost(path, impl->hostPath + "/" + entry->d_name, mode));
+  }
+  return File();
+}
+
+std::string FS::hostPath(const char* path) const {
+  return fsRoot + (path[0] == '/' ? "" : "/") + path;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+  (void)create;
+  return File(openHost(path, hostPath(path), mode));
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char* path) {
+  return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpen, const char* label) {
+  (void)basePath;
+  (void)maxOpen;
+  (void)label;
+  struct stat st;
+  if (stat(fsRoot.c_str(), &st) == 0) return S_ISDIR(st.st_mode);
+  return formatOnFail && ::mkdir(fsRoot.c_str(), 0755) == 0;
+}
+
+/**
+ * @brief Remove a host directory tree
+ */
+static void removeTree(const std::string& path) {
+  DIR* dir = opendir(path.c_str());
+  if (!dir) {
+    unlink(path.c_str());
+    return;
+  }
+  for (struct dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) removeTree(path + "/" + entry->d_name);
+  }
+  closedir(dir);
+  ::rmdir(path.c_str());
+}
+
+bool LittleFSFS::format() {
+  removeTree(fsRoot);
+  return ::mkdir(fsRoot.c_str(), 0755) == 0;
+}
+
+/**
+ * @brief Bytes of the files below a host directory
+ */
+static size_t treeBytes(const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return 0;
+  if (!S_ISDIR(st.st_mode)) return st.st_size;
+  size_t bytes = 0;
+  DIR* dir = opendir(path.c_str());
+  for (struct dirent* entry = dir ? readdir(dir) : nullptr; entry; entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) bytes += treeBytes(path + "/" + entry->d_name);
+  }
+  if (dir) closedir(dir);
+  return bytes;
+}
+
+size_t LittleFSFS::usedBytes() {
+  return treeBytes(fsRoot);
+}
+
+}  // namespace fs
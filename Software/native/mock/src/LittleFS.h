@@ -0,0 +1,91 @@
+/**
+ * @file LittleFS.h
+ * @brief Host stand-in for LittleFS, backed by a host directory
+ *
+ * Paths are relative to the directory set with hostFsRoot() ("littlefs"
+ * in the working directory by default), so a log survives between runs
+ * like on the flash. Start from an empty directory for repeatable runs.
+ */
+
+#ifndef LITTLEFS_HOST_H
+#define LITTLEFS_HOST_H
+
+#include <Arduino.h>
+
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+struct FileImpl;
+
+/**
+ * @brief Open file or directory, invalid if the open failed
+ */
+class File {
+ public:
+  File() {}
+  explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+  operator bool() const;
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size);
+  size_t read(uint8_t* buf, size_t size);
+  int read();
+  int available();
+  bool seek(uint32_t pos);
+  size_t position();
+  size_t size();
+  void flush();
+  void close();
+  const char* name() const;
+  const char* path() const;
+  bool isDirectory();
+  File openNextFile(const char* mode = FILE_READ);
+
+ private:
+  std::shared_ptr<FileImpl> impl;  ///< Shared like the handle of the core
+};
+
+/**
+ * @brief File system on a host directory
+ */
+class FS {
+ public:
+  File open(const char* path, const char* mode = FILE_READ, bool create = false);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+  bool rmdir(const char* path);
+
+ protected:
+  /**
+   * @brief Host path of a path on the partition
+   */
+  std::string hostPath(const char* path) const;
+};
+
+/**
+ * @brief The LittleFS partition
+ */
+class LittleFSFS : public FS {
+ public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpen = 10, const char* label = "spiffs");
+  void end() {}
+  bool format();
+  size_t totalBytes() { return 0x100000; }  ///< Size of the partition in the default table
+  size_t usedBytes();
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+extern fs::LittleFSFS LittleFS;
+
+#endif  // LITTLEFS_HOST_H
@@ -0,0 +1,66 @@
+/**
+ * @file TFT_Touch.h
+ * @brief Host stand-in for the TFT_Touch (XPT2046) library
+ *
+ * The pen position is set by the harness with hostPress() and returned
+ * as calibrated screen coordinates. The PENIRQ line is a separate pin,
+ * the harness drives it with hostSetPin().
+ */
+
+#ifndef TFT_TOUCH_HOST_H
+#define TFT_TOUCH_HOST_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Resistive touch controller
+ */
+class TFT_Touch {
+ public:
+  TFT_Touch(uint8_t cs, uint8_t clk, uint8_t din, uint8_t dout) {
+    (void)cs;
+    (void)clk;
+    (void)din;
+    (void)dout;
+  }
+
+  void setCal(uint16_t xmin, uint16_t xmax, uint16_t ymin, uint16_t ymax, uint16_t xres, uint16_t yres, bool axis) {
+    (void)xmin;
+    (void)xmax;
+    (void)ymin;
+    (void)ymax;
+    (void)xres;
+    (void)yres;
+    (void)axis;
+  }
+  void setRotation(uint8_t rotation) { (void)rotation; }
+  void setThreshold(uint16_t threshold) { (void)threshold; }
+
+  bool Pressed() { return pressed; }
+  uint16_t X() { return x; }
+  uint16_t Y() { return y; }
+  uint16_t RawX() { return x; }
+  uint16_t RawY() { return y; }
+  uint16_t Zval() { return pressed ? 1000 : 0; }
+
+  /**
+   * @brief Put the pen down at a screen position
+   */
+  void hostPress(uint16_t px, uint16_t py) {
+    pressed = true;
+    x = px;
+    y = py;
+  }
+
+  /**
+   * @brief Lift the pen
+   */
+  void hostRelease() { pressed = false; }
+
+ private:
+  bool pressed = false;  ///< Pen down
+  uint16_t x = 0;        ///< Screen column of the pen
+  uint16_t y = 0;        ///< Screen row of the pen
+};
+
+#endif  // TFT_TOUCH_HOST_H
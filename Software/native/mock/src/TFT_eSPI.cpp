@@ -0,0 +1,656 @@
+/**
+ * @file TFT_eSPI.cpp
+ * @brief Software panel, sprites and block font of the host TFT_eSPI
+ *
+ * All shapes are reduced to fillRect() and drawPixel(), which the panel
+ * and the sprites implement. On the panel every such call is one address
+ * window on the bus, like the runs the library writes. Glyphs are packed
+ * 1-bit bitmaps decoded run by run, as the library draws GFX fonts.
+ */
+
+#include <TFT_eSPI.h>
+
+/// Metrics of the free fonts: advance of a digit, line height, ascent, cap height
+const GFXfont FreeSans9pt7b = {10, 22, 17, 13};
+const GFXfont FreeSansBold12pt7b = {14, 29, 22, 17};
+const GFXfont FreeSansBold18pt7b = {20, 42, 33, 25};
+const GFXfont FreeSansBold24pt7b = {27, 56, 44, 34};
+
+/// Metrics of the numbered fonts 1, 2, 4, 6, 7 and 8
+static const GFXfont glcdFont = {6, 8, 7, 7};
+static const GFXfont font2 = {8, 16, 13, 11};
+static const GFXfont font4 = {14, 26, 21, 18};
+static const GFXfont font6 = {27, 48, 40, 36};
+static const GFXfont font7 = {32, 48, 48, 48};
+static const GFXfont font8 = {55, 75, 75, 75};
+
+/// Segments a-g (bit 0-6) of the digits
+static const uint8_t segmentsOfDigit[10] = {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F};
+
+/// Default palette of 4-bit sprites, as in the library
+static const uint16_t defaultPalette[16] = {
+    TFT_BLACK, TFT_BROWN, TFT_RED, TFT_ORANGE, TFT_YELLOW, TFT_GREEN, TFT_BLUE, TFT_PURPLE,
+    TFT_DARKGREY, TFT_WHITE, TFT_CYAN, TFT_MAGENTA, TFT_MAROON, TFT_DARKGREEN, TFT_NAVY, TFT_PINK};
+
+/**
+ * @brief Swap the bytes of a color word
+ */
+static inline uint16_t swap16(uint16_t c) {
+  return (c >> 8) | (c << 8);
+}
+
+/**
+ * @brief Clip a rectangle to a w x h area
+ * @return false if nothing is left
+ */
+static bool clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h, int32_t width, int32_t height) {
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if (x + w > width) w = width - x;
+  if (y + h > height) h = height - y;
+  return w > 0 && h > 0;
+}
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _width(w), _height(h), _init_width(w), _init_height(h) {
+  panel.assign((size_t)w * h, TFT_BLACK);
+}
+
+void TFT_eSPI::init(uint8_t tc) {
+  (void)tc;
+  bus.bytes += 16;  ///< Reset and the SSD1963 register setup, roughly
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+  rotation = r & 3;
+  bool landscape = rotation & 1;
+  int32_t w = landscape ? _init_height : _init_width;
+  int32_t h = landscape ? _init_width : _init_height;
+  if (w != _width || h != _height) panel.assign((size_t)w * h, TFT_BLACK);
+  _width = w;
+  _height = h;
+  bus.bytes += 2;  ///< MADCTL
+}
+
+void TFT_eSPI::countWindow(int64_t pixels) {
+  bus.windows++;
+  bus.pixels += pixels;
+  bus.bytes += TFT_BUS_WINDOW_BYTES + pixels * TFT_BUS_PIXEL_BYTES;
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  panel[y * _width + x] = color;
+  countWindow(1);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!clip(x, y, w, h, _width, _height)) return;
+  for (int32_t row = y; row < y + h; row++) std::fill_n(&panel[row * _width + x], w, (uint16_t)color);
+  countWindow((int64_t)w * h);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) {
+  int32_t cx = x, cy = y, cw = w, ch = h;
+  if (!clip(cx, cy, cw, ch, _width, _height)) return;
+  for (int32_t row = 0; row < ch; row++) {
+    const uint16_t* src = data + (cy - y + row) * w + (cx - x);
+    uint16_t* dst = &panel[(cy + row) * _width + cx];
+    for (int32_t col = 0; col < cw; col++) dst[col] = _swapBytes ? src[col] : swap16(src[col]);
+  }
+  countWindow((int64_t)cw * ch);
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  return panel[y * _width + x];
+}
+
+void TFT_eSPI::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  winX0 = winX = x0;
+  winY0 = winY = y0;
+  winX1 = x1;
+  winY1 = y1;
+  countWindow(0);
+}
+
+void TFT_eSPI::windowWrite(const uint16_t* colors, uint16_t fill, uint32_t len) {
+  bus.pixels += len;
+  bus.bytes += (uint64_t)len * TFT_BUS_PIXEL_BYTES;
+  for (uint32_t i = 0; i < len; i++) {
+    if (winY > winY1) return;  ///< The controller ignores data past the window
+    uint16_t c = colors ? (_swapBytes ? colors[i] : swap16(colors[i])) : fill;
+    if (winX >= 0 && winY >= 0 && winX < _width && winY < _height) panel[winY * _width + winX] = c;
+    if (++winX > winX1) {
+      winX = winX0;
+      winY++;
+    }
+  }
+}
+
+void TFT_eSPI::pushBlock(uint16_t color, uint32_t len) {
+  windowWrite(nullptr, color, len);
+}
+
+void TFT_eSPI::pushPixels(const void* data, uint32_t len) {
+  windowWrite((const uint16_t*)data, 0, len);
+}
+
+bool TFT_eSPI::hostSavePpm(const char* path) const {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", (int)_width, (int)_height);
+  for (uint16_t c : panel) {
+    uint8_t rgb[3] = {(uint8_t)((c >> 8) & 0xF8), (uint8_t)((c >> 3) & 0xFC), (uint8_t)(c << 3)};
+    fwrite(rgb, 1, 3, f);
+  }
+  return fclose(f) == 0;
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color);
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+/**
+ * @brief Horizontal half width of a row of a rounded corner
+ */
+static int32_t cornerInset(int32_t r, int32_t dy) {
+  int32_t dx = 0;
+  while ((dx + 1) * (dx + 1) + dy * dy <= r * r) dx++;
+  return r - dx;
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+  if (r > w / 2) r = w / 2;
+  if (r > h / 2) r = h / 2;
+  drawFastHLine(x + r, y, w - 2 * r, color);
+  drawFastHLine(x + r, y + h - 1, w - 2 * r, color);
+  drawFastVLine(x, y + r, h - 2 * r, color);
+  drawFastVLine(x + w - 1, y + r, h - 2 * r, color);
+  for (int32_t i = 0; i < r; i++) {
+    int32_t inset = cornerInset(r, r - i);
+    drawPixel(x + inset, y + i, color);
+    drawPixel(x + w - 1 - inset, y + i, color);
+    drawPixel(x + inset, y + h - 1 - i, color);
+    drawPixel(x + w - 1 - inset, y + h - 1 - i, color);
+  }
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+  if (r > w / 2) r = w / 2;
+  if (r > h / 2) r = h / 2;
+  fillRect(x, y + r, w, h - 2 * r, color);
+  for (int32_t i = 0; i < r; i++) {
+    int32_t inset = cornerInset(r, r - i);
+    drawFastHLine(x + inset, y + i, w - 2 * inset, color);
+    drawFastHLine(x + inset, y + h - 1 - i, w - 2 * inset, color);
+  }
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+
+  ///< Bresenham, every run of the major axis becomes one fast line
+  int32_t dx = x1 - x0, dy = abs(y1 - y0), err = dx >> 1, ystep = y0 < y1 ? 1 : -1;
+  int32_t runStart = x0;
+  for (int32_t x = x0; x <= x1; x++) {
+    err -= dy;
+    if (err < 0 || x == x1) {
+      int32_t len = x - runStart + 1;
+      if (steep) {
+        drawFastVLine(y0, runStart, len, color);
+      } else {
+        drawFastHLine(runStart, y0, len, color);
+      }
+      runStart = x + 1;
+      if (err < 0) {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  int32_t x = 0, y = r, f = 1 - r;
+  while (x <= y) {
+    drawPixel(x0 + x, y0 + y, color);
+    drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color);
+    drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color);
+    drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color);
+    drawPixel(x0 - y, y0 - x, color);
+    x++;
+    if (f < 0) {
+      f += 2 * x + 1;
+    } else {
+      y--;
+      f += 2 * (x - y) + 1;
+    }
+  }
+}
+
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  for (int32_t dy = -r; dy <= r; dy++) {
+    int32_t half = r - cornerInset(r, abs(dy));
+    drawFastHLine(x0 - half, y0 + dy, 2 * half + 1, color);
+  }
+}
+
+void TFT_eSPI::setFreeFont(const GFXfont* f) {
+  textfont = 1;
+  gfxFont = f;
+}
+
+void TFT_eSPI::setTextFont(uint8_t font) {
+  textfont = font < 1 || font > 8 ? 1 : font;
+  gfxFont = nullptr;
+}
+
+const GFXfont& TFT_eSPI::metrics(uint8_t font) const {
+  if (font == 1 && gfxFont) return *gfxFont;
+  switch (font) {
+    case 2:
+      return font2;
+    case 4:
+      return font4;
+    case 6:
+      return font6;
+    case 7:
+      return font7;
+    case 8:
+      return font8;
+    default:
+      return glcdFont;
+  }
+}
+
+int16_t TFT_eSPI::textWidth(const char* string, uint8_t font) {
+  return strlen(string) * metrics(font).advance;
+}
+
+int16_t TFT_eSPI::fontHeight(uint8_t font) {
+  return metrics(font).yAdvance;
+}
+
+/**
+ * @brief Packed 1-bit bitmap of a glyph in the layout of a GFX font
+ *
+ * Rows follow each other without padding, the first pixel is bit 7 of
+ * the first byte. The box sits at (xOffset, yOffset) in the glyph cell.
+ */
+struct GlyphBitmap {
+  int32_t xOffset, yOffset;   ///< Position of the box in the cell
+  int32_t width, height;      ///< Size of the box
+  std::vector<uint8_t> bits;  ///< Packed pixels
+};
+
+/**
+ * @brief Rasterize a block glyph into its bitmap
+ */
+static void rasterizeGlyph(char c, const GFXfont& m, GlyphBitmap& g) {
+  int32_t margin = m.advance / 8 + 1;
+  int32_t t = m.capHeight / 8 + 1;  ///< Stroke width
+  int32_t width = m.advance - 2 * margin, height = m.capHeight;
+  int32_t middle = (height - t) / 2;
+  g.xOffset = margin;
+  g.yOffset = m.ascent - m.capHeight;
+  g.width = width;
+  g.height = height;
+  g.bits.assign((width * height + 7) / 8, 0);
+
+  auto fill = [&](int32_t x, int32_t y, int32_t w, int32_t h) {
+    for (int32_t yy = y; yy < y + h; yy++) {
+      for (int32_t xx = x; xx < x + w; xx++) {
+        int32_t bit = yy * width + xx;
+        g.bits[bit >> 3] |= 0x80 >> (bit & 7);
+      }
+    }
+  };
+
+  uint8_t segments;
+  if (c >= '0' && c <= '9') {
+    segments = segmentsOfDigit[c - '0'];
+  } else if (c == '-') {
+    segments = 0x40;
+  } else if (c == '.' || c == ',') {
+    fill(0, height - t, t, t);
+    return;
+  } else if (c == ':') {
+    fill((width - t) / 2, height / 4, t, t);
+    fill((width - t) / 2, 3 * height / 4 - t, t, t);
+    return;
+  } else {
+    segments = (uint8_t)((c * 37) & 0x7F) | 0x01;  ///< Letters and symbols: any stable pattern
+  }
+
+  if (segments & 0x01) fill(0, 0, width, t);                         ///< a
+  if (segments & 0x02) fill(width - t, 0, t, middle + t);            ///< b
+  if (segments & 0x04) fill(width - t, middle, t, height - middle);  ///< c
+  if (segments & 0x08) fill(0, height - t, width, t);                ///< d
+  if (segments & 0x10) fill(0, middle, t, height - middle);          ///< e
+  if (segments & 0x20) fill(0, 0, t, middle + t);                    ///< f
+  if (segments & 0x40) fill(0, middle, width, t);                    ///< g
+}
+
+/**
+ * @brief Bitmap of a glyph, rasterized on first use
+ */
+static const GlyphBitmap& glyphBitmap(char c, const GFXfont& m) {
+  static const GFXfont* fonts[16];
+  static GlyphBitmap* glyphs[16][128];
+  int font = 0;
+  while (font < 15 && fonts[font] && fonts[font] != &m) font++;
+  fonts[font] = &m;
+  GlyphBitmap*& g = glyphs[font][c & 0x7F];
+  if (!g) {
+    g = new GlyphBitmap;
+    rasterizeGlyph(c, m, *g);
+  }
+  return *g;
+}
+
+void TFT_eSPI::drawGlyph(char c, int32_t x, int32_t y, const GFXfont& m, uint16_t color) {
+  ///< Decode like the library's drawChar(): bit by bit, one horizontal line per run
+  const GlyphBitmap& g = glyphBitmap(c, m);
+  const uint8_t* bitmap = g.bits.data();
+  x += g.xOffset;
+  y += g.yOffset;
+  uint8_t bits = 0, bit = 0;
+  for (int32_t yy = 0; yy < g.height; yy++) {
+    int32_t run = 0;
+    for (int32_t xx = 0; xx < g.width; xx++) {
+      if (!bit) {
+        bits = *bitmap++;
+        bit = 0x80;
+      }
+      if (bits & bit) {
+        run++;
+      } else if (run) {
+        drawFastHLine(x + xx - run, y + yy, run, color);
+        run = 0;
+      }
+      bit >>= 1;
+    }
+    if (run) drawFastHLine(x + g.width - run, y + yy, run, color);
+  }
+}
+
+int16_t TFT_eSPI::drawString(const char* string, int32_t x, int32_t y, uint8_t font) {
+  const GFXfont& m = metrics(font);
+  int32_t w = textWidth(string, font), h = m.yAdvance;
+
+  switch (textdatum) {
+    case TC_DATUM:
+    case MC_DATUM:
+    case BC_DATUM:
+    case C_BASELINE:
+      x -= w / 2;
+      break;
+    case TR_DATUM:
+    case MR_DATUM:
+    case BR_DATUM:
+    case R_BASELINE:
+      x -= w;
+      break;
+  }
+  switch (textdatum) {
+    case ML_DATUM:
+    case MC_DATUM:
+    case MR_DATUM:
+      y -= h / 2;
+      break;
+    case BL_DATUM:
+    case BC_DATUM:
+    case BR_DATUM:
+      y -= h;
+      break;
+    case L_BASELINE:
+    case C_BASELINE:
+    case R_BASELINE:
+      y -= m.ascent;
+      break;
+  }
+
+  if (textbgcolor != textcolor && !(font == 1 && gfxFont)) fillRect(x, y, w, h, textbgcolor);  ///< Numbered fonts fill the cell
+  for (const char* c = string; *c; c++, x += m.advance) {
+    if (*c != ' ') drawGlyph(*c, x, y, m, textcolor);
+  }
+  return w;
+}
+
+TFT_eSprite::TFT_eSprite(TFT_eSPI* tft) : TFT_eSPI(true), parent(tft) {
+  memcpy(palette, defaultPalette, sizeof(palette));
+}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+  (void)frames;
+  if (buffer) return buffer;
+  if (w < 1 || h < 1) return nullptr;
+
+  size_t bytes;
+  switch (bpp) {
+    case 8:
+      bytes = (size_t)w * h;
+      break;
+    case 4:
+      bytes = ((size_t)w * h >> 1) + 1;
+      break;
+    case 1:
+      bitwidth = (w + 7) & ~7;
+      bytes = (size_t)bitwidth * h / 8 + 1;
+      break;
+    default:
+      bytes = (size_t)w * h * 2;
+      break;
+  }
+  buffer = (uint8_t*)calloc(bytes, 1);
+  if (!buffer) return nullptr;
+  _width = _init_width = w;
+  _height = _init_height = h;
+  scrollW = scrollH = 0;
+  return buffer;
+}
+
+void TFT_eSprite::deleteSprite() {
+  free(buffer);
+  buffer = nullptr;
+  _width = _height = 0;
+}
+
+void* TFT_eSprite::setColorDepth(int8_t b) {
+  if (b != 16 && b != 8 && b != 4 && b != 1) b = 16;
+  if (b == bpp) return buffer;
+  bpp = b;
+  if (!buffer) return nullptr;
+  int16_t w = _width, h = _height;
+  deleteSprite();
+  return createSprite(w, h);
+}
+
+void TFT_eSprite::createPalette(uint16_t* colorMap, uint8_t colors) {
+  memcpy(palette, defaultPalette, sizeof(palette));
+  if (!colorMap) return;
+  if (colors > 16) colors = 16;
+  memcpy(palette, colorMap, colors * sizeof(uint16_t));
+}
+
+void TFT_eSprite::writeValue(int32_t x, int32_t y, uint16_t color) {
+  switch (bpp) {
+    case 16:
+      ((uint16_t*)buffer)[y * _width + x] = swap16(color);
+      break;
+    case 8:
+      buffer[y * _width + x] = ((color & 0xE000) >> 8) | ((color & 0x0700) >> 6) | ((color & 0x0018) >> 3);
+      break;
+    case 4: {
+      uint8_t& cell = buffer[(x + y * _width) >> 1];
+      cell = (x & 1) ? (cell & 0xF0) | (color & 0x0F) : (cell & 0x0F) | (color << 4);
+      break;
+    }
+    case 1: {
+      uint8_t& cell = buffer[(x + y * bitwidth) >> 3];
+      uint8_t mask = 0x80 >> (x & 7);
+      cell = color ? cell | mask : cell & ~mask;
+      break;
+    }
+  }
+}
+
+uint16_t TFT_eSprite::readPixelValue(int32_t x, int32_t y) {
+  if (!buffer || x < 0 || y < 0 || x >= _width || y >= _height) return 0xFFFF;
+  switch (bpp) {
+    case 16:
+      return ((uint16_t*)buffer)[y * _width + x];
+    case 8:
+      return buffer[y * _width + x];
+    case 4: {
+      uint8_t cell = buffer[(x + y * _width) >> 1];
+      return (x & 1) ? cell & 0x0F : cell >> 4;
+    }
+    default:
+      return (buffer[(x + y * bitwidth) >> 3] >> (7 - (x & 7))) & 1;
+  }
+}
+
+uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y) {
+  if (!buffer || x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  uint16_t value = readPixelValue(x, y);
+  switch (bpp) {
+    case 16:
+      return swap16(value);
+    case 8: {
+      uint16_t r = (value & 0xE0) >> 5, g = (value & 0x1C) >> 2, b = value & 0x03;
+      return (r << 13) | (r << 10) | (g << 8) | (g << 5) | (b << 3) | (b << 1) | (b >> 1);
+    }
+    case 4:
+      return palette[value];
+    default:
+      return value ? bitmapFg : bitmapBg;
+  }
+}
+
+void TFT_eSprite::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (!buffer || x < 0 || y < 0 || x >= _width || y >= _height) return;
+  writeValue(x, y, color);
+}
+
+void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!buffer || !clip(x, y, w, h, _width, _height)) return;
+  if (bpp == 16) {
+    uint16_t* pixels = (uint16_t*)buffer;
+    for (int32_t row = y; row < y + h; row++) std::fill_n(pixels + row * _width + x, w, swap16(color));
+    return;
+  }
+  for (int32_t row = y; row < y + h; row++) {
+    for (int32_t col = x; col < x + w; col++) writeValue(col, row, color);
+  }
+}
+
+void TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) {
+  int32_t cx = x, cy = y, cw = w, ch = h;
+  if (!buffer || !clip(cx, cy, cw, ch, _width, _height)) return;
+  for (int32_t row = 0; row < ch; row++) {
+    const uint16_t* src = data + (cy - y + row) * w + (cx - x);
+    for (int32_t col = 0; col < cw; col++) writeValue(cx + col, cy + row, _swapBytes ? src[col] : swap16(src[col]));
+  }
+}
+
+void TFT_eSprite::setScrollRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+  if (!clip(x, y, w, h, _width, _height)) return;
+  scrollX = x;
+  scrollY = y;
+  scrollW = w;
+  scrollH = h;
+  scrollColor = color;
+}
+
+void TFT_eSprite::scroll(int16_t dx, int16_t dy) {
+  if (!buffer) return;
+  int32_t x = scrollX, y = scrollY, w = scrollW, h = scrollH;
+  if (w == 0 || h == 0) {
+    x = y = 0;
+    w = _width;
+    h = _height;
+  }
+
+  ///< Copy raw values in the order that never reads an overwritten pixel
+  uint16_t raw = bpp == 16 ? swap16(scrollColor) : scrollColor;
+  for (int32_t i = 0; i < h; i++) {
+    int32_t row = dy > 0 ? y + h - 1 - i : y + i;
+    for (int32_t j = 0; j < w; j++) {
+      int32_t col = dx > 0 ? x + w - 1 - j : x + j;
+      int32_t fromCol = col - dx, fromRow = row - dy;
+      bool inside = fromCol >= x && fromCol < x + w && fromRow >= y && fromRow < y + h;
+      uint16_t value = inside ? readPixelValue(fromCol, fromRow) : raw;
+      writeValue(col, row, bpp == 16 ? swap16(value) : value);
+    }
+  }
+}
+
+void TFT_eSprite::pushRegion(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh) {
+  if (bpp == 16 && sw == _width) {
+    bool swap = parent->getSwapBytes();
+    parent->setSwapBytes(false);  ///< The buffer holds the words in bus order
+    parent->pushImage(tx, ty, sw, sh, (uint16_t*)buffer + sy * _width);
+    parent->setSwapBytes(swap);
+    return;
+  }
+
+  ///< One window for the visible part, converted to RGB565 in chunks without a heap buffer
+  int32_t cx = tx, cy = ty, cw = sw, ch = sh;
+  if (!clip(cx, cy, cw, ch, parent->width(), parent->height())) return;
+  sx += cx - tx;
+  sy += cy - ty;
+
+  uint16_t chunk[64];
+  bool swap = parent->getSwapBytes();
+  parent->setSwapBytes(true);
+  parent->setWindow(cx, cy, cx + cw - 1, cy + ch - 1);
+  for (int32_t row = 0; row < ch; row++) {
+    for (int32_t col = 0; col < cw; col += 64) {
+      int32_t n = cw - col < 64 ? cw - col : 64;
+      for (int32_t i = 0; i < n; i++) chunk[i] = readPixel(sx + col + i, sy + row);
+      parent->pushPixels(chunk, n);
+    }
+  }
+  parent->setSwapBytes(swap);
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+  if (buffer) pushRegion(x, y, 0, 0, _width, _height);
+}
+
+bool TFT_eSprite::pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh) {
+  if (!buffer) return false;
+  int32_t x = sx, y = sy, w = sw, h = sh;
+  if (!clip(x, y, w, h, _width, _height)) return false;
+  pushRegion(tx + x - sx, ty + y - sy, x, y, w, h);
+  return true;
+}
+
+bool TFT_eSprite::pushToSprite(TFT_eSprite* dspr, int32_t x, int32_t y) {
+  if (!buffer || !dspr) return false;
+  for (int32_t row = 0; row < _height; row++) {
+    for (int32_t col = 0; col < _width; col++) dspr->drawPixel(x + col, y + row, readPixel(col, row));
+  }
+  return true;
+}
@@ -0,0 +1,310 @@
+/**
+ * @file TFT_eSPI.h
+ * @brief Host stand-in for TFT_eSPI with a software panel
+ *
+ * Contains:
+ * - TFT_eSPI, which draws into an in-memory RGB565 panel and counts the
+ *   bytes the SSD1963 would receive on the 8-bit bus
+ * - TFT_eSprite with 16-, 8-, 4- and 1-bit buffers in the memory layout of
+ *   the library, so code that reads getPointer() works unchanged
+ * - The color and datum constants and the free fonts the firmware uses
+ *
+ * Bus model: every primitive sets one address window per run it writes
+ * (CASET and PASET with 4 parameters each plus RAMWR, 11 bytes), and
+ * every pixel costs 3 bytes. pushBlock() and pushPixels() continue in the
+ * window of setAddrWindow(). Colors follow the library: pushImage() sends
+ * a word as stored unless setSwapBytes(true), pushBlock() sends the color
+ * value itself.
+ *
+ * Text uses block glyphs with the advance and height of the real fonts, so
+ * layouts and measurements behave like on the target while the pixels are
+ * only roughly the same. Digits are drawn as seven-segment figures. Each
+ * glyph is stored as a packed 1-bit bitmap and decoded bit by bit into
+ * horizontal runs like the library's drawChar(), so text costs about as
+ * much CPU time per pixel as on the target.
+ */
+
+#ifndef TFT_ESPI_HOST_H
+#define TFT_ESPI_HOST_H
+
+#include <Arduino.h>
+
+#include <vector>
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 480
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 800
+#endif
+
+/// Bytes of CASET, PASET and RAMWR with their parameters
+#define TFT_BUS_WINDOW_BYTES 11
+/// Bytes per pixel of the SSD1963 on the 8-bit bus
+#define TFT_BUS_PIXEL_BYTES 3
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_DARKCYAN 0x03EF
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK 0xFE19
+#define TFT_BROWN 0x9A60
+#define TFT_GOLD 0xFEA0
+#define TFT_SILVER 0xC618
+#define TFT_SKYBLUE 0x867D
+#define TFT_VIOLET 0x915C
+#define TFT_TRANSPARENT 0x0120
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define CL_DATUM 3
+#define MC_DATUM 4
+#define CC_DATUM 4
+#define MR_DATUM 5
+#define CR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+#define L_BASELINE 9
+#define C_BASELINE 10
+#define R_BASELINE 11
+
+/**
+ * @brief Metrics of a font, replaces the glyph tables of the library
+ */
+struct GFXfont {
+  uint8_t advance;    ///< Pen advance of every character
+  uint8_t yAdvance;   ///< Line height
+  uint8_t ascent;     ///< Rows from the top of the line to the baseline
+  uint8_t capHeight;  ///< Height of the glyphs above the baseline
+};
+
+extern const GFXfont FreeSans9pt7b;
+extern const GFXfont FreeSansBold12pt7b;
+extern const GFXfont FreeSansBold18pt7b;
+extern const GFXfont FreeSansBold24pt7b;
+
+/**
+ * @brief Counters of the simulated panel bus
+ */
+struct TFTBusStats {
+  uint64_t bytes;    ///< Bytes sent, commands and pixels
+  uint64_t pixels;   ///< Pixels written
+  uint32_t windows;  ///< Address windows set
+};
+
+class TFT_eSprite;
+
+/**
+ * @brief Display driver that renders into host memory
+ */
+class TFT_eSPI {
+ public:
+  TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+  virtual ~TFT_eSPI() {}
+
+  void init(uint8_t tc = 0);
+  void begin(uint8_t tc = 0) { init(tc); }
+  void setRotation(uint8_t r);
+  uint8_t getRotation() { return rotation; }
+  int16_t width() { return _width; }
+  int16_t height() { return _height; }
+
+  virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+  virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  virtual void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) { pushImage(x, y, w, h, (uint16_t*)data); }
+  virtual uint16_t readPixel(int32_t x, int32_t y);
+
+  void fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+
+  void setTextColor(uint16_t color) { textcolor = textbgcolor = color; }
+  void setTextColor(uint16_t fg, uint16_t bg, bool bgfill = false) {
+    textcolor = fg;
+    textbgcolor = bg;
+    (void)bgfill;
+  }
+  void setTextDatum(uint8_t datum) { textdatum = datum; }
+  uint8_t getTextDatum() { return textdatum; }
+  void setFreeFont(const GFXfont* f = nullptr);
+  void setTextFont(uint8_t font);
+  int16_t textWidth(const char* string, uint8_t font);
+  int16_t textWidth(const char* string) { return textWidth(string, textfont); }
+  int16_t textWidth(const String& string, uint8_t font) { return textWidth(string.c_str(), font); }
+  int16_t textWidth(const String& string) { return textWidth(string.c_str(), textfont); }
+  int16_t fontHeight(uint8_t font);
+  int16_t fontHeight() { return fontHeight(textfont); }
+  int16_t drawString(const char* string, int32_t x, int32_t y, uint8_t font);
+  int16_t drawString(const char* string, int32_t x, int32_t y) { return drawString(string, x, y, textfont); }
+  int16_t drawString(const String& string, int32_t x, int32_t y, uint8_t font) { return drawString(string.c_str(), x, y, font); }
+  int16_t drawString(const String& string, int32_t x, int32_t y) { return drawString(string.c_str(), x, y, textfont); }
+
+  void startWrite() {}
+  void endWrite() {}
+  void setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) { setWindow(x, y, x + w - 1, y + h - 1); }
+  void pushBlock(uint16_t color, uint32_t len);
+  void pushPixels(const void* data, uint32_t len);
+  void pushColor(uint16_t color) { pushBlock(color, 1); }
+  void pushColor(uint16_t color, uint32_t len) { pushBlock(color, len); }
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  bool getSwapBytes() { return _swapBytes; }
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3); }
+
+  /**
+   * @brief Panel contents as RGB565, width() x height() in the current rotation
+   */
+  const uint16_t* hostFrame() const { return panel.data(); }
+
+  /**
+   * @brief Bus counters since boot or the last hostResetBus()
+   */
+  const TFTBusStats& hostBus() const { return bus; }
+
+  /**
+   * @brief Clear the bus counters
+   */
+  void hostResetBus() { bus = {}; }
+
+  /**
+   * @brief Write the panel as binary PPM
+   * @return false if the file cannot be written
+   */
+  bool hostSavePpm(const char* path) const;
+
+ protected:
+  /**
+   * @brief Constructor of sprites, which have no panel
+   */
+  explicit TFT_eSPI(bool) : _width(0), _height(0) {}
+
+  int32_t _width;                    ///< Width in the current rotation
+  int32_t _height;                   ///< Height in the current rotation
+  int32_t _init_width = 0;           ///< Width in rotation 0
+  int32_t _init_height = 0;          ///< Height in rotation 0
+  uint8_t rotation = 0;              ///< Rotation 0-3
+  bool _swapBytes = false;           ///< Swap the words of pushImage()
+  uint16_t textcolor = 0xFFFF;       ///< Text color
+  uint16_t textbgcolor = 0xFFFF;     ///< Text background, equal to textcolor for none
+  uint8_t textdatum = TL_DATUM;      ///< Reference point of drawString()
+  uint8_t textfont = 1;              ///< Numbered font, 1 for the free font
+  const GFXfont* gfxFont = nullptr;  ///< Free font or nullptr
+
+ private:
+  /**
+   * @brief Metrics of the font drawString() and textWidth() use
+   */
+  const GFXfont& metrics(uint8_t font) const;
+
+  /**
+   * @brief Draw one block glyph into its cell, run by run from its bitmap
+   */
+  void drawGlyph(char c, int32_t x, int32_t y, const GFXfont& m, uint16_t color);
+
+  /**
+   * @brief Write pixels into the window and advance its cursor
+   */
+  void windowWrite(const uint16_t* colors, uint16_t fill, uint32_t len);
+
+  /**
+   * @brief Count a window of w x h pixels on the bus
+   */
+  void countWindow(int64_t pixels);
+
+  std::vector<uint16_t> panel;     ///< RGB565 pixels of the panel
+  TFTBusStats bus = {};            ///< Bus counters
+  int32_t winX0 = 0, winY0 = 0;    ///< Top left of the address window
+  int32_t winX1 = -1, winY1 = -1;  ///< Bottom right of the address window
+  int32_t winX = 0, winY = 0;      ///< Write position in the window
+};
+
+/**
+ * @brief Off-screen drawing buffer
+ */
+class TFT_eSprite : public TFT_eSPI {
+ public:
+  explicit TFT_eSprite(TFT_eSPI* tft);
+  ~TFT_eSprite() { deleteSprite(); }
+
+  void* createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite();
+  bool created() { return buffer != nullptr; }
+  void* getPointer() { return buffer; }
+  void* setColorDepth(int8_t b);
+  int8_t getColorDepth() { return bpp; }
+
+  void createPalette(uint16_t* colorMap = nullptr, uint8_t colors = 16);
+  void createPalette(const uint16_t* colorMap, uint8_t colors = 16) { createPalette((uint16_t*)colorMap, colors); }
+  void setPaletteColor(uint8_t index, uint16_t color) { palette[index & 0x0F] = color; }
+  uint16_t getPaletteColor(uint8_t index) { return palette[index & 0x0F]; }
+  void setBitmapColor(uint16_t fg, uint16_t bg) {
+    bitmapFg = fg;
+    bitmapBg = bg;
+  }
+
+  void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  void setScrollRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color = TFT_BLACK);
+  void scroll(int16_t dx, int16_t dy = 0);
+
+  void pushSprite(int32_t x, int32_t y);
+  bool pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
+  bool pushToSprite(TFT_eSprite* dspr, int32_t x, int32_t y);
+
+  void drawPixel(int32_t x, int32_t y, uint32_t color) override;
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) override;
+  uint16_t readPixel(int32_t x, int32_t y) override;
+
+  /**
+   * @brief Raw value of a pixel: color word, RGB332, palette index or bit
+   */
+  uint16_t readPixelValue(int32_t x, int32_t y);
+
+ private:
+  /**
+   * @brief Store a color at a pixel inside the sprite
+   */
+  void writeValue(int32_t x, int32_t y, uint16_t color);
+
+  /**
+   * @brief Send part of the sprite to the parent as RGB565 rows
+   */
+  void pushRegion(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
+
+  TFT_eSPI* parent;                  ///< Display the sprite is pushed to
+  uint8_t* buffer = nullptr;         ///< Pixel buffer in the layout of the library
+  int8_t bpp = 16;                   ///< Color depth
+  int32_t bitwidth = 0;              ///< Row length in bits of a 1-bit sprite
+  uint16_t palette[16];              ///< Colors of a 4-bit sprite
+  uint16_t bitmapFg = TFT_WHITE;     ///< Color of set bits
+  uint16_t bitmapBg = TFT_BLACK;     ///< Color of cleared bits
+  int32_t scrollX = 0, scrollY = 0;  ///< Top left of the scroll window
+  int32_t scrollW = 0, scrollH = 0;  ///< Size of the scroll window, 0 for the whole sprite
+  uint16_t scrollColor = TFT_BLACK;  ///< Color of the area scrolled in
+};
+
+#endif  // TFT_ESPI_HOST_H
@@ -0,0 +1,8 @@
+/**
+ * @file Wire.cpp
+ * @brief The I2C bus object of the host build
+ */
+
+#include <Wire.h>
+
+TwoWire Wire;
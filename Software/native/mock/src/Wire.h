@@ -0,0 +1,36 @@
+/**
+ * @file Wire.h
+ * @brief Host stand-in for the I2C bus
+ *
+ * The sensor stand-ins do not talk over it, begin() only records the pins.
+ */
+
+#ifndef WIRE_HOST_H
+#define WIRE_HOST_H
+
+#include <Arduino.h>
+
+/**
+ * @brief I2C controller
+ */
+class TwoWire {
+ public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+    sdaPin = sda;
+    sclPin = scl;
+    (void)frequency;
+    return true;
+  }
+  bool setClock(uint32_t frequency) {
+    (void)frequency;
+    return true;
+  }
+
+ private:
+  int sdaPin = -1;  ///< SDA pin of the last begin()
+  int sclPin = -1;  ///< SCL pin of the last begin()
+};
+
+extern TwoWire Wire;
+
+#endif  // WIRE_HOST_H
@@ -0,0 +1,28 @@
+/**
+ * @file task.h
+ * @brief Host stand-in for the FreeRTOS task API
+ *
+ * Tasks run as coroutines on the thread of setup() and loop(). A task runs
+ * until it blocks in vTaskDelay() or ulTaskNotifyTake() and is resumed by
+ * hostAdvanceMicros() or hostRunTasks() once it is due. Core and priority
+ * are ignored; a task that never blocks stalls the host build.
+ */
+
+#ifndef FREERTOS_TASK_HOST_H
+#define FREERTOS_TASK_HOST_H
+
+#include <freertos/FreeRTOS.h>
+#include <stdint.h>
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* createdTask, BaseType_t coreId);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+
+#endif  // FREERTOS_TASK_HOST_H
@@ -0,0 +1,243 @@
+/**
+ * @file host.cpp
+ * @brief Virtual clock, task scheduler and pin table of the host build
+ *
+ * Tasks are ucontext coroutines with their own stack. The scheduler runs
+ * on the thread of setup() and loop() (the "loop task") and switches into
+ * a task only from hostRunTasks(); the task switches back when it blocks.
+ * So there is never more than one thread and no locking is needed.
+ */
+
+#include <Arduino.h>
+#include <host.h>
+#include <ucontext.h>
+
+#include <vector>
+
+/// Stack of a host task; printf and the sanitizers need more than the target
+#define HOST_TASK_STACK (256 * 1024)
+
+/**
+ * @brief State of one task
+ */
+struct HostTask {
+  TaskFunction_t code;  ///< Task function
+  void* parameters;     ///< Argument of the task function
+  const char* name;     ///< Task name
+  ucontext_t context;   ///< Saved registers while switched out
+  uint8_t* stack;       ///< Coroutine stack
+  uint64_t wakeUs;      ///< Virtual time the task becomes due
+  bool waitsNotify;     ///< Blocked in ulTaskNotifyTake(), wakeUs is the timeout
+  uint32_t notified;    ///< Notification count
+  bool finished;        ///< Task function returned
+};
+
+static uint64_t nowUs = 0;            ///< Virtual clock
+static std::vector<HostTask*> tasks;  ///< All tasks in creation order
+static HostTask* running = nullptr;   ///< Task being executed, nullptr in the loop task
+static ucontext_t schedulerContext;   ///< Loop task while a task runs
+
+static uint8_t pinLevel[HOST_NUM_PINS];          ///< Input and output levels
+static void (*pinHandler[HOST_NUM_PINS])(void);  ///< Attached interrupts
+static int pinEdge[HOST_NUM_PINS];               ///< Mode of the attached interrupts
+
+/**
+ * @brief Start of every task coroutine
+ */
+static void taskEntry() {
+  running->code(running->parameters);
+  running->finished = true;  ///< uc_link returns to the scheduler
+}
+
+/**
+ * @brief Check whether a task can run now
+ */
+static bool taskDue(const HostTask* task) {
+  if (task->finished) return false;
+  if (task->waitsNotify && task->notified > 0) return true;
+  return task->wakeUs <= nowUs;
+}
+
+/**
+ * @brief Switch from a task back to the scheduler until it is due again
+ */
+static void taskBlock(uint64_t wakeUs) {
+  HostTask* self = running;
+  self->wakeUs = wakeUs;
+  swapcontext(&self->context, &schedulerContext);
+}
+
+uint64_t hostMicros() {
+  return nowUs;
+}
+
+void hostRunTasks() {
+  if (running) return;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    HostTask* task = tasks[i];
+    if (!taskDue(task)) continue;
+    running = task;
+    swapcontext(&schedulerContext, &task->context);
+    running = nullptr;
+  }
+}
+
+void hostAdvanceMicros(uint64_t us) {
+  uint64_t target = nowUs + us;
+  if (running) {
+    nowUs = target;
+    return;
+  }
+
+  for (;;) {
+    uint64_t next = UINT64_MAX;
+    for (const HostTask* task : tasks) {
+      if (taskDue(task)) next = nowUs;  ///< Notified while blocked
+      if (!task->finished && task->wakeUs < next) next = task->wakeUs;
+    }
+    if (next > target) break;
+    if (next > nowUs) nowUs = next;
+    hostRunTasks();
+  }
+  nowUs = target;
+}
+
+void hostSkipMicros(uint64_t us) {
+  nowUs += us;
+}
+
+int hostTaskCount() {
+  return tasks.size();
+}
+
+void hostSetPin(uint8_t pin, int level) {
+  if (pin >= HOST_NUM_PINS) return;
+  uint8_t old = pinLevel[pin];
+  pinLevel[pin] = level ? HIGH : LOW;
+  if (!pinHandler[pin]) return;
+
+  bool fire = false;
+  switch (pinEdge[pin]) {
+    case RISING:
+      fire = old == LOW && pinLevel[pin] == HIGH;
+      break;
+    case FALLING:
+      fire = old == HIGH && pinLevel[pin] == LOW;
+      break;
+    case CHANGE:
+      fire = old != pinLevel[pin];
+      break;
+    case ONLOW:
+      fire = pinLevel[pin] == LOW;
+      break;
+    case ONHIGH:
+      fire = pinLevel[pin] == HIGH;
+      break;
+  }
+  if (fire) pinHandler[pin]();
+}
+
+unsigned long millis() {
+  return (uint32_t)(nowUs / 1000);
+}
+
+unsigned long micros() {
+  return (uint32_t)nowUs;
+}
+
+void delay(uint32_t ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  hostAdvanceMicros(us);  ///< Busy wait on the target, no task switch
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= HOST_NUM_PINS) return;
+  if (mode == INPUT_PULLUP) pinLevel[pin] = HIGH;
+  if (mode == INPUT_PULLDOWN) pinLevel[pin] = LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < HOST_NUM_PINS) pinLevel[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < HOST_NUM_PINS ? pinLevel[pin] : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+  if (pin >= HOST_NUM_PINS) return;
+  pinHandler[pin] = handler;
+  pinEdge[pin] = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < HOST_NUM_PINS) pinHandler[pin] = nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* createdTask, BaseType_t coreId) {
+  (void)stackDepth;
+  (void)priority;
+  (void)coreId;
+
+  HostTask* task = new HostTask();
+  task->code = code;
+  task->parameters = parameters;
+  task->name = name;
+  task->stack = (uint8_t*)malloc(HOST_TASK_STACK);
+  task->wakeUs = nowUs;  ///< Runs on the next scheduler pass
+  if (!task->stack || getcontext(&task->context) != 0) {
+    free(task->stack);
+    delete task;
+    return pdFAIL;
+  }
+  task->context.uc_stack.ss_sp = task->stack;
+  task->context.uc_stack.ss_size = HOST_TASK_STACK;
+  task->context.uc_link = &schedulerContext;
+  makecontext(&task->context, taskEntry, 0);
+
+  tasks.push_back(task);
+  if (createdTask) *createdTask = task;
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  uint64_t us = (uint64_t)ticks * 1000000 / configTICK_RATE_HZ;
+  if (running) {
+    taskBlock(nowUs + us);
+  } else {
+    hostAdvanceMicros(us);  ///< The loop task sleeps, the others run meanwhile
+  }
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(nowUs * configTICK_RATE_HZ / 1000000);
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  if (task) task->notified++;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  HostTask* self = running;
+  if (self && self->notified == 0 && ticksToWait > 0) {
+    self->waitsNotify = true;
+    taskBlock(ticksToWait == portMAX_DELAY ? UINT64_MAX : nowUs + (uint64_t)ticksToWait * 1000000 / configTICK_RATE_HZ);
+    self->waitsNotify = false;
+  }
+  if (!self) return 0;
+
+  uint32_t count = self->notified;
+  if (clearCountOnExit) {
+    self->notified = 0;
+  } else if (count > 0) {
+    self->notified--;
+  }
+  return count;
+}
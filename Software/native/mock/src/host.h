@@ -0,0 +1,82 @@
+/**
+ * @file host.h
+ * @brief Controls of the host build that the firmware itself never uses
+ *
+ * Contains:
+ * - The virtual clock behind millis(), micros() and delay()
+ * - Stepping of the FreeRTOS tasks, which run as coroutines on the host
+ * - Levels of the input pins, which fire the attached interrupts
+ * - Where Serial output goes and where LittleFS keeps its files
+ *
+ * Nothing runs on its own: time only moves when the harness or the
+ * firmware (delay(), vTaskDelay()) moves it, and a task only runs when the
+ * clock reaches its wake time. The same inputs therefore always give the
+ * same frames, which is what profiling and replays need.
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/// Number of GPIOs of the ESP32-S3
+#define HOST_NUM_PINS 49
+
+/**
+ * @brief Current time of the virtual clock in microseconds
+ */
+uint64_t hostMicros();
+
+/**
+ * @brief Move the virtual clock forward
+ * @param us Microseconds to advance
+ *
+ * Tasks that become due on the way run at their wake time, in creation
+ * order. Called from inside a task the clock only moves, nothing else runs.
+ */
+void hostAdvanceMicros(uint64_t us);
+
+/**
+ * @brief Move the virtual clock forward without running any task
+ * @param us Microseconds to skip
+ *
+ * For harnesses that call the task functions themselves, e.g. to feed a
+ * week of history ticks without the millions of idle sensor passes in
+ * between. Tasks that became due run on the next hostAdvanceMicros().
+ */
+void hostSkipMicros(uint64_t us);
+
+/**
+ * @brief Run every task that is due at the current time once
+ */
+void hostRunTasks();
+
+/**
+ * @brief Number of tasks created with xTaskCreatePinnedToCore()
+ */
+int hostTaskCount();
+
+/**
+ * @brief Drive an input pin
+ * @param pin GPIO number
+ * @param level LOW or HIGH
+ *
+ * An interrupt attached to the pin is called right away if the edge
+ * matches its mode.
+ */
+void hostSetPin(uint8_t pin, int level);
+
+/**
+ * @brief Redirect the output of Serial
+ * @param out Stream to write to, nullptr to drop the output
+ */
+void hostSerialOutput(FILE* out);
+
+/**
+ * @brief Set the directory that holds the LittleFS partition
+ * @param dir Host directory, created by LittleFS.begin()
+ */
+void hostFsRoot(const char* dir);
+
+#endif  // HOST_H
@@ -0,0 +1,89 @@
+/**
+ * @file host_main.cpp
+ * @brief Entry point of the host build in place of the Arduino core
+ *
+ * Calls setup() once and then loop() until the virtual clock reaches the
+ * end of the run. Every loop() pass takes --loop-us of virtual time, the
+ * tasks run in between when they are due. Options:
+ *   --seconds=N        Virtual run time in seconds (default 60)
+ *   --loop-us=N        Virtual time of one loop() pass (default 1000)
+ *   --fs=DIR           Directory behind LittleFS (default littlefs)
+ *   --screenshot=FILE  Write the panel as binary PPM at the end
+ *   --quiet            Drop the Serial output
+ *   --no-sensors       No sensor answers, the firmware runs its demo mode
+ * At the end the loop and bus counters are printed to stderr.
+ *
+ * main() is weak, so a benchmark or test that brings its own wins.
+ */
+
+#include <Adafruit_BME680.h>
+#include <Adafruit_LTR390.h>
+#include <Adafruit_VCNL4040.h>
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <host.h>
+
+void setup();
+void loop();
+
+/**
+ * @brief Value of an option of the form --name=value
+ * @return nullptr if arg is a different option
+ */
+static const char* option(const char* arg, const char* name) {
+  size_t len = strlen(name);
+  return strncmp(arg, name, len) == 0 && arg[len] == '=' ? arg + len + 1 : nullptr;
+}
+
+extern TFT_eSPI tft;
+extern Adafruit_BME680 bme;
+extern Adafruit_LTR390 ltr;
+extern Adafruit_VCNL4040 vcnl;
+
+__attribute__((weak)) int main(int argc, char** argv) {
+  double seconds = 60;
+  uint64_t loopUs = 1000;
+  const char* screenshot = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value;
+    if ((value = option(argv[i], "--seconds"))) {
+      seconds = atof(value);
+    } else if ((value = option(argv[i], "--loop-us"))) {
+      loopUs = strtoull(value, nullptr, 10);
+    } else if ((value = option(argv[i], "--fs"))) {
+      hostFsRoot(value);
+    } else if ((value = option(argv[i], "--screenshot"))) {
+      screenshot = value;
+    } else if (strcmp(argv[i], "--quiet") == 0) {
+      hostSerialOutput(nullptr);
+    } else if (strcmp(argv[i], "--no-sensors") == 0) {
+      bme.hostPresent = false;
+      ltr.hostPresent = false;
+      vcnl.hostPresent = false;
+    } else {
+      fprintf(stderr, "usage: %s [--seconds=N] [--loop-us=N] [--fs=DIR] [--screenshot=FILE] [--quiet] [--no-sensors]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  setup();
+  uint64_t end = hostMicros() + (uint64_t)(seconds * 1e6);
+  uint64_t passes = 0;
+  while (hostMicros() < end) {
+    loop();
+    hostAdvanceMicros(loopUs);
+    passes++;
+  }
+  Serial.flush();
+
+  const TFTBusStats& bus = tft.hostBus();
+  fprintf(stderr, "%llu loop passes, %.1f s virtual, %d tasks\n", (unsigned long long)passes, hostMicros() / 1e6, hostTaskCount());
+  fprintf(stderr, "bus: %llu bytes, %llu pixels, %lu windows\n", (unsigned long long)bus.bytes, (unsigned long long)bus.pixels,
+          (unsigned long)bus.windows);
+  if (screenshot && !tft.hostSavePpm(screenshot)) {
+    fprintf(stderr, "cannot write %s\n", screenshot);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file ledc.cpp
+ * @brief Duty bookkeeping of the host LEDC driver
+ */
+
+#include <driver/ledc.h>
+
+static uint32_t duty[LEDC_CHANNEL_MAX];     ///< Duty of each channel
+static uint32_t pending[LEDC_CHANNEL_MAX];  ///< Duty set but not yet applied
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* timer_conf) {
+  return timer_conf ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* ledc_conf) {
+  if (!ledc_conf || ledc_conf->channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  duty[ledc_conf->channel] = pending[ledc_conf->channel] = ledc_conf->duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+  (void)intr_alloc_flags;
+  return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty, int max_fade_time_ms) {
+  (void)max_fade_time_ms;
+  return ledc_set_duty(speed_mode, channel, target_duty);
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode) {
+  (void)fade_mode;
+  return ledc_update_duty(speed_mode, channel);
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty) {
+  (void)speed_mode;
+  if (channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  pending[channel] = target_duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+  (void)speed_mode;
+  if (channel >= LEDC_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+  duty[channel] = pending[channel];
+  return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+  (void)speed_mode;
+  return channel < LEDC_CHANNEL_MAX ? duty[channel] : 0;
+}
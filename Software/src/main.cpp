@@ -14,9 +14,19 @@
 #include <TFT_Touch.h>
 #include <TFT_eSPI.h>
 #include <Wire.h>
+#include <archive.h>
+#include <backlight.h>
+#include <compositor.h>
 #include <config.h>
+#include <display.h>
+#include <graph.h>
+#include <histlog.h>
 #include <logo.h>
 #include <methods.h>
+#include <sprites.h>
+#include <synthetic.h>
+#include <touch.h>
+#include <trace.h>
 
 /// TFT display instance
 TFT_eSPI tft = TFT_eSPI();
@@ -33,12 +43,10 @@ int currentPage = 0;
 /// Index of selected box (-1 if none)
 int selectedBox = -1;
 
-/// Flag to detect touch release
-bool touchReleased = true;
-
 /// Last value drawn on detail page to avoid flicker
-float lastDetailValue = -9999;
+float lastDetailValue = NAN;
 extern bool detailGraphNeedsRedraw;
+extern int detailTier;
 
 /// Sensor availability flags
 bool bme_ok = false;
@@ -50,15 +58,17 @@ Adafruit_BME680 bme;
 Adafruit_LTR390 ltr;
 Adafruit_VCNL4040 vcnl;
 
+/// Weather shown when no sensor answers
+SyntheticWeather demoWeather;
+
 /**
  * @brief Setup function to initialize hardware and sensors
  */
 void setup() {
   Serial.begin(115200);
 
-  ///< Configure backlight pin and set full brightness initially
-  pinMode(LED_PWM, OUTPUT);
-  analogWrite(LED_PWM, 100);  ///< Full backlight on
+  ///< Configure backlight LEDC channel and switch it on
+  backlightBegin();
 
   Wire.begin(SDA, SCL);
 
@@ -73,77 +83,120 @@ void setup() {
 
   if (bme_ok || vcnl_ok || ltr_ok) {
     configureSensors(bme_ok, vcnl_ok, ltr_ok);
-  } else {
+  } else if (sensorSourceInUse() == nullptr) {
     Serial.println("No sensors initialized, running demo mode");
+    setSensorSource(&demoWeather);
   }
 
   ///< Initialize history buffers and read initial values
   initHistory();
+  Serial.printf("%lu history ticks restored from flash\n", (unsigned long)historyLogBegin());
+  if (!archiveBegin()) Serial.println("No PSRAM, long-term archive disabled");
+  traceBegin();  ///< Record the raw readings if SENSOR_TRACE is set
 
-  ///< Perform initial sensor reading
+  ///< Wait until every sensor job has run once, so the first history tick has all channels
   updateValues();
+  while (sensorsPending()) {
+    delay(5);
+    updateValues();
+  }
 
+  syncValues();
   for (int i = 0; i < NUM_BOXES; i++) updateHistory(i, *boxes[i].value);
   detailGraphNeedsRedraw = true;  // Force initial graph draw
 
   tft.begin();                                                               ///< Initialize TFT display
   tft.setRotation(1);                                                        ///< Set display rotation
+  displayBegin();                                                            ///< Draw into a PSRAM framebuffer if available
   touch.setRotation(1);                                                      ///< Initialize touch controller
   touch.setCal(XMIN, XMAX, YMIN, YMAX, SCREEN_WIDTH, SCREEN_HEIGHT, false);  ///< Calibrate touch controller
-  tft.fillScreen(COLOR_BACKGROUND);                                          ///< Clear screen and draw initial layout
+  touchBegin();                                                              ///< Attach pen interrupt
+  canvas().fillScreen(COLOR_BACKGROUND);                                     ///< Clear screen and draw initial layout
+  displayMarkDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);                       ///< Whole screen is sent with the first flush
   layoutBoxes();                                                             ///< Layout boxes on screen
+  initSpritePool();                                                          ///< Allocate all sprites once
+  Serial.printf("Sprites: %lu bytes, %lu of them for the detail page\n", (unsigned long)spritePoolStats().bytes,
+                (unsigned long)spritePoolStats().detailBytes);
+  initValueGlyphs();                                                         ///< Pre-render value characters
+  initBoxWidgets();                                                          ///< Box values are drawn by the compositor
   drawLogo();                                                                ///< Draw logo in center
 
   for (int i = 0; i < NUM_BOXES; i++) drawBox(i);  ///< Draw all boxes
+  invalidateValues();                               ///< Draw every value on the first pass
+
+  startSensorTask();  ///< Sensor acquisition continues on the other core
 }
 
 /**
- * @brief Main loop to update sensor readings and handle user interaction
+ * @brief Handle a debounced touch press
+ * @param tx X position on screen
+ * @param ty Y position on screen
+ *
+ * On the main page a press on a box opens its detail page. On the detail
+ * page a press on the graph switches to the next history view, any other
+ * press returns to the main page.
+ */
+static void handlePress(int tx, int ty) {
+  if (currentPage == 0) {
+    ///< Check which box is touched
+    for (int i = 0; i < NUM_BOXES; i++) {
+      if (tx > boxes[i].x && tx < boxes[i].x + boxes[i].w &&
+          ty > boxes[i].y && ty < boxes[i].y + boxes[i].h) {
+        selectedBox = i;
+        currentPage = 1;
+        lastDetailValue = NAN;
+        detailGraphNeedsRedraw = true;
+        detailTier = TIER_RAW;
+        displaySave(SCREEN_MAIN);  ///< Keep the main page for an instant return
+        drawDetailPageTitle(selectedBox);
+        break;
+      }
+    }
+  } else if (currentPage == 1 && detailGraphHit(tx, ty)) {
+    detailTier = (detailTier + 1) % NUM_GRAPH_VIEWS;
+    detailGraphNeedsRedraw = true;
+  } else if (currentPage == 1) {
+    currentPage = 0;
+    selectedBox = -1;
+    detailGraphNeedsRedraw = false;
+    drawMainPage();  ///< Changed values are redrawn by updateValue()
+  }
+}
+
+/**
+ * @brief Main loop (UI task) to show sensor readings and handle user interaction
  */
 void loop() {
-  updateValues();  ///< Update all sensor values
+  ///< Take over the newest snapshot from the sensor task and adapt the backlight
+  if (syncValues()) updateBacklight(displayValues.ambient, displayValues.ambientTick, displayValues.proximity, millis());
+
+  pollTouch();  ///< Sample the touch panel only while the pen is down
+
+  ///< Consume queued touch events
+  TouchEvent event;
+  while (nextTouchEvent(event)) {
+    backlightActivity(event.time);
+    if (event.type == TOUCH_PRESS) handlePress(event.x, event.y);
+  }
 
   if (currentPage == 0) {
-    ///< Main page – update all boxes
+    ///< Main page – mark changed boxes and draw them in one frame
     for (int i = 0; i < NUM_BOXES; i++) updateValue(i);
-
-    ///< Detect touch to select box
-    if (touch.Pressed() && touchReleased) {
-      touchReleased = false;
-      int tx = touch.X();
-      int ty = touch.Y();
-
-      ///< Check which box is touched
-      for (int i = 0; i < NUM_BOXES; i++) {
-        if (tx > boxes[i].x && tx < boxes[i].x + boxes[i].w &&
-            ty > boxes[i].y && ty < boxes[i].y + boxes[i].h) {
-          selectedBox = i;
-          currentPage = 1;
-          lastDetailValue = -9999;
-          detailGraphNeedsRedraw = true;
-          drawDetailPageTitle(selectedBox);
-          break;
-        }
-      }
-    }
-    if (!touch.Pressed()) touchReleased = true;
+    composeFrame(millis());
   } else if (currentPage == 1 && selectedBox >= 0) {
     drawDetailPageWithSprite(selectedBox);  ///< Detail page – update value using sprite
+  }
 
-    ///< Detect touch to return to main page
-    if (touch.Pressed() && touchReleased) {
-      touchReleased = false;
-      currentPage = 0;
-      selectedBox = -1;
-      detailGraphNeedsRedraw = false;
-
-      ///< Redraw main screen layout
-      tft.fillScreen(COLOR_BACKGROUND);
-      layoutBoxes();
-      drawLogo();
-      for (int i = 0; i < NUM_BOXES; i++) drawBox(i);
-    }
-
-    if (!touch.Pressed()) touchReleased = true;
+  displayFlush();  ///< Hand the changed region to the DMA transfer
+
+  ///< Frame and bus statistics
+  static uint32_t lastReport = 0;
+  if (millis() - lastReport >= COMPOSITOR_REPORT_INTERVAL) {
+    lastReport = millis();
+    compositorReport(Serial);
+    boxReport(Serial);
+    archiveReport(Serial);
+    historyLogReport(Serial);
+    traceReport(Serial);
   }
-}
\ No newline at end of file
+}
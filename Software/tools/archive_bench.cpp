@@ -0,0 +1,151 @@
+/**
+ * @file archive_bench.cpp
+ * @brief Host benchmark of the compressed archive
+ *
+ * Reads a recording of history ticks, appends it to an ArchiveStore the same
+ * way the firmware does (values rounded to the history resolution) and
+ * reports compression ratio, retention of the configured archive and
+ * decode throughput. Every decoded row is compared with the input, and the
+ * ranges kept in the blocks with the minimum and maximum of the rows.
+ *
+ * Input is a CSV file with one row per history tick:
+ *   seconds,temp,humid,pressure,ambient,white,gas,uv,uvIndex
+ * Lines that do not start with a digit are skipped. Without a file a
+ * week of the synthetic weather of the demo mode is used, its numbers are
+ * only a rough guide.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -Inative/mock/src -Ilib/config -Ilib/history -Ilib/archive -Ilib/source -Ilib/synthetic \
+ *       tools/archive_bench.cpp lib/archive/archive.cpp lib/history/history.cpp lib/synthetic/synthetic.cpp -o archive_bench
+ *   ./archive_bench recording.csv
+ */
+
+#include <archive.h>
+#include <history.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <synthetic.h>
+
+#include <chrono>
+#include <vector>
+
+/**
+ * @brief Read a CSV recording
+ * @return false if the file cannot be opened
+ */
+static bool readCsv(const char* path, std::vector<ArchiveRow>& rows) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+
+  char line[512];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] < '0' || line[0] > '9') continue;
+    ArchiveRow row;
+    char* p = line;
+    row.time = strtoul(p, &p, 10);
+    for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+      if (*p == ',') p++;
+      row.values[c] = strtof(p, &p);
+    }
+    rows.push_back(row);
+  }
+  fclose(f);
+  return true;
+}
+
+/**
+ * @brief Generate a week of readings from the synthetic weather of the demo mode
+ */
+static void synthesize(std::vector<ArchiveRow>& rows) {
+  SyntheticConfig config;
+  config.timeScale = 1;  ///< millis() counts simulated time
+  SyntheticWeather weather(config);
+  for (uint32_t t = 0; t < 7 * 24 * 3600; t += HISTORY_UPDATE_INTERVAL / 1000) {
+    ArchiveRow row;
+    row.time = t;
+    weather.boxValues(t * 1000, row.values);
+    rows.push_back(row);
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<ArchiveRow> input;
+  if (argc > 1) {
+    if (!readCsv(argv[1], input)) {
+      fprintf(stderr, "%s: cannot open\n", argv[1]);
+      return 1;
+    }
+    printf("Recording %s: %zu rows\n", argv[1], input.size());
+  } else {
+    synthesize(input);
+    printf("Synthetic week: %zu rows\n", input.size());
+  }
+  if (input.empty()) return 1;
+
+  ///< Round like syncValues() does before archiving
+  for (ArchiveRow& row : input) {
+    for (int c = 0; c < ARCHIVE_CHANNELS; c++) row.values[c] = historyRound(c, row.values[c]);
+  }
+
+  ///< Enough blocks for the whole input, so nothing is dropped
+  uint32_t blocks = input.size() * sizeof(ArchiveRow) / ARCHIVE_BLOCK_BYTES + 2;
+  std::vector<ArchiveBlock> pool(blocks);
+  ArchiveStore store;
+  store.begin(pool.data(), blocks);
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (const ArchiveRow& row : input) store.append(row.time, row.values);
+  auto t1 = std::chrono::steady_clock::now();
+
+  ///< Verify once, then time repeated decodes
+  ArchiveReader check(store);
+  ArchiveRow row;
+  size_t n = 0, mismatches = 0;
+  float minimum[ARCHIVE_CHANNELS], maximum[ARCHIVE_CHANNELS];
+  bool valid[ARCHIVE_CHANNELS] = {};
+  while (check.next(row)) {
+    if (row.time != input[n].time || memcmp(row.values, input[n].values, sizeof(row.values)) != 0) mismatches++;
+    for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+      if (isnan(row.values[c])) continue;
+      if (!valid[c] || row.values[c] < minimum[c]) minimum[c] = row.values[c];
+      if (!valid[c] || row.values[c] > maximum[c]) maximum[c] = row.values[c];
+      valid[c] = true;
+    }
+    n++;
+  }
+
+  ///< The ranges kept in the blocks match the decoded rows
+  size_t rangeMismatches = 0;
+  for (int c = 0; c < ARCHIVE_CHANNELS; c++) {
+    float low, high;
+    bool found = archiveMinMax(store, c, low, high);
+    if (found != valid[c] || (found && (low != minimum[c] || high != maximum[c]))) rangeMismatches++;
+  }
+
+  const int passes = 20;
+  float sink = 0;
+  auto t2 = std::chrono::steady_clock::now();
+  for (int p = 0; p < passes; p++) {
+    ArchiveReader reader(store);
+    while (reader.next(row)) sink += row.values[0];
+  }
+  auto t3 = std::chrono::steady_clock::now();
+
+  double rawBytes = input.size() * (double)(sizeof(uint32_t) + ARCHIVE_CHANNELS * sizeof(float));
+  double usedBytes = store.bytesUsed();
+  double encodeS = std::chrono::duration<double>(t1 - t0).count();
+  double decodeS = std::chrono::duration<double>(t3 - t2).count() / passes;
+  double rowsPerBlock = (double)input.size() / store.blockCount();
+  double retentionDays = rowsPerBlock * ARCHIVE_BLOCKS * (HISTORY_UPDATE_INTERVAL / 1000) / 86400.0;
+
+  printf("Decoded %zu rows, %zu mismatches%s\n", n, mismatches, n == input.size() ? "" : " (row count differs)");
+  printf("Block ranges: %zu of %d channels differ from the decoded rows\n", rangeMismatches, ARCHIVE_CHANNELS);
+  printf("Raw %.0f bytes, archived %.0f bytes in %u blocks: ratio %.2fx, %.1f bits/row\n",
+         rawBytes, usedBytes, store.blockCount(), rawBytes / usedBytes, usedBytes * 8 / input.size());
+  printf("Retention of %u blocks of %u bytes: %.0f days\n", ARCHIVE_BLOCKS, ARCHIVE_BLOCK_BYTES, retentionDays);
+  printf("Encode %.0f ns/row, decode %.0f ns/row (%.1f MB/s of raw rows)\n",
+         encodeS * 1e9 / input.size(), decodeS * 1e9 / input.size(), rawBytes / decodeS / 1e6);
+  return (mismatches > 0 || rangeMismatches > 0 || n != input.size() || isnan(sink)) ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file backlight_check.cpp
+ * @brief Host check of the backlight control law, filter and update rate
+ *
+ * Checks backlightTarget() at the ends and the middle of its square-root
+ * curve, its monotony, the hand boost and the idle dimming, and the step
+ * response of filterAmbient() against (1 - BACKLIGHT_FILTER_ALPHA)^n. The
+ * last check feeds updateBacklight() at the snapshot rate with a new
+ * ambient reading only every few calls, as the sensor task does, and
+ * reads the duty back from the LEDC stand-in: the filter has to take one
+ * step per reading, not per call. The exit code is 1 on a failed check.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src -Ilib/config -Ilib/backlight \
+ *       tools/backlight_check.cpp lib/backlight/backlight.cpp native/mock/src/ledc.cpp native/mock/src/Arduino.cpp native/mock/src/host.cpp \
+ *       -o backlight_check
+ *   ./backlight_check
+ */
+
+#include <Arduino.h>
+#include <backlight.h>
+#include <config.h>
+#include <driver/ledc.h>
+#include <host.h>
+#include <math.h>
+#include <stdio.h>
+
+/// Snapshots per ambient reading, about 13 Hz against one reading per AMBIENT_UPDATE_INTERVAL
+#define CALLS_PER_READING 6
+
+/// Time between two snapshots in milliseconds
+#define CALL_INTERVAL 80
+
+static int failures = 0;  ///< Failed checks so far
+
+/// Count and print a failed check
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+/**
+ * @brief Duty of the control law, computed independently in double
+ */
+static int expectedDuty(double ambient) {
+  double level = fmin(fmax(ambient / MAX_AMBIENT_LIGHT, 0.0), 1.0);
+  return MIN_PWM + (int)floor((MAX_PWM - MIN_PWM) * sqrt(level) + 0.5);
+}
+
+/**
+ * @brief The control law
+ */
+static void checkTarget() {
+  CHECK(backlightTarget(0, false, 0) == MIN_PWM, "dark room gives %u", backlightTarget(0, false, 0));
+  CHECK(backlightTarget(-5, false, 0) == MIN_PWM, "negative light gives %u", backlightTarget(-5, false, 0));
+  CHECK(backlightTarget(MAX_AMBIENT_LIGHT, false, 0) == MAX_PWM, "full light gives %u", backlightTarget(MAX_AMBIENT_LIGHT, false, 0));
+  CHECK(backlightTarget(10 * MAX_AMBIENT_LIGHT, false, 0) == MAX_PWM, "light above the range gives %u", backlightTarget(10 * MAX_AMBIENT_LIGHT, false, 0));
+
+  ///< A quarter of the range is half the span on the square-root curve
+  int quarter = backlightTarget(MAX_AMBIENT_LIGHT / 4.0F, false, 0);
+  CHECK(quarter == MIN_PWM + (MAX_PWM - MIN_PWM) / 2, "a quarter of the light gives %d", quarter);
+
+  int last = 0;
+  for (int lux = 0; lux <= MAX_AMBIENT_LIGHT; lux += 7) {
+    int duty = backlightTarget(lux, false, 0);
+    CHECK(duty == expectedDuty(lux), "%d lux gives %d, expected %d", lux, duty, expectedDuty(lux));
+    CHECK(duty >= last, "duty falls from %d to %d at %d lux", last, duty, lux);
+    last = duty;
+  }
+
+  ///< A hand wins over everything, idling dims below MIN_PWM
+  CHECK(backlightTarget(0, true, BACKLIGHT_IDLE_TIMEOUT * 2) == MAX_PWM, "hand near while idle gives %u", backlightTarget(0, true, BACKLIGHT_IDLE_TIMEOUT * 2));
+  CHECK(backlightTarget(MAX_AMBIENT_LIGHT, false, BACKLIGHT_IDLE_TIMEOUT) == BACKLIGHT_IDLE_PWM, "idle gives %u",
+        backlightTarget(MAX_AMBIENT_LIGHT, false, BACKLIGHT_IDLE_TIMEOUT));
+  CHECK(backlightTarget(0, false, BACKLIGHT_IDLE_TIMEOUT) == BACKLIGHT_IDLE_PWM, "idle in the dark gives %u", backlightTarget(0, false, BACKLIGHT_IDLE_TIMEOUT));
+  CHECK(backlightTarget(MAX_AMBIENT_LIGHT, false, BACKLIGHT_IDLE_TIMEOUT - 1) == MAX_PWM, "dimmed before the timeout");
+}
+
+/**
+ * @brief Step response of the ambient filter
+ */
+static void checkFilter() {
+  float filtered = 0;
+  for (int n = 1; n <= 30; n++) {
+    filtered = filterAmbient(filtered, 1000);
+    double expected = 1000 * (1 - pow(1 - BACKLIGHT_FILTER_ALPHA, n));
+    CHECK(fabs(filtered - expected) < 0.01, "step response %.3f after %d samples, expected %.3f", filtered, n, expected);
+  }
+  CHECK(filterAmbient(250, 250) == 250, "a settled filter moves");
+}
+
+/**
+ * @brief The filter steps per ambient reading, not per updateBacklight() call
+ */
+static void checkUpdateRate() {
+  backlightBegin();
+  uint32_t now = millis();
+  uint32_t tick = 1;
+  for (int i = 0; i < CALLS_PER_READING; i++, now += CALL_INTERVAL) updateBacklight(0, tick, 0, now);
+  CHECK(ledc_get_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0) == MIN_PWM, "dark start gives %u", ledc_get_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0));
+
+  ///< Light on: after every reading the duty follows one filter step
+  double filtered = 0;
+  for (int reading = 1; reading <= 8; reading++) {
+    tick++;
+    filtered += BACKLIGHT_FILTER_ALPHA * (MAX_AMBIENT_LIGHT - filtered);
+    for (int i = 0; i < CALLS_PER_READING; i++, now += CALL_INTERVAL) updateBacklight(MAX_AMBIENT_LIGHT, tick, 0, now);
+    int duty = ledc_get_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
+    CHECK(abs(duty - expectedDuty(filtered)) <= 1, "duty %d after %d readings, expected %d", duty, reading, expectedDuty(filtered));
+  }
+}
+
+int main() {
+  hostSerialOutput(nullptr);
+  checkTarget();
+  checkFilter();
+  checkUpdateRate();
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
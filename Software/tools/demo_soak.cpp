@@ -0,0 +1,199 @@
+/**
+ * @file demo_soak.cpp
+ * @brief Soak test of the history and graph paths with the demo weather
+ *
+ * Boots the firmware on the host with no sensor answering, so setup()
+ * switches to the synthetic weather, and feeds --days of history ticks
+ * through the sensor task's updateValues() and the UI's loop(). Between two
+ * ticks the virtual clock jumps instead of running the idle sensor passes,
+ * so a week takes seconds. History, tiers, archive and flash log are the
+ * firmware's own; with --box the detail page of that box is open and the
+ * graph view moves on every --view-hours, like a press on the graph.
+ *
+ * After every tick the newest history sample of each box has to be the
+ * shown value rounded to the history resolution, and every value has to
+ * stay in its physical range. At the end the ranges, graph, box redraw
+ * and log counters and the wall time are printed; the exit code is 1 on
+ * a failed check.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src $(find lib -mindepth 1 -maxdepth 1 -type d -printf '-I%p ') \
+ *       tools/demo_soak.cpp src/main.cpp $(find lib native/mock/src -name '*.cpp') -o demo_soak
+ *   ./demo_soak [--days=N] [--box=N] [--view-hours=N] [--seed=N] [--noise=X] [--screenshot=FILE]
+ */
+
+#include <Adafruit_BME680.h>
+#include <Adafruit_LTR390.h>
+#include <Adafruit_VCNL4040.h>
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <archive.h>
+#include <config.h>
+#include <display.h>
+#include <graph.h>
+#include <host.h>
+#include <math.h>
+#include <methods.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <synthetic.h>
+
+#include <chrono>
+
+/// Sensor passes per history tick, enough for the tick and every sensor job once
+#define SOAK_PASSES_PER_TICK 6
+
+void setup();
+void loop();
+
+extern TFT_eSPI tft;
+extern Adafruit_BME680 bme;
+extern Adafruit_LTR390 ltr;
+extern Adafruit_VCNL4040 vcnl;
+extern SyntheticWeather demoWeather;
+extern int currentPage;
+extern int selectedBox;
+extern float lastDetailValue;
+extern bool detailGraphNeedsRedraw;
+extern int detailTier;
+
+/// Physical range of every box, a value outside means a broken model or conversion
+static const float validRange[NUM_BOXES][2] = {
+    {-40, 60}, {0, 100}, {900, 1100}, {0, 65535}, {0, 65535}, {0, 10000}, {0, 1048575}, {0, 11}};
+
+/**
+ * @brief Value of an option of the form --name=value
+ * @return nullptr if arg is a different option
+ */
+static const char* option(const char* arg, const char* name) {
+  size_t len = strlen(name);
+  return strncmp(arg, name, len) == 0 && arg[len] == '=' ? arg + len + 1 : nullptr;
+}
+
+/**
+ * @brief Open the detail page of a box, as a press on it does
+ */
+static void openDetailPage(int box) {
+  selectedBox = box;
+  currentPage = 1;
+  lastDetailValue = NAN;
+  detailGraphNeedsRedraw = true;
+  detailTier = TIER_RAW;
+  displaySave(SCREEN_MAIN);
+  drawDetailPageTitle(box);
+}
+
+int main(int argc, char** argv) {
+  double days = 7;
+  int box = -1;
+  double viewHours = 6;
+  const char* screenshot = nullptr;
+  SyntheticConfig config;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value;
+    if ((value = option(argv[i], "--days"))) {
+      days = atof(value);
+    } else if ((value = option(argv[i], "--box"))) {
+      box = atoi(value);
+    } else if ((value = option(argv[i], "--view-hours"))) {
+      viewHours = atof(value);
+    } else if ((value = option(argv[i], "--seed"))) {
+      config.seed = strtoul(value, nullptr, 10);
+    } else if ((value = option(argv[i], "--noise"))) {
+      config.noise = atof(value);
+    } else if ((value = option(argv[i], "--screenshot"))) {
+      screenshot = value;
+    } else {
+      fprintf(stderr, "usage: %s [--days=N] [--box=N] [--view-hours=N] [--seed=N] [--noise=X] [--screenshot=FILE]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (box >= NUM_BOXES) {
+    fprintf(stderr, "--box must be below %d\n", NUM_BOXES);
+    return 2;
+  }
+
+  char fsRoot[] = "/tmp/demo_soak.XXXXXX";
+  if (!mkdtemp(fsRoot)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  hostFsRoot(fsRoot);
+  hostSerialOutput(nullptr);
+  bme.hostPresent = false;
+  ltr.hostPresent = false;
+  vcnl.hostPresent = false;
+  demoWeather = SyntheticWeather(config);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  setup();
+  if (box >= 0) openDetailPage(box);
+
+  const uint64_t tickUs = HISTORY_UPDATE_INTERVAL * 1000ULL;
+  const uint64_t passUs = SENSOR_TASK_PERIOD * 1000ULL;
+  const uint32_t ticks = (uint32_t)(days * 86400000.0 / HISTORY_UPDATE_INTERVAL);
+  const uint32_t ticksPerView = viewHours > 0 ? (uint32_t)(viewHours * 3600000.0 / HISTORY_UPDATE_INTERVAL) : 0;
+  const uint64_t startUs = hostMicros();
+
+  float low[NUM_BOXES], high[NUM_BOXES];
+  for (int i = 0; i < NUM_BOXES; i++) {
+    low[i] = INFINITY;
+    high[i] = -INFINITY;
+  }
+  uint32_t failures = 0;
+
+  for (uint32_t tick = 1; tick <= ticks; tick++) {
+    ///< Jump to the tick, then run the sensor passes the scheduler needs and one frame
+    uint64_t due = startUs + tick * tickUs;
+    if (due > hostMicros()) hostSkipMicros(due - hostMicros());
+    uint32_t before = historyCount(0);
+    for (int pass = 0; pass < SOAK_PASSES_PER_TICK; pass++) {
+      updateValues();
+      hostSkipMicros(passUs);
+    }
+    if (box >= 0 && ticksPerView > 0 && tick % ticksPerView == 0) {
+      detailTier = (detailTier + 1) % NUM_GRAPH_VIEWS;
+      detailGraphNeedsRedraw = true;
+    }
+    loop();
+
+    if (historyCount(0) != before + 1) {
+      if (failures++ < 10) printf("FAIL tick %u: history count %u, expected %u\n", tick, historyCount(0), before + 1);
+    }
+    for (int i = 0; i < NUM_BOXES; i++) {
+      float shown = *boxes[i].value, stored;
+      if (shown < low[i]) low[i] = shown;
+      if (shown > high[i]) high[i] = shown;
+      if (!(shown >= validRange[i][0] && shown <= validRange[i][1])) {
+        if (failures++ < 10) printf("FAIL tick %u box %d: %g outside [%g, %g]\n", tick, i, shown, validRange[i][0], validRange[i][1]);
+      }
+      if (!historyValue(i, 0, stored) || stored != historyRound(i, shown)) {
+        if (failures++ < 10) printf("FAIL tick %u box %d: history holds %g, box shows %g\n", tick, i, stored, shown);
+      }
+    }
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  printf("%u history ticks (%.1f days simulated) in %.2f s wall time, seed %u, noise %.2f\n", ticks, ticks * (HISTORY_UPDATE_INTERVAL / 86400000.0),
+         wall, config.seed, config.noise);
+  printf("box  %-18s %12s %12s\n", "title", "min", "max");
+  for (int i = 0; i < NUM_BOXES; i++) printf("%3d  %-18s %12.2f %12.2f\n", i, boxes[i].title, low[i], high[i]);
+  for (int tier = 0; tier < NUM_TIERS; tier++) printf("tier %d: %u entries\n", tier, historyTierCount(0, tier));
+  printf("archive: %u rows\n", archiveStore().rowCount());
+  const GraphStats& graph = graphStats();
+  printf("graph: %u full, %u incremental redraws, %u pixels pushed\n", graph.fullRedraws, graph.incrementalRedraws, graph.pixelsPushed);
+  hostSerialOutput(stdout);  ///< The firmware's own report of redrawn and skipped box values
+  boxReport(Serial);
+  hostSerialOutput(nullptr);
+  const TFTBusStats& bus = tft.hostBus();
+  printf("bus: %llu bytes, %llu pixels, %lu windows\n", (unsigned long long)bus.bytes, (unsigned long long)bus.pixels, (unsigned long)bus.windows);
+
+  if (screenshot && !tft.hostSavePpm(screenshot)) {
+    fprintf(stderr, "cannot write %s\n", screenshot);
+    return 1;
+  }
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file display_check.cpp
+ * @brief Host check of the framebuffer backend against an in-memory panel
+ *
+ * Starts the framebuffer backend with displayBegin(DisplayPanel&) on
+ * MemoryPanel, a stand-in of the i80 bus that checks the calls it gets
+ * and keeps the 3-byte pixels it receives. A script of fills, sprite
+ * pushes (clipped ones too) and 1- and 4-bit palette pushes is drawn
+ * frame by frame and applied to a reference frame in parallel; after
+ * every displayFlush() the transfer task runs on the virtual clock and
+ * the panel has to match the reference, converted like tft_Write_16.
+ *
+ * The script covers the buffer swap (drawing while a transfer runs must
+ * not reach the panel), the copy of the sent regions into the new back
+ * buffer (a later full-screen flush shows any region the back buffer
+ * missed), flushes deferred while a transfer runs and dirty
+ * lists that overflow DISPLAY_MAX_DIRTY. Every transfer must write
+ * exactly the area of its dirty list. The last part times
+ * displayTransfer() on this host per pixel, the conversion loop the
+ * transfer task runs on DISPLAY_TASK_CORE. The exit code is 1 on a failed
+ * check.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src -Ilib/config -Ilib/display \
+ *       tools/display_check.cpp lib/display/display.cpp native/mock/src/TFT_eSPI.cpp native/mock/src/Arduino.cpp native/mock/src/host.cpp \
+ *       -o display_check
+ *   ./display_check
+ */
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <config.h>
+#include <display.h>
+#include <host.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+/// Pixels per bounce buffer, not a divisor of any rectangle width so buffers end mid-row
+#define PANEL_BUFFER_PIXELS 37
+
+/// TFT object the backend allocates its frames with, the firmware defines it in main.cpp
+TFT_eSPI tft = TFT_eSPI();
+
+static int failures = 0;  ///< Failed checks so far
+
+/// Count and print a failed check
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+/**
+ * @brief Panel in memory with two bounce buffers, checking how it is driven
+ *
+ * Written buffers are taken over right away, as if the DMA were done, so
+ * at most two buffers can be out between acquire() and write().
+ */
+class MemoryPanel : public DisplayPanel {
+ public:
+  std::vector<uint8_t> pixels = std::vector<uint8_t>((size_t)SCREEN_WIDTH * SCREEN_HEIGHT * DISPLAY_BYTES_PER_PIXEL);  ///< Received pixels
+  uint32_t written = 0;  ///< Pixels written since the last reset of the counter
+  uint32_t errors = 0;   ///< Protocol errors
+
+  size_t bufferSize() const override { return PANEL_BUFFER_PIXELS * DISPLAY_BYTES_PER_PIXEL; }
+
+  uint8_t* acquire() override {
+    if (out == 2) error("acquire() with both buffers out");
+    out++;
+    uint8_t* buf = buffers[next];
+    next ^= 1;
+    return buf;
+  }
+
+  void setWindow(const DisplayRect& rect) override {
+    if (cursor != area()) error("window changed after %u of %u pixels", cursor, area());
+    if (rect.x < 0 || rect.y < 0 || rect.w <= 0 || rect.h <= 0 || rect.x + rect.w > SCREEN_WIDTH || rect.y + rect.h > SCREEN_HEIGHT) {
+      error("window %d,%d %dx%d off screen", rect.x, rect.y, rect.w, rect.h);
+    }
+    window = rect;
+    cursor = 0;
+    first = true;
+  }
+
+  void write(uint8_t* data, size_t len, bool isFirst) override {
+    if (data != buffers[0] && data != buffers[1]) error("write() of a foreign buffer");
+    if (isFirst != first) error("first flag %d, expected %d", isFirst, first);
+    if (len == 0 || len > bufferSize() || len % DISPLAY_BYTES_PER_PIXEL) error("write() of %zu bytes", len);
+    if (out == 0) error("write() without acquire()");
+    first = false;
+    out--;
+    for (size_t i = 0; i + DISPLAY_BYTES_PER_PIXEL <= len; i += DISPLAY_BYTES_PER_PIXEL, cursor++) {
+      if (cursor >= area()) {
+        error("write() past the end of the window");
+        return;
+      }
+      int32_t x = window.x + cursor % window.w, y = window.y + cursor / window.w;
+      memcpy(&pixels[((size_t)y * SCREEN_WIDTH + x) * DISPLAY_BYTES_PER_PIXEL], data + i, DISPLAY_BYTES_PER_PIXEL);
+      written++;
+    }
+  }
+
+  void finish() override {
+    if (out != 0) error("finish() with %d buffers out", out);
+    if (cursor != area()) error("finish() after %u of %u pixels", cursor, area());
+  }
+
+ private:
+  template <typename... Args>
+  void error(const char* format, Args... args) {
+    if (errors++ < 10) {
+      printf("panel: ");
+      printf(format, args...);
+      printf("\n");
+    }
+  }
+
+  uint32_t area() const { return (uint32_t)window.w * window.h; }
+
+  uint8_t buffers[2][PANEL_BUFFER_PIXELS * DISPLAY_BYTES_PER_PIXEL];  ///< Bounce buffers
+  int next = 0;                                                       ///< Buffer of the next acquire()
+  int out = 0;                                                        ///< Buffers acquired and not written
+  DisplayRect window = {0, 0, 0, 0};                                  ///< Current address window
+  uint32_t cursor = 0;                                                ///< Pixels written into the window
+  bool first = true;                                                  ///< The next write() starts the window
+};
+
+static MemoryPanel panel;                                                         ///< Panel of the backend
+static std::vector<uint16_t> reference((size_t)SCREEN_WIDTH * SCREEN_HEIGHT, 0);  ///< Composed frame in RGB565
+
+/**
+ * @brief Set a pixel of the reference, clipped to the screen
+ */
+static void referencePixel(int32_t x, int32_t y, uint16_t color) {
+  if (x >= 0 && y >= 0 && x < SCREEN_WIDTH && y < SCREEN_HEIGHT) reference[(size_t)y * SCREEN_WIDTH + x] = color;
+}
+
+/**
+ * @brief Fill a rectangle on the canvas and in the reference
+ */
+static void fill(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+  canvas().fillRect(x, y, w, h, color);
+  displayMarkDirty(x, y, w, h);
+  for (int32_t row = y; row < y + h; row++) {
+    for (int32_t col = x; col < x + w; col++) referencePixel(col, row, color);
+  }
+}
+
+/**
+ * @brief Push a 16-bit sprite and copy it into the reference
+ */
+static void push(TFT_eSprite& spr, int32_t x, int32_t y) {
+  displayPush(spr, x, y);
+  for (int32_t row = 0; row < spr.height(); row++) {
+    for (int32_t col = 0; col < spr.width(); col++) referencePixel(x + col, y + row, spr.readPixel(col, row));
+  }
+}
+
+/**
+ * @brief Push a palette sprite and expand it into the reference
+ */
+static void pushIndexed(TFT_eSprite& spr, const uint16_t* palette, int32_t x, int32_t y) {
+  displayPushIndexed(spr, palette, x, y);
+  for (int32_t row = 0; row < spr.height(); row++) {
+    for (int32_t col = 0; col < spr.width(); col++) referencePixel(x + col, y + row, palette[spr.readPixelValue(col, row)]);
+  }
+}
+
+/**
+ * @brief Flush and let the transfer task send the frame
+ * @param area Pixels the transfer has to write
+ */
+static void flushAndSend(uint32_t area, int line) {
+  panel.written = 0;
+  displayFlush();
+  hostRunTasks();
+  if (panel.written != area) {
+    failures++;
+    printf("FAIL %s:%d: %u pixels written, dirty area %u\n", __FILE__, line, panel.written, area);
+  }
+}
+
+/**
+ * @brief Compare the panel with a frame converted to 3 bytes per pixel
+ */
+static void comparePanel(const std::vector<uint16_t>& expected, const char* step, int line) {
+  for (int32_t y = 0; y < SCREEN_HEIGHT; y++) {
+    for (int32_t x = 0; x < SCREEN_WIDTH; x++) {
+      uint16_t color = expected[(size_t)y * SCREEN_WIDTH + x];
+      const uint8_t* got = &panel.pixels[((size_t)y * SCREEN_WIDTH + x) * DISPLAY_BYTES_PER_PIXEL];
+      uint8_t r = (color & 0xF800) >> 8, g = (color & 0x07E0) >> 3, b = (color & 0x001F) << 3;
+      if (got[0] != r || got[1] != g || got[2] != b) {
+        failures++;
+        printf("FAIL %s:%d: %s: pixel (%d, %d) is %02x%02x%02x, expected %02x%02x%02x\n", __FILE__, line, step, x, y, got[0], got[1], got[2], r, g, b);
+        return;
+      }
+    }
+  }
+}
+
+#define FLUSH_AND_SEND(area) flushAndSend(area, __LINE__)
+#define COMPARE_PANEL(step) comparePanel(reference, step, __LINE__)
+
+/**
+ * @brief Frames through the backend, each compared with the reference
+ */
+static void checkFrames() {
+  CHECK(displayBegin(panel), "backend did not start");
+  CHECK(displayBuffered(), "backend not active");
+  CHECK(&canvas() != &tft, "canvas() is the TFT");
+
+  ///< First frame: the whole screen
+  fill(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, TFT_NAVY);
+  fill(100, 50, 200, 100, TFT_YELLOW);
+  FLUSH_AND_SEND((uint32_t)SCREEN_WIDTH * SCREEN_HEIGHT);
+  COMPARE_PANEL("first frame");
+
+  ///< Sprites, one clipped at the top left, one at the bottom right
+  TFT_eSprite spr(&tft);
+  spr.createSprite(61, 23);
+  for (int32_t y = 0; y < spr.height(); y++) {
+    for (int32_t x = 0; x < spr.width(); x++) spr.drawPixel(x, y, (uint16_t)(x * 2113 + y * 977));
+  }
+  push(spr, 400, 300);
+  push(spr, -20, -5);
+  push(spr, SCREEN_WIDTH - 30, SCREEN_HEIGHT - 10);
+  FLUSH_AND_SEND(61 * 23 + 41 * 18 + 30 * 10);
+  COMPARE_PANEL("sprites");
+
+  ///< Palette sprites: 1-bit like the detail value, 4-bit like the graph
+  TFT_eSprite mono(&tft);
+  mono.setColorDepth(1);
+  mono.createSprite(50, 9);
+  for (int32_t x = 0; x < 50; x += 3) mono.drawFastVLine(x, 0, 9, 1);
+  const uint16_t inks[2] = {TFT_WHITE, TFT_BLACK};
+  TFT_eSprite graph(&tft);
+  graph.setColorDepth(4);
+  graph.createSprite(32, 16);
+  for (int32_t y = 0; y < 16; y++) {
+    for (int32_t x = 0; x < 32; x++) graph.drawPixel(x, y, (x + y) & 15);
+  }
+  uint16_t colors[16];
+  for (int i = 0; i < 16; i++) colors[i] = (uint16_t)(i * 4369);
+  pushIndexed(mono, inks, 10, 400);
+  pushIndexed(graph, colors, 700, 20);
+  FLUSH_AND_SEND(50 * 9 + 32 * 16);
+  COMPARE_PANEL("palette sprites");
+
+  ///< Drawing during a transfer goes to the other buffer, the flush meanwhile is deferred
+  fill(200, 200, 40, 40, TFT_RED);
+  std::vector<uint16_t> flushed = reference;
+  uint32_t deferred = displayStats().deferred;
+  panel.written = 0;
+  displayFlush();
+  fill(220, 220, 40, 40, TFT_GREEN);  ///< Over the region in transfer
+  displayFlush();
+  CHECK(displayStats().deferred == deferred + 1, "second flush not deferred");
+  hostRunTasks();
+  CHECK(panel.written == 40 * 40, "%u pixels in the first transfer", panel.written);
+  comparePanel(flushed, "transfer while drawing", __LINE__);
+  FLUSH_AND_SEND(40 * 40);
+  COMPARE_PANEL("deferred flush");
+
+  ///< More regions than DISPLAY_MAX_DIRTY, far apart, are merged but all sent
+  for (int i = 0; i < 3 * DISPLAY_MAX_DIRTY; i++) fill(5 + (i * 97) % 760, 5 + (i * 53) % 440, 7, 5, (uint16_t)(i * 3001));
+  panel.written = 0;
+  displayFlush();
+  hostRunTasks();
+  COMPARE_PANEL("many regions");
+
+  ///< The back buffer has to hold every region sent from the other buffer
+  displayMarkDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+  FLUSH_AND_SEND((uint32_t)SCREEN_WIDTH * SCREEN_HEIGHT);
+  COMPARE_PANEL("full flush after swaps");
+  displayMarkDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+  FLUSH_AND_SEND((uint32_t)SCREEN_WIDTH * SCREEN_HEIGHT);
+  COMPARE_PANEL("full flush of the other buffer");
+
+  CHECK(panel.errors == 0, "%u panel protocol errors", panel.errors);
+  CHECK(!displayBegin(panel), "second displayBegin() accepted");
+}
+
+/**
+ * @brief Panel that only takes buffers, to time the conversion alone
+ */
+class NullPanel : public DisplayPanel {
+ public:
+  size_t bufferSize() const override { return SCREEN_WIDTH * DISPLAY_BOUNCE_LINES * DISPLAY_BYTES_PER_PIXEL; }
+  uint8_t* acquire() override { return buffer.data(); }
+  void setWindow(const DisplayRect& rect) override { (void)rect; }
+  void write(uint8_t* data, size_t len, bool first) override { (void)data, (void)len, (void)first; }
+  void finish() override {}
+
+ private:
+  std::vector<uint8_t> buffer = std::vector<uint8_t>(SCREEN_WIDTH * DISPLAY_BOUNCE_LINES * DISPLAY_BYTES_PER_PIXEL);  ///< The one bounce buffer
+};
+
+/**
+ * @brief Time the conversion of full screens on this host
+ */
+static void timeConversion() {
+  NullPanel null;
+  std::vector<uint16_t> frame((size_t)SCREEN_WIDTH * SCREEN_HEIGHT);
+  for (size_t i = 0; i < frame.size(); i++) frame[i] = (uint16_t)(i * 40503);
+  const DisplayRect screen = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+  const int rounds = 50;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) displayTransfer(null, frame.data(), SCREEN_WIDTH, screen);
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  double perPixel = ns / rounds / frame.size();
+  printf("conversion: %.2f ns/pixel on this host, %.2f ms per full screen\n", perPixel, perPixel * frame.size() / 1e6);
+}
+
+int main() {
+  hostSerialOutput(nullptr);
+  checkFrames();
+  timeConversion();
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
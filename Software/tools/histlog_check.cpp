@@ -0,0 +1,188 @@
+/**
+ * @file histlog_check.cpp
+ * @brief Host check of the history log against files in a directory
+ *
+ * Writes simulated history ticks through HistoryLog into a temporary
+ * directory, "reboots" by replaying into the real history buffers and
+ * checks that every record comes back, that old segments are dropped, and
+ * that a torn tail and a damaged record only cost the rest of their
+ * segment. Reports replay time and writes per day.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -Inative/mock/src -Ilib/config -Ilib/history -Ilib/histlog \
+ *       tools/histlog_check.cpp lib/histlog/histlog.cpp lib/history/history.cpp -o histlog_check
+ *   ./histlog_check
+ */
+
+#include <dirent.h>
+#include <histlog.h>
+#include <history.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Segments as files <dir>/<number>.log
+ */
+class FileStorage : public LogStorage {
+ public:
+  explicit FileStorage(const std::string& dir) : dir(dir) {}
+
+  int list(uint32_t* segments, int max) override {
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) return 0;
+    int n = 0;
+    while (dirent* e = readdir(d)) {
+      if (n < max && e->d_name[0] >= '0' && e->d_name[0] <= '9') segments[n++] = strtoul(e->d_name, nullptr, 10);
+    }
+    closedir(d);
+    return n;
+  }
+
+  bool append(uint32_t segment, const uint8_t* data, size_t len) override {
+    FILE* f = fopen(path(segment).c_str(), "ab");
+    if (f == nullptr) return false;
+    size_t written = fwrite(data, 1, len, f);
+    fclose(f);
+    return written == len;
+  }
+
+  size_t read(uint32_t segment, size_t offset, uint8_t* data, size_t len) override {
+    FILE* f = fopen(path(segment).c_str(), "rb");
+    if (f == nullptr) return 0;
+    fseek(f, offset, SEEK_SET);
+    size_t got = fread(data, 1, len, f);
+    fclose(f);
+    return got;
+  }
+
+  void remove(uint32_t segment) override { ::remove(path(segment).c_str()); }
+
+  std::string path(uint32_t segment) const {
+    char name[24];
+    snprintf(name, sizeof(name), "/%08u.log", segment);
+    return dir + name;
+  }
+
+ private:
+  std::string dir;  ///< Directory of the segments
+};
+
+static std::vector<LogRecord> replayed;  ///< Records seen by the last replay
+
+static void collect(const LogRecord& record) {
+  replayed.push_back(record);
+}
+
+/**
+ * @brief Feed a record into the history like the firmware does
+ */
+static void restore(const LogRecord& record) {
+  for (int i = 0; i < NUM_BOXES; i++) {
+    bool valid = record.valid & (1 << i);
+    updateHistory(i, valid ? historyScale(i).decode(record.codes[i]) : NAN);
+  }
+}
+
+/**
+ * @brief Deterministic record for a tick
+ */
+static LogRecord recordFor(uint32_t tick) {
+  LogRecord record = {};
+  for (int i = 0; i < NUM_BOXES; i++) {
+    record.codes[i] = (tick * 7 + i * 1000) & 0xFFFF;
+    if (tick % 50 != (uint32_t)i) record.valid |= 1 << i;  ///< Now and then a missing reading
+  }
+  return record;
+}
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if (!ok) failures++;
+}
+
+/**
+ * @brief Replay and check that the records are ticks first..first+count-1
+ */
+static bool replayMatches(FileStorage& storage, uint32_t first, uint32_t count) {
+  replayed.clear();
+  HistoryLog log;
+  log.begin(storage, collect);
+  if (replayed.size() != count) return false;
+  for (uint32_t i = 0; i < count; i++) {
+    LogRecord want = recordFor(first + i);
+    const LogRecord& got = replayed[i];
+    if (got.sequence != first + i || got.valid != want.valid) return false;
+    for (int b = 0; b < NUM_BOXES; b++) {
+      if ((want.valid & (1 << b)) && got.codes[b] != want.codes[b]) return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  char dir[] = "/tmp/histlogXXXXXX";
+  if (mkdtemp(dir) == nullptr) return 1;
+  FileStorage storage(dir);
+  const uint32_t perDay = 86400000UL / HISTORY_UPDATE_INTERVAL;
+
+  ///< Three days, then reboot
+  HistoryLog log;
+  expect(log.begin(storage, collect) == 0, "empty directory replays nothing");
+  for (uint32_t t = 0; t < 3 * perDay; t++) log.append(recordFor(t));
+  const HistoryLogStats& s = log.stats();
+  printf("     3 days: %u writes, %u bytes, %.0f writes and %.0f bytes per day\n",
+         s.writes, s.bytesWritten, s.writes / 3.0, s.bytesWritten / 3.0);
+  expect(replayMatches(storage, 0, 3 * perDay), "reboot replays all ticks in order");
+
+  ///< Ten more days after that reboot, retention is capped
+  HistoryLog second;
+  second.begin(storage, nullptr);
+  for (uint32_t t = 3 * perDay; t < 13 * perDay; t++) second.append(recordFor(t));
+  uint32_t kept = (HISTORY_LOG_SEGMENTS - 1) * HISTORY_LOG_SEGMENT_RECORDS;
+  expect(replayMatches(storage, 13 * perDay - kept, kept), "old segments are dropped, the newest are kept");
+
+  ///< Replay time into the real history buffers
+  initHistory();
+  HistoryLog timed;
+  auto t0 = std::chrono::steady_clock::now();
+  uint32_t n = timed.begin(storage, restore);
+  auto t1 = std::chrono::steady_clock::now();
+  printf("     replayed %u ticks into the history in %.2f ms\n", n, std::chrono::duration<double, std::milli>(t1 - t0).count());
+  float value;
+  LogRecord last = recordFor(13 * perDay - 1);
+  expect(historyValue(1, 0, value) == bool(last.valid & 2) && historyCount(1) == kept, "history holds the replayed ticks");
+
+  ///< Damage: torn tail in the newest segment, flipped byte in an older one
+  uint32_t segments[64];
+  int count = storage.list(segments, 64);
+  uint32_t newest = 0, oldestKept = UINT32_MAX;
+  for (int i = 0; i < count; i++) {
+    if (segments[i] > newest) newest = segments[i];
+    if (segments[i] < oldestKept) oldestKept = segments[i];
+  }
+  uint8_t torn[HISTORY_LOG_RECORD_BYTES / 2] = {0x42};
+  storage.append(newest, torn, sizeof(torn));
+  FILE* f = fopen(storage.path(oldestKept).c_str(), "r+b");
+  fseek(f, 10 * HISTORY_LOG_RECORD_BYTES + 5, SEEK_SET);
+  fputc(0xFF, f);
+  fclose(f);
+
+  replayed.clear();
+  HistoryLog damaged;
+  damaged.begin(storage, collect);
+  expect(damaged.stats().corrupt == 2, "torn tail and damaged record are detected");
+  expect(replayed.size() == kept - (HISTORY_LOG_SEGMENT_RECORDS - 10) && replayed.back().sequence == 13 * perDay - 1,
+         "only the rest of the damaged segment is lost");
+
+  std::string cleanup = std::string("rm -rf ") + dir;
+  if (system(cleanup.c_str()) != 0) return 1;
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file history_check.cpp
+ * @brief Host round-trip check of the 16-bit history codes
+ *
+ * For the scale of every box: every code has to decode and encode to
+ * itself, random values over the whole range (and a little beyond) have
+ * to come back within half a step, and values at and past the range edges
+ * have to clamp to code 0 or 65535, infinities included. The two light
+ * boxes hold raw 16-bit counts, so every count up to 65535 has to come
+ * back exactly. A small CompactHistory is then fed random samples with NAN
+ * in between and compared with a plain model across several wraps, so a
+ * slot that loses its sample also loses its validity bit. Finally every
+ * box takes random samples through updateHistory() and has to return
+ * historyRound() of them. The exit code is 1 on a failed check.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src -Ilib/config -Ilib/history \
+ *       tools/history_check.cpp lib/history/history.cpp -o history_check
+ *   ./history_check [--count=N] [--seed=N]
+ */
+
+#include <float.h>
+#include <history.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+/// Capacity of the ring of the validity check, not a multiple of 8
+#define RING_LENGTH 37
+
+/// Boxes holding raw 16-bit counts of the VCNL4040: ambient and white light
+static const int rawCountBoxes[] = {3, 4};
+
+static int failures = 0;  ///< Failed checks so far
+
+/// Count and print a failed check, at most 20 are printed
+#define CHECK(cond, ...)                              \
+  do {                                                \
+    if (!(cond)) {                                    \
+      if (failures++ < 20) {                          \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__);  \
+        printf(__VA_ARGS__);                          \
+        printf("\n");                                 \
+      }                                               \
+    }                                                 \
+  } while (0)
+
+/**
+ * @brief Largest value a scale can hold
+ */
+static double rangeEnd(const HistoryScale& scale) {
+  return scale.offset + 65535.0 * scale.step;
+}
+
+/**
+ * @brief Every code survives decode() and encode()
+ */
+static void checkCodes(int box, const HistoryScale& scale) {
+  for (uint32_t code = 0; code <= 65535; code++) {
+    uint16_t back = scale.encode(scale.decode((uint16_t)code));
+    CHECK(back == code, "box %d: code %u comes back as %u", box, code, back);
+  }
+}
+
+/**
+ * @brief Random values come back within half a step, values outside clamp
+ */
+static void checkValues(int box, const HistoryScale& scale, uint32_t count, std::mt19937& random) {
+  double low = scale.offset, high = rangeEnd(scale);
+  ///< Half a step plus the float rounding of value and decoded value
+  double tolerance = scale.step / 2 + 4 * fmax(fabs(low), fabs(high)) * FLT_EPSILON;
+  std::uniform_real_distribution<double> inside(low, high);
+  std::uniform_real_distribution<double> beyond(0, 1000 * scale.step);
+
+  for (uint32_t i = 0; i < count; i++) {
+    float value = (float)inside(random);
+    float decoded = scale.decode(scale.encode(value));
+    CHECK(fabs(decoded - value) <= tolerance, "box %d: %.6f comes back as %.6f", box, value, decoded);
+
+    float under = (float)(low - scale.step - beyond(random));
+    float over = (float)(high + scale.step + beyond(random));
+    CHECK(scale.encode(under) == 0, "box %d: %.6f below the range gives code %u", box, under, scale.encode(under));
+    CHECK(scale.encode(over) == 65535, "box %d: %.6f above the range gives code %u", box, over, scale.encode(over));
+  }
+
+  ///< The edges themselves and less than half a step beyond them
+  CHECK(scale.encode(scale.offset) == 0, "box %d: offset gives code %u", box, scale.encode(scale.offset));
+  CHECK(scale.encode((float)high) == 65535, "box %d: range end gives code %u", box, scale.encode((float)high));
+  CHECK(scale.encode((float)(low - 0.4 * scale.step)) == 0, "box %d: just below the range gives code %u", box, scale.encode((float)(low - 0.4 * scale.step)));
+  CHECK(scale.encode((float)(high + 0.4 * scale.step)) == 65535, "box %d: just above the range gives code %u", box,
+        scale.encode((float)(high + 0.4 * scale.step)));
+  CHECK(scale.encode(-INFINITY) == 0 && scale.encode(-1e30F) == 0, "box %d: -infinity not clamped", box);
+  CHECK(scale.encode(INFINITY) == 65535 && scale.encode(1e30F) == 65535, "box %d: infinity not clamped", box);
+}
+
+/**
+ * @brief Every raw 16-bit count comes back exactly, up to 65535
+ */
+static void checkRawCounts(int box, const HistoryScale& scale) {
+  for (uint32_t count = 0; count <= 65535; count++) {
+    float back = scale.decode(scale.encode((float)count));
+    CHECK(back == (float)count, "box %d: count %u comes back as %.1f", box, count, back);
+  }
+}
+
+/**
+ * @brief Validity bits and values of a small ring against a plain model
+ */
+static void checkRing(int box, const HistoryScale& scale, std::mt19937& random) {
+  CompactHistory<RING_LENGTH> ring;
+  ring.reset(scale);
+  std::vector<float> model;  ///< All samples pushed, NAN for invalid ones
+  std::uniform_real_distribution<double> inside(scale.offset, rangeEnd(scale));
+  std::uniform_int_distribution<int> coin(0, 3);
+
+  for (int n = 0; n < 5 * RING_LENGTH + 3; n++) {
+    float value = coin(random) == 0 ? NAN : (float)inside(random);
+    ring.push(value);
+    model.push_back(value);
+    CHECK(ring.appended() == model.size(), "box %d: %u appended, %zu pushed", box, ring.appended(), model.size());
+
+    ///< Every age of the ring, including slots never written
+    for (uint16_t age = 0; age < RING_LENGTH; age++) {
+      float got = 0;
+      bool valid = ring.read(age, got);
+      bool expected = age < model.size() && !isnan(model[model.size() - 1 - age]);
+      CHECK(valid == expected, "box %d: age %u after %zu pushes is %s", box, age, model.size(), valid ? "valid" : "invalid");
+      if (valid && expected) {
+        float want = scale.decode(scale.encode(model[model.size() - 1 - age]));
+        CHECK(got == want, "box %d: age %u reads %.6f, expected %.6f", box, age, got, want);
+      }
+    }
+
+    ///< The iterator sees the same samples from oldest to newest
+    uint16_t span = model.size() < RING_LENGTH ? model.size() : RING_LENGTH;
+    uint16_t age = span;
+    for (CompactHistory<RING_LENGTH>::Sample sample : ring.newest(span)) {
+      age--;
+      float want = model[model.size() - 1 - age];
+      CHECK(sample.valid == !isnan(want), "box %d: iterator age %u validity %d", box, age, sample.valid);
+      if (sample.valid && !isnan(want)) CHECK(sample.value == scale.decode(scale.encode(want)), "box %d: iterator age %u value %.6f", box, age, sample.value);
+    }
+    CHECK(age == 0, "box %d: iterator stopped %u samples early", box, age);
+  }
+}
+
+/**
+ * @brief Samples through the history of the station round to historyRound()
+ */
+static void checkBoxes(uint32_t count, std::mt19937& random) {
+  initHistory();
+  for (uint32_t i = 0; i < count; i++) {
+    for (int box = 0; box < NUM_BOXES; box++) {
+      const HistoryScale& scale = historyScale(box);
+      std::uniform_real_distribution<double> wide(scale.offset - 100 * scale.step, rangeEnd(scale) + 100 * scale.step);
+      float value = (float)wide(random);
+      updateHistory(box, value);
+      float stored = NAN;
+      CHECK(historyValue(box, 0, stored), "box %d: sample %u not stored", box, i);
+      CHECK(stored == historyRound(box, value), "box %d: %.6f stored as %.6f, rounds to %.6f", box, value, stored, historyRound(box, value));
+      CHECK(stored >= scale.offset && stored <= scale.decode(65535), "box %d: %.6f stored outside the range", box, stored);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t count = 100000;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--count=", 8) == 0) {
+      count = strtoul(argv[i] + 8, nullptr, 10);
+    } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+      seed = strtoul(argv[i] + 7, nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--count=N] [--seed=N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  std::mt19937 random(seed);
+  for (int box = 0; box < NUM_BOXES; box++) {
+    const HistoryScale& scale = historyScale(box);
+    checkCodes(box, scale);
+    checkValues(box, scale, count, random);
+    checkRing(box, scale, random);
+  }
+  for (int box : rawCountBoxes) checkRawCounts(box, historyScale(box));
+  checkBoxes(count / 10, random);
+
+  printf("%d scales, %u random values each, seed %u\n", NUM_BOXES, count, seed);
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Convert the logo into the run-length encoded header lib/logo/logo_data.h.
+
+Input is either a PNG (8-bit grayscale, RGB or RGBA, not interlaced) or a C
+header holding a raw RGB565 array like the one TFT_eSPI's image converter
+writes. Only the Python standard library is needed.
+
+Encoding: the image is reduced to a palette of RGB565 colors. Every row is
+stored as a sequence of runs that never cross the row end. One run is one
+byte, the upper INDEX_BITS bits are the palette index and the lower bits the
+run length minus one. The output is decoded again and compared pixel by pixel
+with the input before it is written, and the digest of the pixels is printed
+for tools/logo_check.cpp.
+
+Usage:
+    python3 tools/logo2rle.py logo.png
+    python3 tools/logo2rle.py --size 120x120 old_logo.h
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+OUTPUT = os.path.join(os.path.dirname(__file__), "..", "lib", "logo", "logo_data.h")
+
+
+def read_png(path):
+    """Return width, height and RGB565 pixels of a PNG file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit("%s: not a PNG file" % path)
+
+    pos, idat = 8, b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif kind == b"IDAT":
+            idat += chunk
+        pos += 12 + length
+
+    channels = {0: 1, 2: 3, 6: 4}.get(color)
+    if depth != 8 or channels is None or interlace:
+        sys.exit("%s: only 8-bit grayscale, RGB or RGBA without interlacing is supported" % path)
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    prev = bytearray(stride)
+    pixels = []
+    for y in range(height):
+        line = raw[y * (stride + 1):(y + 1) * (stride + 1)]
+        kind, cur = line[0], bytearray(line[1:])
+        for i in range(stride):
+            a = cur[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if kind == 1:
+                cur[i] = (cur[i] + a) & 0xFF
+            elif kind == 2:
+                cur[i] = (cur[i] + b) & 0xFF
+            elif kind == 3:
+                cur[i] = (cur[i] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                cur[i] = (cur[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        for x in range(width):
+            px = cur[x * channels:(x + 1) * channels]
+            r, g, b = (px[0], px[0], px[0]) if channels == 1 else px[:3]
+            pixels.append(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
+        prev = cur
+    return width, height, pixels
+
+
+def read_header(path, size):
+    """Return width, height and pixels of a raw RGB565 C array."""
+    if not size:
+        sys.exit("%s: --size is required for C headers" % path)
+    width, height = (int(v) for v in size.lower().split("x"))
+    with open(path) as f:
+        pixels = [int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]{4}\b", f.read())]
+    if len(pixels) != width * height:
+        sys.exit("%s: %d pixels found, %d expected" % (path, len(pixels), width * height))
+    return width, height, pixels
+
+
+def encode(width, height, pixels):
+    """Return palette, index bits and run bytes of an image."""
+    palette = sorted(set(pixels), key=pixels.index)
+    if len(palette) > 16:
+        sys.exit("%d colors found, the encoding supports at most 16" % len(palette))
+    bits = max(1, (len(palette) - 1).bit_length())
+    longest = 1 << (8 - bits)
+
+    runs = bytearray()
+    for y in range(height):
+        row = pixels[y * width:(y + 1) * width]
+        x = 0
+        while x < width:
+            n = 1
+            while x + n < width and n < longest and row[x + n] == row[x]:
+                n += 1
+            runs.append((palette.index(row[x]) << (8 - bits)) | (n - 1))
+            x += n
+    return palette, bits, runs
+
+
+def decode(width, height, palette, bits, runs):
+    """Decode run bytes the same way the firmware does."""
+    pixels = []
+    for run in runs:
+        pixels += [palette[run >> (8 - bits)]] * ((run & ((1 << (8 - bits)) - 1)) + 1)
+    return pixels
+
+
+def digest(pixels):
+    """Return the FNV-1a digest of RGB565 pixels, high byte first, as tools/logo_check.cpp computes it."""
+    value = 0xCBF29CE484222325
+    for pixel in pixels:
+        for byte in (pixel >> 8, pixel & 0xFF):
+            value = ((value ^ byte) * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return value
+
+
+def write_header(path, source, width, height, palette, bits, runs):
+    """Write the generated header."""
+    with open(path, "w") as f:
+        f.write("/**\n")
+        f.write(" * @file logo_data.h\n")
+        f.write(" * @brief Run-length encoded logo, generated by tools/logo2rle.py from %s\n" % os.path.basename(source))
+        f.write(" *\n")
+        f.write(" * Do not edit, run the generator again to change the logo.\n")
+        f.write(" */\n\n")
+        f.write("#ifndef LOGO_DATA_H\n#define LOGO_DATA_H\n\n#include <logo.h>\n\n")
+        f.write("static const uint16_t logoPalette[] = {%s};\n\n" % ", ".join("0x%04X" % c for c in palette))
+        f.write("static const uint8_t logoRuns[] = {\n")
+        for i in range(0, len(runs), 16):
+            f.write("    %s,\n" % ", ".join("0x%02X" % b for b in runs[i:i + 16]))
+        f.write("};\n\n")
+        f.write("const RleImage logoImage = {%d, %d, %d, logoPalette, logoRuns, sizeof(logoRuns)};\n\n" % (width, height, bits))
+        f.write("#endif  // LOGO_DATA_H\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("input", help="PNG file or C header with a raw RGB565 array")
+    parser.add_argument("--size", help="WIDTHxHEIGHT of a C header input")
+    parser.add_argument("-o", "--output", default=OUTPUT, help="generated header")
+    args = parser.parse_args()
+
+    if args.input.lower().endswith(".png"):
+        width, height, pixels = read_png(args.input)
+    else:
+        width, height, pixels = read_header(args.input, args.size)
+
+    palette, bits, runs = encode(width, height, pixels)
+    if decode(width, height, palette, bits, runs) != pixels:
+        sys.exit("round trip failed, decoded image differs from the input")
+
+    write_header(args.output, args.input, width, height, palette, bits, runs)
+    print("%dx%d, %d colors, %d bytes of runs instead of %d bytes of pixels" % (width, height, len(palette), len(runs), 2 * len(pixels)))
+    print("pixel digest %016X, the LOGO_DIGEST of tools/logo_check.cpp" % digest(pixels))
+
+
+if __name__ == "__main__":
+    main()
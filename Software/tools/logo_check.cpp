@@ -0,0 +1,114 @@
+/**
+ * @file logo_check.cpp
+ * @brief Host check of the run-length encoded logo against its reference pixels
+ *
+ * Decodes logoImage three ways, with RleDecoder::nextLine(), with
+ * pushRleImage() onto the host panel and with drawRleImage() into a
+ * sprite, and compares the pixels with each other and with LOGO_DIGEST.
+ * The digest is FNV-1a over the RGB565 pixels of the reference, high byte
+ * first; it is the digest of the raw array the logo replaced and of
+ * assets/logo.png as tools/logo2rle.py decodes it, which prints it after
+ * every run. The exit code is 1 on a failed check.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src -Ilib/logo \
+ *       tools/logo_check.cpp lib/logo/logo.cpp native/mock/src/TFT_eSPI.cpp native/mock/src/Arduino.cpp native/mock/src/host.cpp \
+ *       -o logo_check
+ *   ./logo_check
+ */
+
+#include <TFT_eSPI.h>
+#include <host.h>
+#include <logo.h>
+#include <stdio.h>
+
+#include <vector>
+
+/// Digest of the reference pixels, update it from the output of tools/logo2rle.py
+#define LOGO_DIGEST 0xC864DB508F13DD99ULL
+
+/// Position of the logo on the panel, away from the origin to catch offset errors
+#define LOGO_X 37
+#define LOGO_Y 211
+
+static int failures = 0;  ///< Failed checks so far
+
+/// Count and print a failed check
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+/**
+ * @brief FNV-1a digest of RGB565 pixels, high byte first
+ */
+static uint64_t digest(const std::vector<uint16_t>& pixels) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (uint16_t p : pixels) {
+    hash = (hash ^ (p >> 8)) * 0x100000001B3ULL;
+    hash = (hash ^ (p & 0xFF)) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief First pixel where two decodes differ, -1 if they are the same
+ */
+static long firstDifference(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+  for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+    if (a[i] != b[i]) return (long)i;
+  }
+  return a.size() == b.size() ? -1 : (long)(a.size() < b.size() ? a.size() : b.size());
+}
+
+int main() {
+  hostSerialOutput(nullptr);
+  const uint16_t w = logoImage.width, h = logoImage.height;
+
+  ///< The decoder, row by row
+  std::vector<uint16_t> lines((size_t)w * h);
+  RleDecoder decoder(logoImage);
+  uint16_t row = 0;
+  while (row < h && decoder.nextLine(&lines[(size_t)row * w])) row++;
+  uint16_t color, count;
+  CHECK(row == h, "decoder stopped after %u of %u rows", row, h);
+  CHECK(!decoder.nextRun(color, count), "run data left after the last row");
+  CHECK(digest(lines) == LOGO_DIGEST, "decoded digest %016llx, reference %016llx", (unsigned long long)digest(lines), LOGO_DIGEST);
+
+  ///< Streamed to the panel; with swapped bytes the panel holds the palette colors themselves
+  TFT_eSPI tft;
+  tft.init();
+  tft.setSwapBytes(true);
+  tft.fillScreen(TFT_RED);
+  pushRleImage(tft, LOGO_X, LOGO_Y, logoImage);
+  std::vector<uint16_t> panel((size_t)w * h);
+  for (uint16_t y = 0; y < h; y++) {
+    for (uint16_t x = 0; x < w; x++) panel[(size_t)y * w + x] = tft.hostFrame()[(size_t)(LOGO_Y + y) * tft.width() + LOGO_X + x];
+  }
+  long diff = firstDifference(panel, lines);
+  CHECK(diff < 0, "panel differs at (%ld, %ld)", diff % w, diff / w);
+  CHECK(tft.hostFrame()[(size_t)(LOGO_Y - 1) * tft.width() + LOGO_X] == TFT_RED, "pixel drawn above the logo");
+  CHECK(tft.hostFrame()[(size_t)(LOGO_Y + h) * tft.width() + LOGO_X + w] == TFT_RED, "pixel drawn below the logo");
+
+  ///< Drawn into a sprite run by run
+  TFT_eSprite spr(&tft);
+  CHECK(spr.createSprite(w + 2, h + 2) != nullptr, "no sprite");
+  spr.fillSprite(TFT_RED);
+  drawRleImage(spr, 1, 1, logoImage);
+  std::vector<uint16_t> sprite((size_t)w * h);
+  for (uint16_t y = 0; y < h; y++) {
+    for (uint16_t x = 0; x < w; x++) sprite[(size_t)y * w + x] = spr.readPixel(x + 1, y + 1);
+  }
+  diff = firstDifference(sprite, lines);
+  CHECK(diff < 0, "sprite differs at (%ld, %ld)", diff % w, diff / w);
+  CHECK(spr.readPixel(0, 0) == TFT_RED && spr.readPixel(w + 1, h + 1) == TFT_RED, "pixel drawn outside the logo");
+
+  printf("%ux%u logo, %u run bytes, digest %016llx\n", w, h, logoImage.length, (unsigned long long)digest(lines));
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
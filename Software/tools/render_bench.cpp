@@ -0,0 +1,582 @@
+/**
+ * @file render_bench.cpp
+ * @brief Host microbenchmarks of the render and history hot paths
+ *
+ * Runs the firmware's own setup() against the host stand-ins and then times
+ * updateHistory(), updateValue() with the frame it damages,
+ * drawDetailPageWithSprite() (incremental and full graph), layoutBoxes()
+ * and drawLogo() over a sensor trace. The text cases compare the value
+ * text of a box and of the detail page drawn with the font (drawString(),
+ * the path before the glyph atlas) and composed from an atlas, into the
+ * pool sprite without pushing it; the sprite is cleared outside the timed
+ * call, as that costs the same on both paths. The host fonts decode a packed bitmap
+ * bit by bit like the library, so the font cases carry a realistic glyph
+ * cost. For every case it reports ns/call,
+ * heap allocations/call and what was sent to the panel per call. The panel
+ * is the host one, so the numbers cover the direct drawing path and the
+ * bus bytes of the 8-bit SSD1963 interface, not the ESP32 timing.
+ *
+ * The trace is a CSV file with one row per history tick, the format of
+ * archive_bench:
+ *   seconds,temp,humid,pressure,ambient,white,gas,uv,uvIndex
+ * Lines that do not start with a digit are skipped. Without --trace a
+ * week of the synthetic weather of the demo mode is used. Each row is fed in as the values of all
+ * boxes, as if the UI task had taken over a snapshot with a history tick.
+ *
+ * One JSON object per case goes to stdout, a table to stderr:
+ *   {"bench":"updateHistory","trace":"synthetic","rows":5040,"calls":..,
+ *    "ns_per_call":..,"ns_min":..,"allocs_per_call":..,"bus_bytes_per_call":..,
+ *    "pixels_per_call":..,"windows_per_call":..}
+ * ns_per_call is the median over the passes of the mean call time, ns_min
+ * the fastest single call; the cost of reading the clock is subtracted.
+ * allocs_per_call is -1 where malloc cannot be interposed (not glibc or a
+ * sanitizer build).
+ *
+ * A detailIncremental call, one history tick on the detail page, must send
+ * at most MAX_INCREMENTAL_SHARE of the bus bytes of a detailFull call;
+ * otherwise the exit code is 1.
+ *
+ * Build and run from Software/ (or pio run -e bench):
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src $(find lib -mindepth 1 -maxdepth 1 -type d -printf '-I%p ') \
+ *       tools/render_bench.cpp src/main.cpp $(find lib native/mock/src -name '*.cpp') -o render_bench
+ *   ./render_bench [--trace=FILE] [--passes=N] [--box=N] > results.jsonl
+ */
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <compositor.h>
+#include <config.h>
+#include <display.h>
+#include <graph.h>
+#include <host.h>
+#include <logo.h>
+#include <glyphs.h>
+#include <math.h>
+#include <methods.h>
+#include <sprites.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <synthetic.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+void setup();
+
+extern TFT_eSPI tft;
+extern bool detailGraphNeedsRedraw;
+extern int detailTier;
+extern float lastDetailValue;
+
+/// Bus bytes of a history tick on the detail page relative to a full graph redraw, at most
+#define MAX_INCREMENTAL_SHARE 0.33
+
+static uint64_t allocations = 0;  ///< malloc, calloc and realloc calls since start
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define BENCH_COUNTS_ALLOCATIONS 1
+
+///< glibc's allocator under its internal names, the public ones are wrapped below
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+extern "C" void* malloc(size_t size) {
+  allocations++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size) {
+  allocations++;
+  return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  allocations++;
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) {
+  __libc_free(ptr);
+}
+#else
+#define BENCH_COUNTS_ALLOCATIONS 0
+#endif
+
+/**
+ * @brief One history tick of the trace
+ */
+struct TraceRow {
+  uint32_t time;            ///< Seconds since the start of the recording
+  float values[NUM_BOXES];  ///< Box values in box order
+};
+
+/**
+ * @brief Read a CSV trace
+ * @return false if the file cannot be opened
+ */
+static bool readTrace(const char* path, std::vector<TraceRow>& rows) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+
+  char line[512];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] < '0' || line[0] > '9') continue;
+    TraceRow row;
+    char* p = line;
+    row.time = strtoul(p, &p, 10);
+    for (int c = 0; c < NUM_BOXES; c++) {
+      if (*p == ',') p++;
+      row.values[c] = strtof(p, &p);
+    }
+    rows.push_back(row);
+  }
+  fclose(f);
+  return true;
+}
+
+/**
+ * @brief Generate a week of readings from the synthetic weather of the demo mode
+ */
+static void synthesize(std::vector<TraceRow>& rows) {
+  SyntheticConfig config;
+  config.timeScale = 1;  ///< millis() counts simulated time
+  SyntheticWeather weather(config);
+  for (uint32_t t = 0; t < 7 * 24 * 3600; t += HISTORY_UPDATE_INTERVAL / 1000) {
+    TraceRow row;
+    row.time = t;
+    weather.boxValues(t * 1000, row.values);
+    rows.push_back(row);
+  }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double clockOverhead = 0;  ///< ns of one now() pair, subtracted from every call
+
+/**
+ * @brief Measure the cost of reading the clock twice
+ */
+static void calibrateClock() {
+  std::vector<double> samples;
+  for (int i = 0; i < 10001; i++) {
+    Clock::time_point a = Clock::now();
+    Clock::time_point b = Clock::now();
+    samples.push_back(std::chrono::duration<double, std::nano>(b - a).count());
+  }
+  std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+  clockOverhead = samples[samples.size() / 2];
+}
+
+/**
+ * @brief Time, allocations and bus traffic of one case
+ *
+ * begin() and end() bracket a single call; everything between two calls
+ * (feeding the trace, untimed setup) is not counted.
+ */
+struct Meter {
+  const char* name;            ///< Case name in the output
+  std::vector<double> passNs;  ///< Mean ns/call of every pass
+  double minNs = INFINITY;     ///< Fastest single call
+  uint64_t calls = 0;          ///< Calls over all passes
+  uint64_t allocs = 0;         ///< Allocations over all passes
+  TFTBusStats bus = {};        ///< Panel traffic over all passes
+
+  double passSum = 0;         ///< ns of the current pass
+  uint64_t passCalls = 0;     ///< Calls of the current pass
+  Clock::time_point start;    ///< Start of the running call
+  uint64_t startAllocs = 0;   ///< Allocation count at begin()
+  TFTBusStats startBus = {};  ///< Bus counters at begin()
+
+  explicit Meter(const char* name) : name(name) {}
+
+  void begin() {
+    startBus = tft.hostBus();
+    startAllocs = allocations;
+    start = Clock::now();
+  }
+
+  void end() {
+    Clock::time_point stop = Clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() - clockOverhead;
+    if (ns < 0) ns = 0;
+    allocs += allocations - startAllocs;
+    const TFTBusStats& now = tft.hostBus();
+    bus.bytes += now.bytes - startBus.bytes;
+    bus.pixels += now.pixels - startBus.pixels;
+    bus.windows += now.windows - startBus.windows;
+    passSum += ns;
+    passCalls++;
+    calls++;
+    if (ns < minNs) minNs = ns;
+  }
+
+  void endPass() {
+    if (passCalls > 0) passNs.push_back(passSum / passCalls);
+    passSum = 0;
+    passCalls = 0;
+  }
+
+  double median() const {
+    std::vector<double> sorted = passNs;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted.empty() ? 0 : sorted[sorted.size() / 2];
+  }
+};
+
+/**
+ * @brief Write one case as a JSON line to stdout and a table row to stderr
+ */
+static void report(const Meter& m, const char* trace, size_t rows) {
+  double n = m.calls > 0 ? (double)m.calls : 1;
+  double allocs = BENCH_COUNTS_ALLOCATIONS ? m.allocs / n : -1;
+  printf("{\"bench\":\"%s\",\"trace\":\"%s\",\"rows\":%zu,\"calls\":%llu,\"ns_per_call\":%.1f,\"ns_min\":%.1f,"
+         "\"allocs_per_call\":%.3f,\"bus_bytes_per_call\":%.1f,\"pixels_per_call\":%.1f,\"windows_per_call\":%.2f}\n",
+         m.name, trace, rows, (unsigned long long)m.calls, m.median(), m.calls > 0 ? m.minNs : 0, allocs, m.bus.bytes / n,
+         m.bus.pixels / n, m.bus.windows / n);
+  fprintf(stderr, "%-22s %9llu %12.1f %12.1f %9.3f %12.1f %10.1f %8.2f\n", m.name, (unsigned long long)m.calls, m.median(),
+          m.calls > 0 ? m.minNs : 0, allocs, m.bus.bytes / n, m.bus.pixels / n, m.bus.windows / n);
+}
+
+/**
+ * @brief Make a trace row the values shown in the boxes
+ */
+static void applyRow(const TraceRow& row) {
+  for (int i = 0; i < NUM_BOXES; i++) *boxes[i].value = row.values[i];
+}
+
+static GlyphAtlas boxAtlas(&tft);          ///< Font 4 value characters and units, as in initValueGlyphs()
+static GlyphAtlas detailValueAtlas(&tft);  ///< Detail value characters
+static GlyphAtlas detailUnitAtlas(&tft);   ///< Detail units
+static int boxUnitGlyph[NUM_BOXES];        ///< Unit token of each box in boxAtlas
+static int detailUnitGlyph[NUM_BOXES];     ///< Unit token of each box in detailUnitAtlas
+
+/**
+ * @brief Whether a box shows the temperature, drawn with a degree circle
+ */
+static bool isTemperature(int i) {
+  return strcmp(boxes[i].title, "Temperatur") == 0;
+}
+
+/**
+ * @brief Build the atlases the firmware builds in initValueGlyphs()
+ */
+static void buildAtlases() {
+  static const char chars[] = "0123456789.-";
+  char boxUnit[NUM_BOXES][8];
+  int16_t boxWidth = 0, valueWidth = 0, unitWidth = 0;
+
+  boxAtlas.setFont(nullptr, 4);
+  detailValueAtlas.setFont(&FreeSansBold24pt7b);
+  detailUnitAtlas.setFont(&FreeSansBold12pt7b);
+  for (const char* c = chars; *c; c++) {
+    char twice[3] = {*c, *c, 0};
+    boxWidth += boxAtlas.measure(twice);
+    valueWidth += detailValueAtlas.measure(twice);
+  }
+  for (int i = 0; i < NUM_BOXES; i++) {
+    snprintf(boxUnit[i], sizeof(boxUnit[i]), isTemperature(i) ? "  C" : " %s", boxes[i].unit);
+    boxWidth += boxAtlas.measure(boxUnit[i]);
+    unitWidth += detailUnitAtlas.measure(isTemperature(i) ? "C" : boxes[i].unit) + (isTemperature(i) ? 10 : 0);
+  }
+  boxAtlas.create(boxWidth, 40, TEXT_INK, TEXT_INK_BACKGROUND, TL_DATUM, 1);
+  detailValueAtlas.create(valueWidth, 60, TEXT_INK, TEXT_INK_BACKGROUND, ML_DATUM, 1);
+  detailUnitAtlas.create(unitWidth, 60, TEXT_INK, TEXT_INK_BACKGROUND, ML_DATUM, 1);
+
+  for (const char* c = chars; *c; c++) {
+    char single[2] = {*c, 0};
+    boxAtlas.add(single, 10);
+    detailValueAtlas.add(single, 28);
+  }
+  int cWidth = boxAtlas.measure("C");
+  for (int i = 0; i < NUM_BOXES; i++) {
+    boxUnitGlyph[i] = boxAtlas.add(boxUnit[i], 10);
+    detailUnitGlyph[i] = detailUnitAtlas.add(isTemperature(i) ? "C" : boxes[i].unit, 32, isTemperature(i) ? 10 : 0);
+    if (isTemperature(i) && boxUnitGlyph[i] >= 0) {
+      const Glyph& g = boxAtlas.glyph(boxUnitGlyph[i]);
+      boxAtlas.canvas().drawCircle(g.x + g.width - cWidth - 2, 10, 3, TEXT_INK);
+      boxAtlas.canvas().drawCircle(g.x + g.width - cWidth - 2, 10, 2, TEXT_INK);
+      boxAtlas.updateInk(boxUnitGlyph[i]);
+    }
+    if (isTemperature(i) && detailUnitGlyph[i] >= 0) {
+      const Glyph& g = detailUnitAtlas.glyph(detailUnitGlyph[i]);
+      detailUnitAtlas.canvas().drawCircle(g.x + 5, 23, 5, TEXT_INK);
+      detailUnitAtlas.updateInk(detailUnitGlyph[i]);
+    }
+  }
+}
+
+/**
+ * @brief Box value text drawn with font 4, the path before the glyph atlas
+ */
+static void boxTextFont(TFT_eSprite& spr, int i, float value) {
+  char text[32];
+  snprintf(text, sizeof(text), isTemperature(i) ? "%.*f  C" : "%.*f %s", boxes[i].decimals, value, boxes[i].unit);
+  spr.setTextColor(TEXT_INK, TEXT_INK_BACKGROUND);
+  spr.setTextDatum(TL_DATUM);
+  int textW = spr.textWidth(text, 4);
+  int x = (boxes[i].w - 20) / 2 - textW / 2;
+  spr.drawString(text, x, 10, 4);
+  if (isTemperature(i)) {
+    int cWidth = spr.textWidth("C", 4);
+    spr.drawCircle(x + textW - cWidth - 2, 10, 3, TEXT_INK);
+    spr.drawCircle(x + textW - cWidth - 2, 10, 2, TEXT_INK);
+  }
+}
+
+/**
+ * @brief Box value text composed from the atlas, as renderBoxValue() does
+ */
+static void boxTextAtlas(TFT_eSprite& spr, int i, float value) {
+  char text[20];
+  snprintf(text, sizeof(text), "%.*f", boxes[i].decimals, value);
+  int textW = boxAtlas.textWidth(text) + boxAtlas.advance(boxUnitGlyph[i]);
+  int x = (boxes[i].w - 20) / 2 - textW / 2;
+  x += boxAtlas.drawText(spr, text, x);
+  boxAtlas.drawGlyph(spr, boxUnitGlyph[i], x);
+}
+
+/**
+ * @brief Detail value and unit drawn with the free fonts, the path before the glyph atlas
+ */
+static void detailTextFont(TFT_eSprite& spr, int i, float value) {
+  char text[20];
+  snprintf(text, sizeof(text), "%.*f", boxes[i].decimals, value);
+  const char* unit = isTemperature(i) ? "C" : boxes[i].unit;
+  spr.setTextDatum(MC_DATUM);
+  spr.setTextColor(TEXT_INK, TEXT_INK_BACKGROUND);
+  spr.setFreeFont(&FreeSansBold24pt7b);
+  int valueWidth = spr.textWidth(text);
+  int startX = (SCREEN_WIDTH - 40 - valueWidth - 10) / 2;
+  spr.drawString(text, startX + valueWidth / 2, 28, 1);
+  spr.setFreeFont(&FreeSansBold12pt7b);
+  int unitWidth = spr.textWidth(unit);
+  spr.drawString(unit, startX + valueWidth + 15 + unitWidth / 2, 32, 1);
+  if (isTemperature(i)) spr.drawCircle(startX + valueWidth + 10, 23, 5, TEXT_INK);
+}
+
+/**
+ * @brief Detail value and unit composed from the atlases, as drawDetailPageWithSprite() does
+ */
+static void detailTextAtlas(TFT_eSprite& spr, int i, float value) {
+  char text[20];
+  snprintf(text, sizeof(text), "%.*f", boxes[i].decimals, value);
+  int valueWidth = detailValueAtlas.textWidth(text);
+  int startX = (SCREEN_WIDTH - 40 - valueWidth - 10) / 2;
+  detailValueAtlas.drawText(spr, text, startX);
+  detailUnitAtlas.drawGlyph(spr, detailUnitGlyph[i], startX + valueWidth + 15);
+}
+
+/**
+ * @brief Value of an option of the form --name=value
+ * @return nullptr if arg is a different option
+ */
+static const char* option(const char* arg, const char* name) {
+  size_t len = strlen(name);
+  return strncmp(arg, name, len) == 0 && arg[len] == '=' ? arg + len + 1 : nullptr;
+}
+
+int main(int argc, char** argv) {
+  const char* tracePath = nullptr;
+  int passes = 3;
+  int box = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value;
+    if ((value = option(argv[i], "--trace"))) {
+      tracePath = value;
+    } else if ((value = option(argv[i], "--passes"))) {
+      passes = atoi(value);
+    } else if ((value = option(argv[i], "--box"))) {
+      box = atoi(value);
+    } else {
+      fprintf(stderr, "usage: %s [--trace=FILE] [--passes=N] [--box=N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (passes < 1 || box < 0 || box >= NUM_BOXES) {
+    fprintf(stderr, "--passes must be positive and --box between 0 and %d\n", NUM_BOXES - 1);
+    return 2;
+  }
+
+  std::vector<TraceRow> trace;
+  if (tracePath) {
+    if (!readTrace(tracePath, trace)) {
+      fprintf(stderr, "%s: cannot open\n", tracePath);
+      return 1;
+    }
+  } else {
+    synthesize(trace);
+  }
+  if (trace.empty()) {
+    fprintf(stderr, "empty trace\n");
+    return 1;
+  }
+  const char* traceName = tracePath ? tracePath : "synthetic";
+  const uint32_t traceMs = (trace.back().time - trace.front().time) * 1000 + HISTORY_UPDATE_INTERVAL;
+
+  ///< The firmware's own start-up against a fresh flash log; the clock stays put, so the sensor task never runs
+  char fsRoot[] = "/tmp/render_bench.XXXXXX";
+  if (!mkdtemp(fsRoot)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  hostFsRoot(fsRoot);
+  hostSerialOutput(nullptr);
+  setup();
+  calibrateClock();
+
+  fprintf(stderr, "trace %s: %zu rows, %d passes, detail box %d, clock overhead %.1f ns, %llu allocations in setup()\n", traceName,
+          trace.size(), passes, box, clockOverhead, (unsigned long long)allocations);
+  fprintf(stderr, "%-22s %9s %12s %12s %9s %12s %10s %8s\n", "bench", "calls", "ns/call", "ns min", "allocs", "bus bytes", "pixels", "windows");
+
+  ///< History: one call per box and tick, the ring wraps after the first day of the trace
+  Meter history("updateHistory");
+  for (int pass = 0; pass < passes; pass++) {
+    for (const TraceRow& row : trace) {
+      for (int i = 0; i < NUM_BOXES; i++) {
+        history.begin();
+        updateHistory(i, row.values[i]);
+        history.end();
+      }
+    }
+    history.endPass();
+  }
+  report(history, traceName, trace.size());
+
+  ///< Main page: updateValue() only damages widgets, the frame draws them
+  Meter value("updateValue");
+  Meter frame("composeFrame");
+  for (int pass = 0; pass < passes; pass++) {
+    uint32_t offset = pass * traceMs;
+    for (const TraceRow& row : trace) {
+      applyRow(row);
+      for (int i = 0; i < NUM_BOXES; i++) {
+        value.begin();
+        updateValue(i);
+        value.end();
+      }
+      frame.begin();
+      composeFrame(offset + (row.time - trace.front().time) * 1000);
+      displayFlush();
+      frame.end();
+    }
+    value.endPass();
+    frame.endPass();
+  }
+  report(value, traceName, trace.size());
+  report(frame, traceName, trace.size());
+
+  ///< Detail page with a new history tick per call, the graph scrolls by one sample
+  Meter incremental("detailIncremental");
+  detailTier = TIER_RAW;
+  lastDetailValue = NAN;
+  drawDetailPageTitle(box);
+  invalidateGraph();
+  for (int pass = 0; pass < passes; pass++) {
+    for (const TraceRow& row : trace) {
+      applyRow(row);
+      for (int i = 0; i < NUM_BOXES; i++) updateHistory(i, row.values[i]);
+      detailGraphNeedsRedraw = true;
+      incremental.begin();
+      drawDetailPageWithSprite(box);
+      incremental.end();
+    }
+    incremental.endPass();
+  }
+  report(incremental, traceName, trace.size());
+
+  ///< Detail page with the whole graph drawn again, like after a tier switch
+  Meter full("detailFull");
+  for (int pass = 0; pass < passes; pass++) {
+    for (const TraceRow& row : trace) {
+      applyRow(row);
+      invalidateGraph();
+      detailGraphNeedsRedraw = true;
+      full.begin();
+      drawDetailPageWithSprite(box);
+      full.end();
+    }
+    full.endPass();
+  }
+  report(full, traceName, trace.size());
+
+  ///< Value text with the font and from the atlas, every box and tick into its pool sprite
+  buildAtlases();
+  Meter boxFont("boxTextFont");
+  Meter boxGlyphs("boxTextAtlas");
+  for (int pass = 0; pass < passes; pass++) {
+    for (const TraceRow& row : trace) {
+      for (int i = 0; i < NUM_BOXES; i++) {
+        TFT_eSprite& spr = poolSprite(SPRITE_BOX_VALUE + i);
+        spr.fillSprite(TEXT_INK_BACKGROUND);
+        boxFont.begin();
+        boxTextFont(spr, i, row.values[i]);
+        boxFont.end();
+        spr.fillSprite(TEXT_INK_BACKGROUND);
+        boxGlyphs.begin();
+        boxTextAtlas(spr, i, row.values[i]);
+        boxGlyphs.end();
+      }
+    }
+    boxFont.endPass();
+    boxGlyphs.endPass();
+  }
+  report(boxFont, traceName, trace.size());
+  report(boxGlyphs, traceName, trace.size());
+
+  Meter detailFont("detailTextFont");
+  Meter detailGlyphs("detailTextAtlas");
+  TFT_eSprite& valueSpr = poolSprite(SPRITE_DETAIL_VALUE);
+  for (int pass = 0; pass < passes; pass++) {
+    for (const TraceRow& row : trace) {
+      valueSpr.fillSprite(TEXT_INK_BACKGROUND);
+      detailFont.begin();
+      detailTextFont(valueSpr, box, row.values[box]);
+      detailFont.end();
+      valueSpr.fillSprite(TEXT_INK_BACKGROUND);
+      detailGlyphs.begin();
+      detailTextAtlas(valueSpr, box, row.values[box]);
+      detailGlyphs.end();
+    }
+    detailFont.endPass();
+    detailGlyphs.endPass();
+  }
+  report(detailFont, traceName, trace.size());
+  report(detailGlyphs, traceName, trace.size());
+
+  Meter layout("layoutBoxes");
+  for (int pass = 0; pass < passes; pass++) {
+    for (size_t i = 0; i < trace.size(); i++) {
+      layout.begin();
+      layoutBoxes();
+      layout.end();
+    }
+    layout.endPass();
+  }
+  report(layout, traceName, trace.size());
+
+  Meter logo("drawLogo");
+  for (int pass = 0; pass < passes; pass++) {
+    for (size_t i = 0; i < trace.size(); i++) {
+      logo.begin();
+      drawLogo();
+      logo.end();
+    }
+    logo.endPass();
+  }
+  report(logo, traceName, trace.size());
+
+  ///< Scrolling the graph only pays off if a tick sends a small part of a full redraw
+  double share = full.bus.bytes > 0 ? (double)incremental.bus.bytes / full.bus.bytes : 0;
+  if (share > MAX_INCREMENTAL_SHARE) {
+    fprintf(stderr, "FAIL detailIncremental sends %.1f%% of the bus bytes of detailFull, at most %.1f%% allowed\n", share * 100,
+            MAX_INCREMENTAL_SHARE * 100);
+    return 1;
+  }
+  fprintf(stderr, "detailIncremental sends %.1f%% of the bus bytes of detailFull\n", share * 100);
+  return 0;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file snapshot_check.cpp
+ * @brief Host check of the TripleBuffer exchange with real threads
+ *
+ * A std::thread producer publishes --count snapshots as fast as it can,
+ * every field derived from the version, while the consumer on the main
+ * thread polls update() the way the UI task does. The consumer checks that
+ * versions only grow, that every snapshot it reads is whole (all fields
+ * from the same publish) and that the last snapshot arrives once the
+ * producer is done. Build it with -fsanitize=thread as well to have the
+ * memory ordering checked, not only its outcome.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -pthread -Ilib/snapshot tools/snapshot_check.cpp -o snapshot_check
+ *   ./snapshot_check [--count=N]
+ */
+
+#include <snapshot.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+
+/**
+ * @brief Snapshot of one version, each field a different function of it
+ */
+static SensorSnapshot makeSnapshot(uint32_t version) {
+  SensorSnapshot s;
+  s.version = version;
+  s.historyTick = version / 7;
+  s.ambientTick = version / 3;
+  s.temp = (float)(version % 1000) * 0.1F;
+  s.humid = (float)(version % 997);
+  s.pressure = 900.0F + (float)(version % 2003) * 0.1F;
+  s.gas = (float)(version % 991) + 0.5F;
+  s.ambient = (float)(version % 65521);
+  s.white = (float)(version % 65519);
+  s.uv = (float)(version % 16381);
+  s.uvIndex = (float)(version % 111) * 0.1F;
+  s.proximity = (float)(version % 4093);
+  return s;
+}
+
+/**
+ * @brief Whether every field of a snapshot belongs to its version
+ */
+static bool isWhole(const SensorSnapshot& s) {
+  SensorSnapshot expected = makeSnapshot(s.version);
+  return memcmp(&s, &expected, sizeof(s)) == 0;
+}
+
+int main(int argc, char** argv) {
+  uint32_t count = 5000000;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--count=", 8) == 0) {
+      count = strtoul(argv[i] + 8, nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--count=N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  TripleBuffer<SensorSnapshot> exchange;
+  std::atomic<bool> done{false};
+  std::thread producer([&] {
+    for (uint32_t version = 1; version <= count; version++) {
+      exchange.publish(makeSnapshot(version));
+      if (version % 16 == 0) std::this_thread::yield();  ///< Hand over often on a single core too
+    }
+    done.store(true, std::memory_order_release);
+  });
+
+  uint32_t last = 0, updates = 0, polls = 0, failures = 0;
+  for (;;) {
+    ///< Read done first: once it is set, the last publish is visible to update()
+    bool finished = done.load(std::memory_order_acquire);
+    polls++;
+    if (exchange.update()) {
+      const SensorSnapshot& s = exchange.read();
+      updates++;
+      if (s.version <= last) {
+        if (failures++ < 10) printf("FAIL version %u after %u\n", s.version, last);
+      }
+      if (!isWhole(s)) {
+        if (failures++ < 10) printf("FAIL torn snapshot of version %u\n", s.version);
+      }
+      last = s.version;
+    } else if (exchange.read().version != last) {
+      if (failures++ < 10) printf("FAIL front slot changed to %u without update()\n", exchange.read().version);
+    } else {
+      std::this_thread::yield();
+    }
+    if (finished && !exchange.update()) break;
+    if (finished) {
+      if (failures++ < 10) printf("FAIL update() true after the final read\n");
+      break;
+    }
+  }
+  producer.join();
+
+  if (last != count) {
+    if (failures++ < 10) printf("FAIL last version read %u, published %u\n", last, count);
+  }
+  printf("%u snapshots published, %u taken over in %u polls, last version %u\n", count, updates, polls, last);
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
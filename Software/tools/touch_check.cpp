@@ -0,0 +1,227 @@
+/**
+ * @file touch_check.cpp
+ * @brief Host check of the pen state machine and the TOUCH_IRQ glue
+ *
+ * Runs scripted pen-IRQ levels and position samples through touchStep()
+ * and checks the events that come out: a press only after the line was
+ * stable for TOUCH_DEBOUNCE_TIME, no release for a bounce while lifting,
+ * moves below TOUCH_MOVE_THRESHOLD ignored and consecutive moves merged,
+ * and a full queue dropping its oldest events. The last script drives the
+ * TOUCH_IRQ pin and the mock controller through pollTouch() on the
+ * virtual clock. The exit code is 1 on a failed check.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src -Ilib/config -Ilib/touch \
+ *       tools/touch_check.cpp lib/touch/touch.cpp native/mock/src/Arduino.cpp native/mock/src/host.cpp -o touch_check
+ *   ./touch_check
+ */
+
+#include <Arduino.h>
+#include <TFT_Touch.h>
+#include <config.h>
+#include <host.h>
+#include <stdio.h>
+#include <touch.h>
+
+/// Controller read by pollTouch(), the firmware defines it in main.cpp
+TFT_Touch touch = TFT_Touch(TOUCH_CS, TOUCH_CLK, TOUCH_DIN, TOUCH_DOUT);
+
+static int failures = 0;  ///< Failed checks so far
+
+/// Count and print a failed check
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+/**
+ * @brief One pass of the poll loop: pen level and, if asked for, a sample
+ */
+struct Pass {
+  uint32_t time;  ///< millis() of the pass
+  bool penDown;   ///< Level of the pen-IRQ line
+  bool pressure;  ///< The controller reports enough pressure for a sample
+  int16_t x, y;   ///< Position the controller would return
+};
+
+/**
+ * @brief Run passes the way pollTouch() does, sampling only when asked
+ */
+static void run(TouchState& s, const Pass* passes, int count) {
+  for (int i = 0; i < count; i++) {
+    const Pass& p = passes[i];
+    bool sampled = p.penDown && touchWantsSample(s, p.time) && p.pressure;
+    touchStep(s, p.time, p.penDown, sampled, p.x, p.y);
+  }
+}
+
+/**
+ * @brief Check the next event of the queue
+ */
+static void expectEvent(TouchState& s, TouchEventType type, int16_t x, int16_t y, uint32_t time, int line) {
+  TouchEvent e;
+  if (!touchPopEvent(s, e)) {
+    failures++;
+    printf("FAIL %s:%d: expected event %d, queue empty\n", __FILE__, line, type);
+    return;
+  }
+  if (e.type != type || e.x != x || e.y != y || e.time != time) {
+    failures++;
+    printf("FAIL %s:%d: event %d (%d, %d) at %u, expected %d (%d, %d) at %u\n", __FILE__, line, e.type, e.x, e.y, e.time, type, x, y, time);
+  }
+}
+
+#define EXPECT_EVENT(s, type, x, y, time) expectEvent(s, type, x, y, time, __LINE__)
+#define EXPECT_EMPTY(s) CHECK((s).count == 0, "%u events left in the queue", (s).count)
+
+/**
+ * @brief Press debounce: a short contact is ignored, a stable one pressed
+ */
+static void checkPressDebounce() {
+  TouchState s = {};
+  const Pass bounce[] = {{1000, true, true, 10, 20}, {1005, false, false, 0, 0}, {1010, true, true, 10, 20}, {1025, false, false, 0, 0}};
+  run(s, bounce, 4);
+  CHECK(s.phase == TOUCH_IDLE, "phase %d after a bouncing contact", s.phase);
+  EXPECT_EMPTY(s);
+
+  ///< Stable from 2000, no pressure on the first sample, pressed on the retry
+  const Pass stable[] = {{2000, true, true, 50, 60},  {2010, true, true, 50, 60}, {2019, true, true, 50, 60},
+                         {2020, true, false, 50, 60}, {2025, true, true, 51, 61}, {2030, true, true, 52, 62}};
+  run(s, stable, 6);
+  CHECK(s.phase == TOUCH_DOWN, "phase %d after a stable contact", s.phase);
+  EXPECT_EVENT(s, TOUCH_PRESS, 52, 62, 2030);
+  EXPECT_EMPTY(s);
+}
+
+/**
+ * @brief Release debounce: a bounce while lifting keeps the press
+ */
+static void checkReleaseBounce() {
+  TouchState s = {};
+  const Pass press[] = {{0, true, true, 100, 100}, {20, true, true, 100, 100}};
+  run(s, press, 2);
+  EXPECT_EVENT(s, TOUCH_PRESS, 100, 100, 20);
+
+  const Pass bounce[] = {{30, false, false, 0, 0}, {35, true, true, 100, 100}, {40, false, false, 0, 0}, {55, true, true, 101, 100}};
+  run(s, bounce, 4);
+  CHECK(s.phase == TOUCH_DOWN, "phase %d after a bounce while lifting", s.phase);
+  EXPECT_EMPTY(s);
+
+  const Pass lift[] = {{60, false, false, 0, 0}, {79, false, false, 0, 0}, {80, false, false, 0, 0}};
+  run(s, lift, 2);
+  EXPECT_EMPTY(s);
+  run(s, lift + 2, 1);
+  CHECK(s.phase == TOUCH_IDLE, "phase %d after lifting", s.phase);
+  EXPECT_EVENT(s, TOUCH_RELEASE, 100, 100, 80);
+  EXPECT_EMPTY(s);
+}
+
+/**
+ * @brief Moves: jitter is ignored, consecutive moves merge into the newest
+ */
+static void checkMoveMerging() {
+  TouchState s = {};
+  const int t = TOUCH_SAMPLE_INTERVAL;
+  const int d = TOUCH_MOVE_THRESHOLD;
+  const Pass drag[] = {
+      {0, true, true, 200, 100},
+      {20, true, true, 200, 100},
+      {20 + t, true, true, 200 + d - 1, 100},          ///< Below the threshold
+      {20 + 2 * t, true, true, 200 + d, 100},          ///< First move
+      {20 + 3 * t, true, true, 200 + d, 100 + 2 * d},  ///< Merged into it
+      {20 + 4 * t, true, true, 200 + 3 * d, 100 + 2 * d},
+  };
+  run(s, drag, 6);
+  EXPECT_EVENT(s, TOUCH_PRESS, 200, 100, 20);
+  EXPECT_EVENT(s, TOUCH_MOVE, 200 + 3 * d, 100 + 2 * d, 20 + 4 * t);
+  EXPECT_EMPTY(s);
+
+  ///< A move after the consumer took the last one starts a new event
+  const Pass more[] = {{20 + 5 * t, true, true, 200 + 5 * d, 100 + 2 * d}};
+  run(s, more, 1);
+  EXPECT_EVENT(s, TOUCH_MOVE, 200 + 5 * d, 100 + 2 * d, 20 + 5 * t);
+  EXPECT_EMPTY(s);
+}
+
+/**
+ * @brief Overflow: a full queue keeps the newest TOUCH_QUEUE_LENGTH events
+ */
+static void checkOverflow() {
+  TouchState s = {};
+  const int taps = TOUCH_QUEUE_LENGTH;  ///< Two events each, twice the queue
+  for (int i = 0; i < taps; i++) {
+    uint32_t t0 = 1000 * i;
+    int16_t x = 10 * i;
+    const Pass tap[] = {{t0, true, true, x, 5}, {t0 + 20, true, true, x, 5}, {t0 + 30, false, false, 0, 0}, {t0 + 50, false, false, 0, 0}};
+    run(s, tap, 4);
+  }
+  CHECK(s.count == TOUCH_QUEUE_LENGTH, "%u events queued, expected %d", s.count, TOUCH_QUEUE_LENGTH);
+  for (int i = taps / 2; i < taps; i++) {
+    EXPECT_EVENT(s, TOUCH_PRESS, 10 * i, 5, 1000 * i + 20);
+    EXPECT_EVENT(s, TOUCH_RELEASE, 10 * i, 5, 1000 * i + 50);
+  }
+  EXPECT_EMPTY(s);
+}
+
+/**
+ * @brief Move the virtual clock to a millis() value
+ */
+static void advanceTo(uint32_t ms) {
+  if (ms * 1000ULL > hostMicros()) hostSkipMicros(ms * 1000ULL - hostMicros());
+}
+
+/**
+ * @brief The glue: no sampling without the pen interrupt, events from pollTouch()
+ */
+static void checkIrqGlue() {
+  TouchEvent e;
+  touchBegin();
+
+  ///< Pressure without the interrupt, e.g. a stale reading: nothing happens
+  touch.hostPress(30, 40);
+  advanceTo(100);
+  pollTouch();
+  advanceTo(150);
+  pollTouch();
+  CHECK(!nextTouchEvent(e), "event %d without a pen interrupt", e.type);
+
+  ///< Pen down: the falling edge fires, the press follows after the debounce time
+  hostSetPin(TOUCH_IRQ, LOW);
+  for (uint32_t t = 200; t <= 200 + TOUCH_DEBOUNCE_TIME; t += 5) {
+    advanceTo(t);
+    pollTouch();
+  }
+  CHECK(nextTouchEvent(e) && e.type == TOUCH_PRESS && e.x == 30 && e.y == 40 && e.time == 200 + TOUCH_DEBOUNCE_TIME, "no press at (30, 40) after the debounce time");
+
+  touch.hostPress(60, 40);
+  for (uint32_t t = 225; t <= 260; t += 5) {
+    advanceTo(t);
+    pollTouch();
+  }
+  CHECK(nextTouchEvent(e) && e.type == TOUCH_MOVE && e.x == 60 && e.y == 40, "no move to (60, 40)");
+
+  touch.hostRelease();
+  hostSetPin(TOUCH_IRQ, HIGH);
+  for (uint32_t t = 265; t <= 300; t += 5) {
+    advanceTo(t);
+    pollTouch();
+  }
+  CHECK(nextTouchEvent(e) && e.type == TOUCH_RELEASE && e.x == 60 && e.y == 40 && e.time == 265 + TOUCH_DEBOUNCE_TIME, "no release at (60, 40)");
+  CHECK(!nextTouchEvent(e), "event %d after the release", e.type);
+}
+
+int main() {
+  hostSerialOutput(nullptr);
+  checkPressDebounce();
+  checkReleaseBounce();
+  checkMoveMerging();
+  checkOverflow();
+  checkIrqGlue();
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}
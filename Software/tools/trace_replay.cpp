@@ -0,0 +1,207 @@
+/**
+ * @file trace_replay.cpp
+ * @brief Replay of a recorded sensor trace through the firmware on the host
+ *
+ * Boots the firmware with a TraceSource in place of the sensors and runs
+ * loop() and the sensor task on the virtual clock until one history tick
+ * after the last record. The sensor jobs read the recorded values at their
+ * own times, so everything from updateValues() on runs the same code as on
+ * the station. The trace is either the file a SENSOR_TRACE=2 build leaves
+ * on LittleFS or a capture of the USB CDC output of a SENSOR_TRACE=1 build,
+ * text in between and all.
+ *
+ * Nothing depends on the wall clock: the same trace and --loop-us give the
+ * same history, frames and digest on every run and at every --speed, so
+ * two firmware versions can be compared by their digests and CSV output.
+ * --speed only paces the run, e.g. --speed=60 plays an hour in a minute;
+ * the default 0 runs as fast as possible.
+ *
+ * At the end the trace, graph, box redraw and bus counters are printed.
+ * The digest is FNV-1a over the history values of every tick and the
+ * final panel. --csv writes the history ticks in the format of
+ * archive_bench and render_bench:
+ *   seconds,temp,humid,pressure,ambient,white,gas,uv,uvIndex
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -DARDUINO=10819 -Inative/mock/src $(find lib -mindepth 1 -maxdepth 1 -type d -printf '-I%p ') \
+ *       tools/trace_replay.cpp src/main.cpp $(find lib native/mock/src -name '*.cpp') -o trace_replay
+ *   ./trace_replay [--loop-us=N] [--speed=X] [--csv=FILE] [--screenshot=FILE] trace.bin
+ */
+
+#include <Adafruit_BME680.h>
+#include <Adafruit_LTR390.h>
+#include <Adafruit_VCNL4040.h>
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <config.h>
+#include <display.h>
+#include <graph.h>
+#include <host.h>
+#include <math.h>
+#include <methods.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <trace.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+void setup();
+void loop();
+
+extern TFT_eSPI tft;
+extern Adafruit_BME680 bme;
+extern Adafruit_LTR390 ltr;
+extern Adafruit_VCNL4040 vcnl;
+
+/**
+ * @brief Value of an option of the form --name=value
+ * @return nullptr if arg is a different option
+ */
+static const char* option(const char* arg, const char* name) {
+  size_t len = strlen(name);
+  return strncmp(arg, name, len) == 0 && arg[len] == '=' ? arg + len + 1 : nullptr;
+}
+
+/**
+ * @brief Read a whole file
+ * @return false if it cannot be read
+ */
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return false;
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) data.insert(data.end(), buffer, buffer + n);
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+/**
+ * @brief Add bytes to an FNV-1a hash
+ */
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  for (size_t i = 0; i < len; i++) hash = (hash ^ p[i]) * 0x100000001B3ULL;
+  return hash;
+}
+
+int main(int argc, char** argv) {
+  uint64_t loopUs = 1000;
+  double speed = 0;
+  const char* csvPath = nullptr;
+  const char* screenshot = nullptr;
+  const char* tracePath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    const char* value;
+    if ((value = option(argv[i], "--loop-us"))) {
+      loopUs = strtoull(value, nullptr, 10);
+    } else if ((value = option(argv[i], "--speed"))) {
+      speed = atof(value);
+    } else if ((value = option(argv[i], "--csv"))) {
+      csvPath = value;
+    } else if ((value = option(argv[i], "--screenshot"))) {
+      screenshot = value;
+    } else if (argv[i][0] != '-' && tracePath == nullptr) {
+      tracePath = argv[i];
+    } else {
+      tracePath = nullptr;
+      break;
+    }
+  }
+  if (tracePath == nullptr || loopUs == 0) {
+    fprintf(stderr, "usage: %s [--loop-us=N] [--speed=X] [--csv=FILE] [--screenshot=FILE] trace.bin\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<uint8_t> data;
+  if (!readFile(tracePath, data)) {
+    fprintf(stderr, "%s: cannot read\n", tracePath);
+    return 1;
+  }
+  TraceSource source(data.data(), data.size());
+  if (source.stats().records == 0) {
+    fprintf(stderr, "%s: no trace blocks found\n", tracePath);
+    return 1;
+  }
+
+  FILE* csv = nullptr;
+  if (csvPath) {
+    csv = fopen(csvPath, "w");
+    if (csv == nullptr) {
+      fprintf(stderr, "%s: cannot write\n", csvPath);
+      return 1;
+    }
+    fprintf(csv, "seconds,temp,humid,pressure,ambient,white,gas,uv,uvIndex\n");
+  }
+
+  char fsRoot[] = "/tmp/trace_replay.XXXXXX";
+  if (!mkdtemp(fsRoot)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  hostFsRoot(fsRoot);
+  hostSerialOutput(nullptr);
+  bme.hostPresent = false;
+  ltr.hostPresent = false;
+  vcnl.hostPresent = false;
+  setSensorSource(&source);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  setup();
+
+  ///< Run until the last record has made it into a history tick
+  const uint64_t startUs = hostMicros();
+  const uint64_t endUs = (source.duration() + HISTORY_UPDATE_INTERVAL) * 1000ULL;
+  uint64_t digest = 0xCBF29CE484222325ULL;
+  uint32_t ticks = 0, lastCount = historyCount(0);
+  while (hostMicros() < endUs) {
+    loop();
+    hostAdvanceMicros(loopUs);
+
+    if (historyCount(0) != lastCount) {
+      lastCount = historyCount(0);
+      ticks++;
+      float values[NUM_BOXES];
+      for (int i = 0; i < NUM_BOXES; i++) {
+        if (!historyValue(i, 0, values[i])) values[i] = NAN;
+      }
+      digest = fnv1a(digest, values, sizeof(values));
+      if (csv) {
+        fprintf(csv, "%.0f", millis() / 1000.0);
+        for (int i = 0; i < NUM_BOXES; i++) fprintf(csv, ",%g", values[i]);
+        fprintf(csv, "\n");
+      }
+    }
+
+    if (speed > 0) {
+      auto due = wallStart + std::chrono::duration<double>((hostMicros() - startUs) / 1e6 / speed);
+      std::this_thread::sleep_until(std::chrono::time_point_cast<std::chrono::steady_clock::duration>(due));
+    }
+  }
+  digest = fnv1a(digest, tft.hostFrame(), (size_t)tft.width() * tft.height() * sizeof(uint16_t));
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  if (csv) fclose(csv);
+
+  const TraceStats& read = source.stats();
+  printf("trace: %u records in %u blocks, %u bytes of %zu, %u corrupt blocks skipped\n", read.records, read.blocks, read.bytes, data.size(), read.failed);
+  printf("%u history ticks, %.1f s replayed in %.2f s wall time\n", ticks, hostMicros() / 1e6, wall);
+  const GraphStats& graph = graphStats();
+  printf("graph: %u full, %u incremental redraws, %u pixels pushed\n", graph.fullRedraws, graph.incrementalRedraws, graph.pixelsPushed);
+  hostSerialOutput(stdout);  ///< The firmware's own report of redrawn and skipped box values
+  boxReport(Serial);
+  hostSerialOutput(nullptr);
+  const TFTBusStats& bus = tft.hostBus();
+  printf("bus: %llu bytes, %llu pixels, %lu windows\n", (unsigned long long)bus.bytes, (unsigned long long)bus.pixels, (unsigned long)bus.windows);
+  printf("digest: %016llx\n", (unsigned long long)digest);
+
+  if (screenshot && !tft.hostSavePpm(screenshot)) {
+    fprintf(stderr, "cannot write %s\n", screenshot);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file ytransform_bench.cpp
+ * @brief Host check and benchmark of the fixed-point graph transform
+ *
+ * For random series of every box the rows from codesToRows() are compared
+ * with an exact evaluation of the mapping by integer division, on the grid
+ * of the transform, and with the previous per-point
+ * map((long)(val * 100), ...). Both must match without any allowance.
+ *
+ * The transform deliberately differs from the previous map() in three
+ * cases, where the old rows were wrong: it truncated val * 100 in float, so
+ * 21.37 became 2136; it dropped digits finer than hundredths, e.g. of the UV
+ * index; and the product wrapped in 32 bits for wide ranges such as the raw
+ * UV counts. Every other point must give the pixel of map() exactly, where
+ * map() is fed the whole hundredths the old code meant to compute. These are
+ * the hundredths it did compute wherever the float truncation came out
+ * right. Points on a row boundary are included: the transform rounds the
+ * range ends to hundredths like map() does, so their float rounding does
+ * not decide the row. The exit code is 1 if any point fails either
+ * comparison. Finally both versions convert a plot-wide series in a loop
+ * and the time per point is printed.
+ *
+ * Build and run from Software/:
+ *   g++ -O2 -std=gnu++17 -Inative/mock/src -Ilib/config -Ilib/history -Ilib/ytransform \
+ *       tools/ytransform_bench.cpp lib/ytransform/ytransform.cpp lib/history/history.cpp -o ytransform_bench
+ *   ./ytransform_bench
+ */
+
+#include <float.h>
+#include <history.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ytransform.h>
+
+#include <chrono>
+#include <vector>
+
+#define PLOT_TOP 1                       ///< As in graph.cpp
+#define PLOT_BOTTOM (GRAPH_HEIGHT - 11)  ///< As in graph.cpp
+#define PLOT_COLUMNS (GRAPH_WIDTH - 2)   ///< As in graph.cpp
+
+/**
+ * @brief map() of the ESP32 Arduino core, long is 32 bits there
+ */
+static int32_t arduinoMap(int32_t x, int32_t inMin, int32_t inMax, int32_t outMin, int32_t outMax) {
+  int32_t run = inMax - inMin;
+  if (run == 0) return -1;
+  return (int32_t)((uint32_t)(x - inMin) * (uint32_t)(outMax - outMin)) / run + outMin;  ///< Wraps like the target
+}
+
+/**
+ * @brief Row of the previous graph code
+ */
+static int16_t oldRow(float val, float minValue, float maxValue) {
+  return arduinoMap((int32_t)(val * 100), (int32_t)(minValue * 100), (int32_t)(maxValue * 100), PLOT_BOTTOM, PLOT_TOP);
+}
+
+/**
+ * @brief Value in whole hundredths, as the previous graph code meant to compute it
+ * @param scale Scale the value was decoded with
+ * @param value Value, minimum or maximum of the range
+ * @param hundredths Receives the value * 100, rounded
+ * @return false if the value has digits finer than hundredths
+ */
+static bool wholeHundredths(const HistoryScale& scale, float value, int32_t& hundredths) {
+  double exact = value * 100.0;
+  hundredths = (int32_t)round(exact);
+  ///< The float rounding of decode() and of the widened range
+  return fabs(exact - hundredths) <= 100.0 * 4 * fmax(fabs(value), fabs(scale.offset)) * FLT_EPSILON;
+}
+
+/**
+ * @brief Exact row of a code, the range ends rounded to the grid of the transform
+ */
+static int16_t exactRow(const HistoryScale& scale, uint16_t code, float minValue, float maxValue) {
+  int64_t units = scale.step < 0.01F ? llround(1.0 / scale.step) : 100;
+  int64_t value = llround((double)scale.offset * units) + code * llround((double)scale.step * units);
+  int64_t low = llround((double)minValue * units);
+  int64_t high = llround((double)maxValue * units);
+  if (high <= low) high = low + 1;
+  int64_t r = value < low ? 0 : (value - low) * (PLOT_BOTTOM - PLOT_TOP) / (high - low);
+  if (r > PLOT_BOTTOM - PLOT_TOP) r = PLOT_BOTTOM - PLOT_TOP;
+  return PLOT_BOTTOM - (int16_t)r;
+}
+
+/**
+ * @brief Random walk of codes, amplitude a fraction of the code range
+ */
+static void makeSeries(std::vector<uint16_t>& codes, uint16_t center, uint32_t amplitude) {
+  int32_t code = center;
+  for (uint16_t& c : codes) {
+    code += (int32_t)(rand() % (2 * amplitude / 16 + 1)) - (int32_t)(amplitude / 16);
+    if (code < (int32_t)center - (int32_t)amplitude) code = center - amplitude;
+    if (code > (int32_t)center + (int32_t)amplitude) code = center + amplitude;
+    if (code < 0) code = 0;
+    if (code > 65535) code = 65535;
+    c = code;
+  }
+}
+
+/**
+ * @brief Y-range of a series as drawDetailPageWithSprite() computes it
+ */
+static void seriesRange(const HistoryScale& scale, const std::vector<uint16_t>& codes, float& minValue, float& maxValue) {
+  minValue = maxValue = scale.decode(codes.back());
+  for (uint16_t c : codes) {
+    if (scale.decode(c) < minValue) minValue = scale.decode(c);
+    if (scale.decode(c) > maxValue) maxValue = scale.decode(c);
+  }
+  if (fabs(maxValue - minValue) < 0.1) {
+    maxValue += 0.05;
+    minValue -= 0.05;
+  }
+}
+
+int main() {
+  const uint32_t amplitudes[] = {2, 20, 200, 2000, 20000};
+  const int seriesPerCase = 200;
+  int failures = 0;
+  srand(1);
+
+  printf("box  points    exact   = old  compared  = map()  truncated  wrapped  finer\n");
+  for (int box = 0; box < NUM_BOXES; box++) {
+    const HistoryScale& scale = historyScale(box);
+    uint64_t points = 0, exact = 0, sameOld = 0, compared = 0, matched = 0, truncated = 0, wrapped = 0, finer = 0;
+    std::vector<uint16_t> codes(PLOT_COLUMNS);
+    std::vector<int16_t> rows(PLOT_COLUMNS);
+
+    for (uint32_t amplitude : amplitudes) {
+      for (int s = 0; s < seriesPerCase; s++) {
+        makeSeries(codes, amplitude + rand() % (65536 - 2 * amplitude), amplitude);
+        float minValue, maxValue;
+        seriesRange(scale, codes, minValue, maxValue);
+        YTransform t = makeYTransform(scale, minValue, maxValue, PLOT_TOP, PLOT_BOTTOM);
+        codesToRows(t, codes.data(), PLOT_COLUMNS, rows.data());
+
+        bool wraps = fabs((double)maxValue - minValue) * 100.0 * (PLOT_BOTTOM - PLOT_TOP) > 2147483647.0;
+        int32_t low, high;
+        bool wholeRange = wholeHundredths(scale, minValue, low) & wholeHundredths(scale, maxValue, high);
+        for (int i = 0; i < PLOT_COLUMNS; i++) {
+          int16_t want = exactRow(scale, codes[i], minValue, maxValue);
+          points++;
+          if (rows[i] == want) {
+            exact++;
+          } else if (failures++ < 5) {
+            printf("FAIL box %d code %u: row %d, exact %d\n", box, codes[i], rows[i], want);
+          }
+
+          float value = scale.decode(codes[i]);
+          int16_t old = oldRow(value, minValue, maxValue);
+          if (old == rows[i]) sameOld++;
+
+          ///< Pixel-exact against map() wherever its result was meant to be right
+          int32_t v;
+          bool wholeValue = wholeHundredths(scale, value, v);
+          if (wraps) {
+            wrapped++;
+            continue;
+          }
+          if (!wholeRange || !wholeValue) {
+            finer++;
+            continue;
+          }
+          int16_t meant = arduinoMap(v, low, high, PLOT_BOTTOM, PLOT_TOP);
+          if (old != meant) truncated++;
+          compared++;
+          if (meant == rows[i]) {
+            matched++;
+          } else if (failures++ < 5) {
+            printf("FAIL box %d code %u: row %d, map() %d\n", box, codes[i], rows[i], meant);
+          }
+        }
+      }
+    }
+    printf("%3d %7llu %8llu %6.2f%% %9llu %8llu %10llu %8llu %6llu\n", box, (unsigned long long)points, (unsigned long long)exact,
+           100.0 * sameOld / points, (unsigned long long)compared, (unsigned long long)matched, (unsigned long long)truncated,
+           (unsigned long long)wrapped, (unsigned long long)finer);
+  }
+
+  ///< Throughput on one plot-wide series of the gas box
+  const HistoryScale& scale = historyScale(5);
+  std::vector<uint16_t> codes(PLOT_COLUMNS);
+  std::vector<int16_t> rows(PLOT_COLUMNS);
+  makeSeries(codes, 20000, 2000);
+  float minValue, maxValue;
+  seriesRange(scale, codes, minValue, maxValue);
+  const int rounds = 20000;
+  volatile int32_t sink = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < PLOT_COLUMNS; i++) rows[i] = oldRow(scale.decode(codes[i]), minValue, maxValue);
+    sink = sink + rows[r % PLOT_COLUMNS];
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    YTransform t = makeYTransform(scale, minValue, maxValue, PLOT_TOP, PLOT_BOTTOM);
+    codesToRows(t, codes.data(), PLOT_COLUMNS, rows.data());
+    sink = sink + rows[r % PLOT_COLUMNS];
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  double perPoint = 1e9 / ((double)rounds * PLOT_COLUMNS);
+  double oldNs = std::chrono::duration<double>(t1 - t0).count() * perPoint;
+  double newNs = std::chrono::duration<double>(t2 - t1).count() * perPoint;
+  printf("map() per point: %.2f ns, transform per point (setup included): %.2f ns, %.1fx\n", oldNs, newNs, oldNs / newNs);
+
+  printf("%s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures == 0 ? 0 : 1;
+}